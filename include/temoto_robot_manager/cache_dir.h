@@ -0,0 +1,34 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TEMOTO_ROBOT_MANAGER__CACHE_DIR_H
+#define TEMOTO_ROBOT_MANAGER__CACHE_DIR_H
+
+#include <string>
+
+namespace temoto_robot_manager
+{
+
+/**
+ * @brief Returns the directory of the caches, ~/.temoto/<sub_dir>, and creates it if needed
+ * @return Empty string if HOME is not set or the directory could not be created, in which
+ * case nothing should be cached
+ */
+std::string getTemotoCacheDir(const std::string& sub_dir = "");
+
+} // namespace temoto_robot_manager
+
+#endif
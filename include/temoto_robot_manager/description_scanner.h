@@ -0,0 +1,117 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TEMOTO_ROBOT_MANAGER__DESCRIPTION_SCANNER_H
+#define TEMOTO_ROBOT_MANAGER__DESCRIPTION_SCANNER_H
+
+#include <atomic>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace temoto_robot_manager
+{
+
+/**
+ * @brief Finds the robot_description.yaml files under a base directory. The directories are
+ * scanned by several threads, and the listing of each directory is cached by its
+ * modification time, so that unchanged directories are not listed again after a restart.
+ * Optionally watches the directories with inotify and reports added or changed descriptions.
+ */
+class DescriptionScanner
+{
+public:
+  typedef std::function<void(const std::string&)> DescriptionChangedCb;
+
+  /**
+   * @param cache_file_path The cache is not persisted if empty
+   * @param thread_count Number of threads scanning the directories, 0 for one per core
+   */
+  DescriptionScanner(const std::string& base_path
+  , const std::string& cache_file_path = ""
+  , unsigned int thread_count = 0);
+
+  ~DescriptionScanner();
+
+  /**
+   * @brief Name of the cache file of a manager. Managers of different namespaces, or with
+   * different base directories, do not share a cache file
+   */
+  static std::string makeCacheFileName(const std::string& temoto_namespace, const std::string& base_path);
+
+  /**
+   * @brief Scans the base directory
+   * @return Paths of all description files, sorted
+   */
+  std::vector<std::string> scan();
+
+  /**
+   * @brief Watches the scanned directories and invokes the callback from the watcher thread
+   * whenever a description file is written or a directory containing one is added
+   * @return false if inotify is not available
+   */
+  bool startWatching(const DescriptionChangedCb& description_changed_cb);
+
+  void stopWatching();
+
+private:
+  struct Directory
+  {
+    std::time_t mtime = 0;
+    bool has_description = false;
+    std::vector<std::string> subdirs;
+  };
+
+  /**
+   * @brief Lists the directory, or takes the listing from the cache if the directory
+   * has not been modified since
+   * @return false if the directory could not be read
+   */
+  bool scanDirectory(const std::string& path, Directory& directory, std::time_t scan_time) const;
+
+  void loadCache();
+
+  void saveCache() const;
+
+  void addWatch(const std::string& path);
+
+  // Scans a directory which appeared while watching and reports its description files
+  void addWatchedTree(const std::string& path);
+
+  void watchLoop();
+
+  std::string base_path_;
+  std::string cache_file_path_;
+  unsigned int thread_count_;
+
+  // Directories of the last scan by their path
+  std::unordered_map<std::string, Directory> directories_;
+  mutable std::mutex directories_mutex_;
+
+  DescriptionChangedCb description_changed_cb_;
+  std::unordered_map<int, std::string> watched_dirs_;
+  int inotify_fd_ = -1;
+  std::atomic<bool> watching_{false};
+  std::thread watch_thread_;
+};
+
+} // namespace temoto_robot_manager
+
+#endif
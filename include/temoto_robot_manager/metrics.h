@@ -0,0 +1,117 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef TEMOTO_ROBOT_MANAGER__METRICS_H
+#define TEMOTO_ROBOT_MANAGER__METRICS_H
+
+#include "temoto_robot_manager/RobotManagerMetrics.h"
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace temoto_robot_manager
+{
+
+/**
+ * @brief Aggregates the durations of operations into latency histograms per subject (robot
+ * name, or temoto namespace of a remote manager) and operation. Recording is switched off by
+ * default, and a disabled recorder costs a single atomic load per span.
+ */
+class Metrics
+{
+public:
+  Metrics(bool enabled = false);
+
+  void setEnabled(bool enabled);
+
+  bool isEnabled() const
+  {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  void record(const std::string& subject, const std::string& operation, double duration, bool success);
+
+  /**
+   * @brief Returns the histograms
+   * @param subject Only the operations of this subject, all operations if empty
+   */
+  RobotManagerMetrics getMetrics(const std::string& subject = "") const;
+
+  void reset();
+
+private:
+  struct Histogram
+  {
+    std::vector<uint64_t> bucket_counts;
+    uint64_t count = 0;
+    uint64_t failures = 0;
+    double sum = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+    std::chrono::steady_clock::time_point first_recorded;
+  };
+
+  // Upper bound of the recorded durations below which the given share of the spans lies
+  double getPercentile(const Histogram& histogram, double share) const;
+
+  std::atomic<bool> enabled_;
+  std::map<std::pair<std::string, std::string>, Histogram> histograms_;
+  mutable std::mutex histograms_mutex_;
+};
+
+/**
+ * @brief Measures the time from its construction to its destruction on the monotonic clock.
+ * A span that is destroyed by an exception is recorded as failed
+ */
+class ScopedSpan
+{
+public:
+  /**
+   * @param detail Appended to the operation as "<operation>/<detail>". The name is only
+   * built if the metrics are enabled
+   */
+  ScopedSpan(Metrics& metrics
+  , const std::string& subject
+  , const char* operation
+  , const std::string& detail = "");
+
+  ~ScopedSpan();
+
+  ScopedSpan(const ScopedSpan&) = delete;
+  ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+  void setFailed()
+  {
+    failed_ = true;
+  }
+
+private:
+  Metrics& metrics_;
+  bool active_;
+  bool failed_ = false;
+  std::string subject_;
+  std::string operation_;
+  std::chrono::steady_clock::time_point start_time_;
+};
+
+} // namespace temoto_robot_manager
+
+#endif
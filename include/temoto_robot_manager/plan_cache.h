@@ -0,0 +1,110 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TEMOTO_ROBOT_MANAGER__PLAN_CACHE_H
+#define TEMOTO_ROBOT_MANAGER__PLAN_CACHE_H
+
+#include "temoto_robot_manager/robot_features.h"
+#include <geometry_msgs/Pose.h>
+#include <moveit_msgs/RobotTrajectory.h>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace temoto_robot_manager
+{
+
+/**
+ * @brief LRU cache of manipulation plans. A plan is looked up by its planning group,
+ * the discretized start joint state and the goal (named target or discretized pose).
+ */
+class PlanCache
+{
+public:
+  struct Stats
+  {
+    unsigned int hits = 0;
+    unsigned int misses = 0;
+    unsigned int rejected = 0;   // Hits which were not valid in the current planning scene
+  };
+
+  PlanCache(const PlanCacheConfig& config = PlanCacheConfig());
+
+  std::string makeKey(const std::string& planning_group_name
+  , const std::vector<std::string>& joint_names
+  , const std::vector<double>& joint_positions
+  , const std::string& goal_key) const;
+
+  std::string makeGoalKey(const std::string& named_target) const;
+
+  std::string makeGoalKey(const geometry_msgs::Pose& pose) const;
+
+  /**
+   * @brief Looks up a plan and marks it as the most recently used one
+   * @return false on a miss
+   */
+  bool find(const std::string& key, moveit_msgs::RobotTrajectory& trajectory);
+
+  void insert(const std::string& key, const moveit_msgs::RobotTrajectory& trajectory);
+
+  // Drops a cached plan which turned out to be unusable
+  void reject(const std::string& key);
+
+  Stats getStats() const;
+
+  size_t size() const;
+
+  /**
+   * @brief Returns the name of the cache file of the robot. The plans of one robot model are
+   * not shared by the managers of other temoto namespaces
+   * @param robot_model Description of the robot model, e.g. its URDF and SRDF
+   */
+  static std::string makeCacheFileName(const std::string& temoto_namespace
+  , const std::string& robot_name
+  , const std::string& robot_model);
+
+  /**
+   * @brief Writes the cache into a file, replacing the file atomically
+   * @return false if the file could not be written
+   */
+  bool save(const std::string& file_path) const;
+
+  /**
+   * @brief Reads the cache from a file written by save()
+   * @return false if the file is missing or malformed, the cache is left unchanged then
+   */
+  bool load(const std::string& file_path);
+
+private:
+  typedef std::pair<std::string, moveit_msgs::RobotTrajectory> Entry;
+
+  long quantize(double value, double resolution) const;
+
+  void evict();
+
+  PlanCacheConfig config_;
+  std::list<Entry> entries_;    // Most recently used first
+  std::unordered_map<std::string, std::list<Entry>::iterator> entry_index_;
+  Stats stats_;
+  mutable std::mutex cache_mutex_;
+};
+
+} // namespace temoto_robot_manager
+
+#endif
@@ -0,0 +1,60 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TEMOTO_ROBOT_MANAGER__PLANNER_RACE_H
+#define TEMOTO_ROBOT_MANAGER__PLANNER_RACE_H
+
+#include "temoto_core/common/temoto_log_macros.h"
+#include "temoto_robot_manager/robot_features.h"
+#include "temoto_robot_manager/planning_utils.h"
+#include <moveit/move_group_interface/move_group_interface.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace temoto_robot_manager
+{
+
+/**
+ * @brief Runs several planners on separate threads, each in its own planning context, for
+ * the same request. Depending on the mode, either the first valid plan or the shortest plan
+ * found within the deadline wins, and the remaining planners are terminated.
+ */
+class PlannerRace
+{
+public:
+  PlannerRace(const InProcessPlannerPtr& planner, const PlannerRaceConfig& config);
+
+  /**
+   * @brief Races the planners for the request
+   * @return false if none of the planners found a plan
+   */
+  bool plan(const planning_scene::PlanningSceneConstPtr& scene
+  , moveit_msgs::MotionPlanRequest request
+  , moveit::planning_interface::MoveGroupInterface::Plan& plan);
+
+private:
+  PlannerRaceConfig config_;
+  InProcessPlannerPtr planner_;
+
+  // Races of the same group are run one after another
+  std::mutex race_mutex_;
+};
+
+} // namespace temoto_robot_manager
+
+#endif
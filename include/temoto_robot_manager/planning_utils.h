@@ -0,0 +1,93 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TEMOTO_ROBOT_MANAGER__PLANNING_UTILS_H
+#define TEMOTO_ROBOT_MANAGER__PLANNING_UTILS_H
+
+#include <moveit/move_group_interface/move_group_interface.h>
+#include <moveit/planning_pipeline/planning_pipeline.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <moveit_msgs/MotionPlanRequest.h>
+#include <ros/ros.h>
+#include <memory>
+#include <mutex>
+
+namespace temoto_robot_manager
+{
+
+/**
+ * @brief The planners of move_group, loaded in-process from its planning pipeline parameters.
+ * move_group serves one planning request at a time, whereas the contexts created here can be
+ * solved concurrently. Creating the contexts is serialized.
+ */
+class InProcessPlanner
+{
+public:
+  /**
+   * @param nh Node handle in the namespace of the move_group node
+   */
+  InProcessPlanner(const moveit::core::RobotModelConstPtr& robot_model, const ros::NodeHandle& nh)
+  : pipeline_(std::make_shared<planning_pipeline::PlanningPipeline>(robot_model, nh, "planning_plugin", "request_adapters"))
+  {}
+
+  bool isAvailable() const
+  {
+    return static_cast<bool>(pipeline_->getPlannerManager());
+  }
+
+  /**
+   * @return nullptr if the planner could not handle the request
+   */
+  planning_interface::PlanningContextPtr createContext(const planning_scene::PlanningSceneConstPtr& scene
+  , const moveit_msgs::MotionPlanRequest& request)
+  {
+    std::lock_guard<std::mutex> lock(context_mutex_);
+    if (!isAvailable())
+    {
+      return nullptr;
+    }
+    moveit_msgs::MoveItErrorCodes error_code;
+    return pipeline_->getPlannerManager()->getPlanningContext(scene, request, error_code);
+  }
+
+private:
+  planning_pipeline::PlanningPipelinePtr pipeline_;
+  std::mutex context_mutex_;
+};
+typedef std::shared_ptr<InProcessPlanner> InProcessPlannerPtr;
+
+/**
+ * @brief Length of the path in the joint space
+ */
+double getPathLength(const robot_trajectory::RobotTrajectory& trajectory);
+
+double getPathLength(const trajectory_msgs::JointTrajectory& trajectory);
+
+double getDuration(const trajectory_msgs::JointTrajectory& trajectory);
+
+/**
+ * @brief Converts the path of an in-process planner into an executable plan. The planners
+ * return untimed paths, the timing is otherwise added by the request adapters of move_group
+ */
+void toExecutablePlan(robot_trajectory::RobotTrajectory& trajectory
+, const moveit_msgs::MotionPlanRequest& request
+, double planning_time
+, moveit::planning_interface::MoveGroupInterface::Plan& plan);
+
+} // namespace temoto_robot_manager
+
+#endif
@@ -0,0 +1,125 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TEMOTO_ROBOT_MANAGER__READINESS_MONITOR_H
+#define TEMOTO_ROBOT_MANAGER__READINESS_MONITOR_H
+
+#include <ros/ros.h>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+
+namespace temoto_robot_manager
+{
+
+/**
+ * @brief Shared by all robots of a Robot Manager. Waits for topics and parameters to appear
+ * by taking a single snapshot of the ROS master per tick for all pending waits, and wakes up
+ * the waiters as soon as their resource is available.
+ */
+class ReadinessMonitor
+{
+public:
+  ReadinessMonitor(double tick_rate = 10.0);
+
+  ~ReadinessMonitor();
+
+  /**
+   * @brief Blocks until the topic is advertised
+   * @param topic Absolute name of the topic
+   * @param timeout Maximum time to wait
+   * @param abort_condition The wait is interrupted when this returns true
+   * @return true if the topic became available, false on timeout or abort
+   */
+  bool waitForTopic(const std::string& topic
+  , const ros::WallDuration& timeout
+  , const std::function<bool()>& abort_condition = nullptr);
+
+  /**
+   * @brief Blocks until the parameter is set
+   * @param param Absolute name of the parameter
+   * @param timeout Maximum time to wait
+   * @param abort_condition The wait is interrupted when this returns true
+   * @return true if the parameter became available, false on timeout or abort
+   */
+  bool waitForParam(const std::string& param
+  , const ros::WallDuration& timeout
+  , const std::function<bool()>& abort_condition = nullptr);
+
+  /**
+   * @brief Blocks until the service is advertised
+   * @param service Absolute name of the service
+   * @param timeout Maximum time to wait
+   * @param abort_condition The wait is interrupted when this returns true
+   * @return true if the service became available, false on timeout or abort
+   */
+  bool waitForService(const std::string& service
+  , const ros::WallDuration& timeout
+  , const std::function<bool()>& abort_condition = nullptr);
+
+  /**
+   * @brief Blocks until the topic is published at least at the given rate
+   * @param topic Absolute name of the topic
+   * @param min_rate Minimum publishing rate in Hz
+   * @param timeout Maximum time to wait
+   * @param abort_condition The wait is interrupted when this returns true
+   * @return true if the topic reached the rate, false on timeout or abort
+   */
+  bool waitForTopicRate(const std::string& topic
+  , double min_rate
+  , const ros::WallDuration& timeout
+  , const std::function<bool()>& abort_condition = nullptr);
+
+private:
+  enum class ResourceType
+  {
+    TOPIC,
+    PARAM,
+    SERVICE
+  };
+
+  struct PendingWait
+  {
+    ResourceType type;
+    std::string name;
+    bool ready;
+  };
+
+  bool wait(ResourceType type
+  , const std::string& name
+  , const ros::WallDuration& timeout
+  , const std::function<bool()>& abort_condition);
+
+  void monitorLoop();
+
+  bool getMasterServices(std::unordered_set<std::string>& services) const;
+
+  ros::WallDuration tick_period_;
+  std::list<std::shared_ptr<PendingWait>> pending_waits_;
+  std::mutex pending_waits_mutex_;
+  std::condition_variable monitor_cv_;
+  std::condition_variable waiters_cv_;
+  bool running_;
+  std::thread monitor_thread_;
+};
+} // namespace temoto_robot_manager
+
+#endif
@@ -0,0 +1,185 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TEMOTO_ROBOT_MANAGER__REMOTE_CLIENT_POOL_H
+#define TEMOTO_ROBOT_MANAGER__REMOTE_CLIENT_POOL_H
+
+#include "temoto_robot_manager/metrics.h"
+#include <ros/ros.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace temoto_robot_manager
+{
+
+/**
+ * @brief Keeps persistent service clients to the Robot Managers in other temoto namespaces,
+ * so that forwarded calls do not pay for the master lookup and connection setup every time.
+ * A persistent client serves one call at a time, hence each service has a small pool of
+ * clients, and a call which finds all of them busy (e.g. by long executions or navigation
+ * goals) uses a non-persistent client instead of waiting. A client is reconnected when its
+ * connection has dropped. Each call is recorded as a "forward/<service>" span of the remote
+ * temoto namespace.
+ */
+class RemoteClientPool
+{
+public:
+  RemoteClientPool(Metrics& metrics
+  , const ros::NodeHandle& nh = ros::NodeHandle()
+  , unsigned int clients_per_service = 4)
+  : metrics_(metrics)
+  , nh_(nh)
+  , clients_per_service_(clients_per_service)
+  {}
+
+  /**
+   * @brief Calls the service of the Robot Manager in the given temoto namespace
+   * @return false if the call failed
+   */
+  template <class ServiceType>
+  bool call(const std::string& temoto_namespace, const std::string& service_name, ServiceType& srv)
+  {
+    ScopedSpan span(metrics_, temoto_namespace, "forward", service_name);
+    ClientPtr client = acquireClient<ServiceType>(temoto_namespace, service_name);
+    bool success = client ? client->client.call(srv) : createClient<ServiceType>(temoto_namespace, service_name, false).call(srv);
+    if (client)
+    {
+      // The remote manager may have gone away, hence establish a new connection next time
+      releaseClient(client, success);
+    }
+
+    if (!success)
+    {
+      span.setFailed();
+    }
+    return success;
+  }
+
+  /**
+   * @brief Drops the clients of all services in the given temoto namespace
+   */
+  void invalidate(const std::string& temoto_namespace)
+  {
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    auto it = clients_.lower_bound(ClientKey(temoto_namespace, ""));
+    while (it != clients_.end() && it->first.first == temoto_namespace)
+    {
+      dropClients(it->second);
+      it = clients_.erase(it);
+    }
+  }
+
+  void invalidate(const std::string& temoto_namespace, const std::string& service_name)
+  {
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    auto it = clients_.find(ClientKey(temoto_namespace, service_name));
+    if (it != clients_.end())
+    {
+      dropClients(it->second);
+      clients_.erase(it);
+    }
+  }
+
+private:
+  typedef std::pair<std::string, std::string> ClientKey;
+
+  struct PooledClient
+  {
+    ros::ServiceClient client;
+    bool in_use = false;
+    bool dropped = false;
+  };
+  typedef std::shared_ptr<PooledClient> ClientPtr;
+
+  template <class ServiceType>
+  ros::ServiceClient createClient(const std::string& temoto_namespace, const std::string& service_name, bool persistent)
+  {
+    return nh_.serviceClient<ServiceType>("/" + temoto_namespace + "/" + service_name, persistent);
+  }
+
+  /**
+   * @brief Returns an idle persistent client of the service
+   * @return nullptr if all clients of the service are busy
+   */
+  template <class ServiceType>
+  ClientPtr acquireClient(const std::string& temoto_namespace, const std::string& service_name)
+  {
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    std::vector<ClientPtr>& clients = clients_[ClientKey(temoto_namespace, service_name)];
+    ClientPtr idle_client;
+    for (const auto& client : clients)
+    {
+      if (!client->in_use)
+      {
+        idle_client = client;
+        break;
+      }
+    }
+
+    if (!idle_client && clients.size() < clients_per_service_)
+    {
+      idle_client = std::make_shared<PooledClient>();
+      clients.push_back(idle_client);
+    }
+
+    if (idle_client)
+    {
+      if (!idle_client->client.isValid())
+      {
+        idle_client->client = createClient<ServiceType>(temoto_namespace, service_name, true);
+      }
+      idle_client->in_use = true;
+    }
+    return idle_client;
+  }
+
+  void releaseClient(const ClientPtr& client, bool success)
+  {
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    client->in_use = false;
+    if (!success || client->dropped)
+    {
+      client->client.shutdown();
+    }
+  }
+
+  // The clients which are in use are shut down once their call returns
+  void dropClients(const std::vector<ClientPtr>& clients)
+  {
+    for (const auto& client : clients)
+    {
+      client->dropped = true;
+      if (!client->in_use)
+      {
+        client->client.shutdown();
+      }
+    }
+  }
+
+  Metrics& metrics_;
+  ros::NodeHandle nh_;
+  const unsigned int clients_per_service_;
+  std::map<ClientKey, std::vector<ClientPtr>> clients_;
+  std::mutex clients_mutex_;
+};
+
+} // namespace temoto_robot_manager
+
+#endif
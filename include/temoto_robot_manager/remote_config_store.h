@@ -0,0 +1,139 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TEMOTO_ROBOT_MANAGER__REMOTE_CONFIG_STORE_H
+#define TEMOTO_ROBOT_MANAGER__REMOTE_CONFIG_STORE_H
+
+#include "temoto_robot_manager/robot_config.h"
+#include "temoto_robot_manager/robot_config_index.h"
+#include <ros/ros.h>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace temoto_robot_manager
+{
+
+/**
+ * @brief Holds the configs of the remote managers, sharded by temoto namespace. A manager
+ * which sends heartbeats holds a lease, which is renewed whenever the manager is heard from.
+ * The lookups skip the managers whose lease has expired, and evictExpired drops such managers
+ * together with all of their configs. A manager which has never sent a heartbeat holds no
+ * lease, its configs are kept until it restarts. Not thread safe, the caller guards the store.
+ */
+class RemoteConfigStore
+{
+public:
+  /**
+   * @param lease_duration Seconds a manager is considered alive after it was last heard from
+   */
+  explicit RemoteConfigStore(double lease_duration);
+
+  /**
+   * @brief Renews the lease of the manager on its heartbeat, the shard of an unknown manager
+   * is created
+   * @return true if the manager was not known or its lease had expired
+   */
+  bool renewLease(const std::string& temoto_namespace);
+
+  /**
+   * @brief Notes any other message of the manager. The lease of a manager which holds one is
+   * renewed, the shard of an unknown manager is created
+   * @return true if the manager was not known or its lease had expired
+   */
+  bool touch(const std::string& temoto_namespace);
+
+  /**
+   * @brief Starts a new epoch of the manager, i.e., the manager was restarted. The configs
+   * of the previous epoch are dropped
+   * @param erased_count Set to the number of dropped configs
+   * @return false if the epoch is the known one
+   */
+  bool updateEpoch(const std::string& temoto_namespace, uint64_t epoch, size_t& erased_count);
+
+  /**
+   * @brief Returns false if no epoch of the manager is known
+   */
+  bool getEpoch(const std::string& temoto_namespace, uint64_t& epoch) const;
+
+  /**
+   * @brief Adds the config to the shard of its temoto namespace, or replaces the config with
+   * the same name in it
+   * @return true if an existing config was replaced
+   */
+  bool insert(const RobotConfigPtr& config);
+
+  /**
+   * @brief Returns the config of the robot in the given temoto namespace, nullptr if not found
+   */
+  RobotConfigPtr find(const std::string& temoto_namespace, const std::string& robot_name) const;
+
+  /**
+   * @brief Returns the most reliable config of the robot at an alive manager, nullptr if not
+   * found. If the name is empty, the most reliable config of all robots is returned.
+   */
+  RobotConfigPtr findBest(const std::string& robot_name) const;
+
+  /**
+   * @brief Returns the configs of the robot at alive managers, ordered by reliability
+   */
+  RobotConfigs findAll(const std::string& robot_name) const;
+
+  /**
+   * @brief Restores the ordering after the reliability of a config of this robot has changed
+   */
+  void updateReliability(const std::string& robot_name);
+
+  bool isAlive(const std::string& temoto_namespace) const;
+
+  /**
+   * @brief Drops the managers whose lease has expired, together with their configs
+   * @return Temoto namespaces of the dropped managers
+   */
+  std::vector<std::string> evictExpired();
+
+  // Number of configs
+  size_t size() const;
+
+private:
+  struct Shard
+  {
+    bool leased = false;
+    ros::WallTime lease_expiry;
+    bool epoch_known = false;
+    uint64_t epoch = 0;
+    std::unordered_set<std::string> robot_names;
+  };
+
+  bool isAlive(const std::string& temoto_namespace, const ros::WallTime& now) const;
+
+  static bool isExpired(const Shard& shard, const ros::WallTime& now);
+
+  // Removes the configs of the shard from the index
+  size_t eraseConfigs(const std::string& temoto_namespace, Shard& shard);
+
+  ros::WallDuration lease_duration_;
+  std::unordered_map<std::string, Shard> shards_;
+
+  // Configs of all shards by robot name
+  RobotConfigIndex configs_;
+};
+
+} // namespace temoto_robot_manager
+
+#endif
@@ -23,14 +23,32 @@
 #include "temoto_robot_manager/robot_config.h"
 #include "temoto_robot_manager/robot_manager.h"
 #include "temoto_robot_manager/robot_features.h"
+#include "temoto_robot_manager/readiness_monitor.h"
+#include "temoto_robot_manager/urdf_cache.h"
+#include "temoto_robot_manager/plan_cache.h"
+#include "temoto_robot_manager/planner_race.h"
+#include "temoto_robot_manager/metrics.h"
 #include "temoto_robot_manager/GripperControl.h"
+#include "temoto_robot_manager/RobotPlanGoal.h"
+#include "temoto_robot_manager/RobotPlanResult.h"
+#include "temoto_robot_manager/RobotStatus.h"
 #include <moveit/move_group_interface/move_group_interface.h>
 #include <moveit/planning_interface/planning_interface.h>
+#include <moveit/planning_scene_monitor/current_state_monitor.h>
 #include <move_base_msgs/MoveBaseAction.h>
 #include <geometry_msgs/PoseWithCovarianceStamped.h>
+#include <std_msgs/Float32.h>
+#include <std_msgs/String.h>
 #include <string>
 #include <map>
 #include <vector>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
 
 namespace temoto_robot_manager
 {
@@ -44,20 +62,120 @@ public:
   Robot(RobotConfigPtr config_
   , const std::string& resource_id
   , temoto_resource_registrar::ResourceRegistrarRos1& resource_registrar
+  , ReadinessMonitor& readiness_monitor
+  , UrdfCache& urdf_cache
+  , Metrics& metrics
   , temoto_core::BaseSubsystem& b);
 
   virtual ~Robot();
   void load();
   void recover(const std::string& parent_query_id);
+
+  /**
+   * @brief Stops the commands in progress, drops the stored plans and pauses the gripper
+   * stream, so that the robot can wait in warm standby for the next load. The robot is not
+   * operational until it is resumed
+   */
+  void standby();
+
+  // Re-attaches the robot from warm standby
+  void resume();
+
+  bool isInStandby() const
+  {
+    return in_standby_;
+  }
+
+  // Interrupts the loading, e.g. of a robot which is preloaded into warm standby
+  void interruptLoad();
+
+  /**
+   * @brief The resources of a warm standby robot outlive the load queries, they depend on
+   * this resource instead. After a crash of the manager it finds them by this ID
+   */
+  static std::string getStandbyResourceId(const RobotConfigPtr& config);
+
+  /**
+   * @brief Unloads the resources which were started via the ER manager. Only needed for the
+   * resources which do not depend on the load query of the robot
+   */
+  void unloadResources();
   void addPlanningGroup(const std::string& planning_group_name);
   void removePlanningGroup(const std::string& planning_group_name);
-  void planManipulationPath(std::string& planning_group_name, const geometry_msgs::PoseStamped& target_pose);
-  void planManipulationPath(std::string& planning_group_name, const std::string& named_target);  
 
-  void executeManipulationPath();
+  /**
+   * @brief Plans a path for the group and stores the plan
+   * @param start_plan_id If set, the path starts from the final state of that stored plan
+   * @return ID of the stored plan
+   */
+  std::string planManipulationPath(std::string& planning_group_name
+  , const geometry_msgs::PoseStamped& target_pose
+  , const std::string& start_plan_id = "");
+  std::string planManipulationPath(std::string& planning_group_name
+  , const std::string& named_target
+  , const std::string& start_plan_id = "");
+
+  /**
+   * @brief Plans a path of straight end effector segments through the waypoints
+   * @param eef_step Maximum step of the end effector between path points
+   * @param jump_threshold 0 disables the check for jumps in the joint space
+   * @return ID of the stored plan
+   */
+  std::string planCartesianPath(std::string& planning_group_name
+  , const std::vector<geometry_msgs::Pose>& waypoints
+  , double eef_step
+  , double jump_threshold
+  , const std::string& start_plan_id = "");
+
+  /**
+   * @brief Plans a path which is interpolated in the joint space and checked for collisions,
+   * without a sampling based planner
+   * @return ID of the stored plan
+   */
+  std::string planJointPath(std::string& planning_group_name
+  , const std::vector<std::string>& joint_names
+  , const std::vector<double>& joint_values
+  , const std::string& start_plan_id = "");
+
+  std::string planJointPath(std::string& planning_group_name
+  , const std::string& named_target
+  , const std::string& start_plan_id = "");
+
+  /**
+   * @brief Plans for all goals concurrently and stores the found plans
+   * @return One result per goal, in the same order
+   */
+  std::vector<RobotPlanResult> planManipulationPaths(const std::vector<RobotPlanGoal>& goals);
+
+  /**
+   * @brief Executes a stored plan and removes it from the store
+   * @param plan_id ID of the plan. The latest plan of the active group is executed when empty
+   */
+  void executeManipulationPath(const std::string& plan_id = "");
+
+  // Stops the ongoing manipulation path execution
+  void stopManipulation();
   
   geometry_msgs::Pose getManipulationTarget();
   void goalNavigation(const std::string& reference_frame, const geometry_msgs::PoseStamped& target_pose);
+
+  typedef std::function<void(unsigned int waypoint_index)> WaypointPassedCb;
+
+  /**
+   * @brief Navigates through the waypoints of the route. The goal of the next waypoint is
+   * sent as soon as the robot has reached the current one or has come within the look-ahead
+   * radius (or the tolerance of the waypoint) of it, so that the base does not stop in between
+   * @param tolerances Either empty or one tolerance per waypoint
+   * @param waypoint_passed_cb Invoked after each passed waypoint
+   */
+  void goalNavigationRoute(const std::string& reference_frame
+  , const std::vector<geometry_msgs::PoseStamped>& route
+  , const std::vector<double>& tolerances
+  , double look_ahead_radius
+  , WaypointPassedCb waypoint_passed_cb = WaypointPassedCb());
+
+  // Cancels the ongoing navigation goal
+  void cancelNavigationGoal();
   void controlGripper(const std::string& robot_name, const float position);
   
   std::string getName() const
@@ -76,12 +194,150 @@ public:
 
   bool isInError() const;
 
+  std::string getActivePlanningGroup() const;
+
   // return all the information required to visualize this robot
   std::string getVizInfo();
 
+  /**
+   * @brief Returns the current state of the robot. The end effector poses are reported only
+   * for the planning groups which already exist, and only once all joint states are known
+   */
+  RobotStatus getStatus();
+
   void setResourceId(const std::string& resource_id);
 
+  enum class LoadStageState
+  {
+    PENDING,
+    LOADING,
+    READY,
+    FAILED
+  };
+
+  // Returns the readiness of each node in the feature load graph
+  std::map<std::string, LoadStageState> getLoadStageStates() const;
+
 private:
+  /**
+   * @brief A node in the feature load graph. A stage is started as soon as all of its
+   * dependencies are READY
+   */
+  struct LoadStage
+  {
+    std::string name;
+    std::vector<std::string> dependencies;
+    std::function<void()> load;
+  };
+
+  std::vector<LoadStage> getLoadStages();
+
+  // Loads the robot model and the planning groups of the running move_group
+  void connectManipulation();
+
+  // Loads the robot model from the URDF and SRDF once, it is shared by all planning groups
+  void loadRobotModel();
+
+  typedef moveit::planning_interface::MoveGroupInterface MoveGroupInterface;
+
+  // Blocks until the interface has connected to move_group, may be called concurrently
+  std::unique_ptr<MoveGroupInterface> createPlanningGroup(const std::string& planning_group_name) const;
+
+  void insertPlanningGroup(const std::string& planning_group_name, std::unique_ptr<MoveGroupInterface> group);
+
+  /**
+   * @brief Returns the interface of the group. With lazy planning groups, the interface is
+   * created on first use
+   * @return nullptr if the robot has no such group
+   */
+  MoveGroupInterface* getPlanningGroup(const std::string& planning_group_name);
+
+  /**
+   * @brief Returns the interface which executes the plans of the group, it is created on
+   * first use. Has to be called with execution_mutex_ held
+   * @return nullptr if the robot has no such group
+   */
+  MoveGroupInterface* getExecutionGroup(const std::string& planning_group_name);
+
+  struct StoredPlan
+  {
+    std::string planning_group_name;
+    MoveGroupInterface::Plan plan;
+  };
+
+  /**
+   * @brief Plans with the group after the target has been set via set_target
+   * @return ID of the stored plan
+   */
+  std::string planWithGroup(std::string& planning_group_name
+  , const std::string& start_plan_id
+  , const std::string& goal_key
+  , const std::function<void(MoveGroupInterface&)>& set_target);
+
+  void createPlanCache();
+
+  /**
+   * @brief Looks up a plan for the start state and the goal in the plan cache. Has to be
+   * called with planning_mutex_ held
+   * @param cache_key Set to the key under which the plan is cached, also on a miss
+   * @return false on a miss or if the cached plan is not valid anymore
+   */
+  bool findCachedPlan(MoveGroupInterface& group
+  , const std::string& planning_group_name
+  , const robot_state::RobotState& start_state
+  , const std::string& goal_key
+  , std::string& cache_key
+  , MoveGroupInterface::Plan& plan);
+
+  /**
+   * @brief Writes the plan cache into its file in the background. Requests made while the
+   * cache is being written are coalesced into one more write
+   */
+  void savePlanCache();
+
+  // Returns the latest planning scene of move_group, or nullptr if it is not available
+  planning_scene::PlanningScenePtr getPlanningScene(MoveGroupInterface& group);
+
+  // Checks the trajectory for collisions in the latest planning scene of move_group
+  bool isTrajectoryValid(MoveGroupInterface& group
+  , const robot_state::RobotState& start_state
+  , const moveit_msgs::RobotTrajectory& trajectory);
+
+  /**
+   * @brief Sets the start state of the group either to the current state or to the final
+   * state of a stored plan. Has to be called with planning_mutex_ held. Throws if the
+   * manipulation controller is not loaded
+   * @param start_state Set to a copy of the start state
+   */
+  MoveGroupInterface& prepareStartState(std::string& planning_group_name
+  , const std::string& start_plan_id
+  , robot_state::RobotStatePtr& start_state);
+
+  std::string storePlan(const std::string& planning_group_name, const MoveGroupInterface::Plan& plan);
+
+  /**
+   * @brief Drops a stored plan. If it was the latest plan of its group, the group has no
+   * latest plan until the next one is made. Has to be called with plans_mutex_ held
+   */
+  void erasePlan(const std::string& plan_id);
+
+  void setPlanResult(const std::string& plan_id, const MoveGroupInterface::Plan& plan, RobotPlanResult& result) const;
+
+  // Plans the goals one after another via move_group
+  void planManipulationPathsSequentially(const std::vector<RobotPlanGoal>& goals, std::vector<RobotPlanResult>& results);
+
+  // Has to be called with planning_groups_mutex_ held
+  const InProcessPlannerPtr& getInProcessPlanner();
+
+  // Checks if the plan still starts from the current state of the robot
+  bool isPlanStartValid(MoveGroupInterface& group, const MoveGroupInterface::Plan& plan) const;
+
+  /**
+   * @brief Loads the stages concurrently, following the dependencies between them.
+   * Throws the error of the first failed stage
+   */
+  void runLoadStages(const std::vector<LoadStage>& stages);
+
   void waitForHardware();
   void loadHardware();
   void loadUrdf();
@@ -101,33 +357,187 @@ private:
 
   void robotPoseCallback(const geometry_msgs::PoseWithCovarianceStamped& msg);
 
+  // Subscribes to the localized pose and advertises the initial pose of the localization
+  void connectLocalization();
+
+  /**
+   * @brief Recovers the crashed resource in a separate thread, so that the status callback
+   * is not blocked. Several resources are recovered in parallel, the robot becomes
+   * operational again once all of them are recovered
+   */
+  void startRecovery(const temoto_er_manager::LoadExtResource& srv_msg);
+
+  // Set when a recovery should be abandoned, each recovery has its own token
+  typedef std::shared_ptr<std::atomic<bool>> CancelToken;
+
+  void recoverResource(temoto_er_manager::LoadExtResource srv_msg, CancelToken cancelled);
+
+  // Interrupts the recoveries in progress and waits for them
+  void stopRecoveries();
+
+  void finishRecovery(bool recovered);
+
+  // Latest joint states from the monitor which the group interfaces share, nullptr if incomplete
+  moveit::core::RobotStatePtr getCurrentRobotState(const moveit::core::RobotModelConstPtr& robot_model);
+
+  // Marks the feature which the resource belongs to as loaded or not
+  void setResourceLoaded(const temoto_er_manager::LoadExtResource& srv_msg, bool loaded);
+
+  /**
+   * @brief Sends the pose to the localization until the localization reports a pose
+   * close to it
+   * @return false if the pose was not accepted within the load timeout or the abort condition
+   * became true
+   */
+  bool restoreLocalization(const geometry_msgs::PoseWithCovarianceStamped& pose
+  , const std::function<bool()>& abort_condition);
+
+  void navigationDoneCb(const actionlib::SimpleClientGoalState& state
+  , const move_base_msgs::MoveBaseResultConstPtr& result);
+
+  void navigationFeedbackCb(const move_base_msgs::MoveBaseFeedbackConstPtr& feedback);
+
+  void createNavigationClient();
+
+  void createGripperClient();
+
+  /**
+   * @brief Rebuilds the visualization info if a feature was loaded or unloaded or the
+   * active planning group has changed, and publishes it for local robots. Not to be called
+   * under the planning lock
+   */
+  void updateVizInfo();
+
+  /**
+   * @brief Subscribes to the streamed gripper setpoints and starts the thread which
+   * executes them
+   */
+  void startGripperStream();
+
+  void gripperPositionCb(const std_msgs::Float32& msg);
+
+  // Executes the latest setpoint, the setpoints received in the meantime are dropped
+  void gripperStreamLoop();
+
   void waitForParam(const std::string& param);
   void waitForTopic(const std::string& topic);
-  bool isTopicAvailable(const std::string& topic);
+  void waitForTopic(const std::string& topic, const std::function<bool()>& abort_condition);
+
+  /**
+   * @brief Waits until the probe passes or its timeout expires. Loading continues after
+   * the timeout, but an error is thrown when the robot goes into a failed state
+   */
+  void waitForProbe(const ReadinessProbe& probe);
   void setRobotOperational(bool robot_operational);
   void setInError(bool state_in_error);
 
   ros::NodeHandle nh_;
   std::string robot_resource_id_;
   bool robot_operational_;
-  bool robot_loaded_;
+  std::atomic<bool> robot_loaded_;
+  std::atomic<bool> in_standby_{false};
   bool state_in_error_;
   mutable std::recursive_mutex robot_operational_mutex_;
   mutable std::recursive_mutex robot_state_in_error_mutex_;
+  std::map<std::string, LoadStageState> load_stage_states_;
+  mutable std::mutex load_stage_states_mutex_;
   RobotConfigPtr config_;
   temoto_resource_registrar::ResourceRegistrarRos1& resource_registrar_;
+  ReadinessMonitor& readiness_monitor_;
+  UrdfCache& urdf_cache_;
+  Metrics& metrics_;
+
+  /*
+   * Commands are serialized per feature, i.e., the robot can navigate and control its
+   * gripper at the same time, but two navigation commands are executed one after another.
+   * Manipulation has separate locks for planning and execution, so that the next motion
+   * can be planned while the previous one is executed. As the interface of a planning group
+   * is not thread-safe, each group has one interface for planning, used under planning_mutex_,
+   * and one for execution, used under execution_mutex_
+   */
+  std::mutex planning_mutex_;
+  std::mutex execution_mutex_;
+  std::mutex navigation_mutex_;
+  std::mutex gripper_mutex_;
+  mutable std::mutex active_planning_group_mutex_;
 
   // Manipulation related
-  bool is_plan_valid_;
-  moveit::planning_interface::MoveGroupInterface::Plan last_plan;
-  std::map<std::string, std::unique_ptr<moveit::planning_interface::MoveGroupInterface>> planning_groups_;
+  moveit::core::RobotModelConstPtr robot_model_;
+  std::map<std::string, std::unique_ptr<MoveGroupInterface>> planning_groups_;
+  std::map<std::string, std::unique_ptr<MoveGroupInterface>> execution_groups_;
+  std::mutex planning_groups_mutex_;
+  std::atomic<MoveGroupInterface*> executing_group_;
+  std::map<std::string, std::unique_ptr<PlannerRace>> planner_races_;
+  InProcessPlannerPtr in_process_planner_;
+
+  // Plans by plan ID, and the ID of the latest plan of each planning group
+  std::map<std::string, StoredPlan> plans_;
+  std::map<std::string, std::string> latest_plan_ids_;
+  std::deque<std::string> plan_order_;
+  std::mutex plans_mutex_;
+  unsigned int plan_count_;
+
+  std::unique_ptr<PlanCache> plan_cache_;
+  std::string plan_cache_file_path_;
+  bool plan_cache_dirty_ = false;
+  bool plan_cache_saving_ = false;
+  std::mutex plan_cache_save_mutex_;
+  std::future<void> plan_cache_save_;
 
   // Navigation related
   typedef actionlib::SimpleActionClient<move_base_msgs::MoveBaseAction> MoveBaseClient;
+  std::unique_ptr<MoveBaseClient> move_base_client_;
+  std::mutex navigation_state_mutex_;
+  std::condition_variable navigation_state_cv_;
+  bool navigation_goal_done_;
+  bool navigation_waypoint_near_;
+  geometry_msgs::PoseStamped navigation_waypoint_;
+  double navigation_switch_radius_;
+
+  // Guards sending and cancelling of the goals, so that a canceled route is not continued
+  std::mutex navigation_goal_mutex_;
+  bool navigation_cancel_requested_;
   ros::Subscriber localized_pose_sub_;
+  ros::Publisher initial_pose_pub_;
   geometry_msgs::PoseWithCovarianceStamped current_pose_navigation_;
+  geometry_msgs::PoseWithCovarianceStamped localized_pose_;
+  unsigned int localized_pose_count_ = 0;
+  std::mutex localized_pose_mutex_;
+  std::condition_variable localized_pose_cv_;
+
+  // Resources started via the ER manager, in the order of loading
+  std::vector<temoto_er_manager::LoadExtResource> ext_resources_;
+  std::mutex ext_resources_mutex_;
+
+  // Crash recovery
+  struct Recovery
+  {
+    std::future<void> result;
+    CancelToken cancelled;
+  };
+  std::vector<Recovery> recoveries_;
+  unsigned int recoveries_in_progress_ = 0;
+  bool recovery_failed_ = false;
+  std::mutex recovery_mutex_;
 
   ros::ServiceClient client_gripper_control_;
+
+  // The visualization info and the state it was built from
+  std::string viz_info_;
+  std::string viz_info_state_;
+  std::mutex viz_info_mutex_;
+  ros::Publisher viz_info_pub_;
+
+  // Joint states for the end effector poses of the status
+  planning_scene_monitor::CurrentStateMonitorPtr state_monitor_;
+  std::mutex state_monitor_mutex_;
+  ros::Subscriber gripper_position_sub_;
+  std::thread gripper_stream_thread_;
+  std::mutex gripper_setpoint_mutex_;
+  std::condition_variable gripper_setpoint_cv_;
+  float gripper_setpoint_ = 0.0;
+  bool gripper_setpoint_pending_ = false;
+  bool gripper_stream_stopped_ = false;
 };
 }
 
@@ -37,9 +37,11 @@ class RobotConfig : temoto_core::BaseSubsystem
 public:
   /**
    * @brief RobotConfig
+   * @param parse_features The features can be left unparsed until parseFeatures() is called,
+   * e.g. for the configs of remote robots which are not loaded by this manager
    */
 
-  RobotConfig(YAML::Node yaml_config, temoto_core::BaseSubsystem& b);
+  RobotConfig(YAML::Node yaml_config, temoto_core::BaseSubsystem& b, bool parse_features = true);
   
   std::string toString() const;
 
@@ -54,9 +56,9 @@ public:
   }
 
   // Get the robot's namespace
-  std::string getAbsRobotNamespace() const
+  const std::string& getAbsRobotNamespace() const
   {
-    return "/" + temoto_namespace_ + "/robot_manager/robots/" + name_;
+    return abs_robot_namespace_;
   }
 
   void parseName();
@@ -65,12 +67,17 @@ public:
   void parseTemotoNamespace();
   void parseDescription();
   void parseReliability();
+  void parseLoadTimeout();
+  void parseWarmStandby();
 
   void parseUrdf();
   void parseManipulation();
   void parseNavigation();
   void parseGripper();
 
+  // Parses the features unless they have been parsed already
+  void parseFeatures();
+
   std::string getName() const
   {
     return name_;
@@ -86,6 +93,30 @@ public:
     return reliability_.getReliability();
   }
 
+  // Maximum time in seconds to wait for a resource of a feature while loading
+  double getLoadTimeout() const
+  {
+    return load_timeout_;
+  }
+
+  // The stack of the robot is kept running after an unload, so that the next load re-attaches it
+  bool isWarmStandby() const
+  {
+    return warm_standby_;
+  }
+
+  // The robot is started in standby when the manager starts
+  bool isPreloaded() const
+  {
+    return preload_;
+  }
+
+  // Seconds in standby after which the stack is stopped, 0 keeps it while the host has resources
+  double getStandbyIdleTimeout() const
+  {
+    return standby_idle_timeout_;
+  }
+
   FeatureURDF& getFeatureURDF()
   {
     return feature_urdf_;
@@ -116,6 +147,22 @@ public:
     reliability_.resetReliability(reliability);
   }
 
+  // Incremented on every change of the config which is advertised to other managers
+  unsigned int getRevision() const
+  {
+    return revision_;
+  }
+
+  void setRevision(unsigned int revision)
+  {
+    revision_ = revision;
+  }
+
+  unsigned int bumpRevision()
+  {
+    return ++revision_;
+  }
+
   const YAML::Node& getYAMLConfig() const
   {
     return yaml_config_;
@@ -131,7 +178,8 @@ public:
   void setTemotoNamespace(std::string temoto_namespace)
   {
     temoto_namespace_ = temoto_namespace;
-    yaml_config_["robot_absolute_namespace"] = getAbsRobotNamespace();
+    abs_robot_namespace_ = "/" + temoto_namespace_ + "/robot_manager/robots/" + name_;
+    yaml_config_["robot_absolute_namespace"] = abs_robot_namespace_;
   }
 
 private:
@@ -141,6 +189,7 @@ private:
   std::string log_group_ = "robot_manager";
 
   std::string temoto_namespace_;
+  std::string abs_robot_namespace_;
   YAML::Node yaml_config_;
 
   FeatureURDF feature_urdf_;
@@ -148,9 +197,15 @@ private:
   FeatureNavigation feature_navigation_;
   FeatureGripper feature_gripper_;
   std::vector<RobotFeature*> enabled_features_;
+  bool features_parsed_ = false;
   
   std::string name_;
   std::string description_;
+  double load_timeout_;
+  bool warm_standby_;
+  bool preload_;
+  double standby_idle_timeout_;
+  unsigned int revision_ = 1;
   temoto_core::Reliability reliability_;
 };
 
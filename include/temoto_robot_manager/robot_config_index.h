@@ -0,0 +1,87 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TEMOTO_ROBOT_MANAGER__ROBOT_CONFIG_INDEX_H
+#define TEMOTO_ROBOT_MANAGER__ROBOT_CONFIG_INDEX_H
+
+#include "temoto_robot_manager/robot_config.h"
+#include <string>
+#include <unordered_map>
+
+namespace temoto_robot_manager
+{
+
+/**
+ * @brief Indexes robot configs by robot name. The configs of each name are kept ordered
+ * by reliability (most reliable first), hence the lookups do not depend on the number of
+ * known configs. A name may have configs in several temoto namespaces, but only one per namespace.
+ */
+class RobotConfigIndex
+{
+public:
+  /**
+   * @brief Adds the config, or replaces the config with the same name and temoto namespace
+   * @return true if an existing config was replaced
+   */
+  bool insert(const RobotConfigPtr& config);
+
+  /**
+   * @brief Removes the config with the same name and temoto namespace
+   * @return true if a config was removed
+   */
+  bool erase(const RobotConfigPtr& config);
+
+  /**
+   * @brief Returns the config of the robot in the given temoto namespace, nullptr if not found
+   */
+  RobotConfigPtr find(const std::string& temoto_namespace, const std::string& robot_name) const;
+
+  /**
+   * @brief Returns the most reliable config of the robot, nullptr if not found. If the name
+   * is empty, the most reliable config of all robots is returned.
+   */
+  RobotConfigPtr findBest(const std::string& robot_name) const;
+
+  /**
+   * @brief Returns all configs of the robot, ordered by reliability
+   */
+  const RobotConfigs& findAll(const std::string& robot_name) const;
+
+  /**
+   * @brief Restores the ordering after the reliability of a config of this robot has changed
+   */
+  void updateReliability(const std::string& robot_name);
+
+  bool contains(const std::string& robot_name) const;
+
+  /**
+   * @brief Removes all configs of the temoto namespace
+   * @return Number of removed configs
+   */
+  size_t eraseNamespace(const std::string& temoto_namespace);
+
+  RobotConfigs getConfigs() const;
+
+  size_t size() const;
+
+private:
+  std::unordered_map<std::string, RobotConfigs> configs_by_name_;
+  size_t size_ = 0;
+};
+
+} // namespace temoto_robot_manager
+
+#endif
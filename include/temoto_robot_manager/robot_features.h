@@ -19,6 +19,7 @@
 
 #include "temoto_core/common/temoto_id.h"
 
+#include <map>
 #include <string>
 #include <vector>
 #include <yaml-cpp/yaml.h>
@@ -26,6 +27,110 @@
 namespace temoto_robot_manager
 {
 
+/*
+ * Names of the nodes in the feature load graph. These names are used in the
+ * "depends_on" lists of robot_description.yaml
+ */
+namespace load_stage
+{
+const std::string URDF = "urdf";
+const std::string MANIPULATION_DRIVER = "manipulation_driver";
+const std::string MANIPULATION_CONTROLLER = "manipulation_controller";
+const std::string NAVIGATION_DRIVER = "navigation_driver";
+const std::string NAVIGATION_CONTROLLER = "navigation_controller";
+const std::string GRIPPER_DRIVER = "gripper_driver";
+const std::string GRIPPER_CONTROLLER = "gripper_controller";
+}
+
+namespace probe_type
+{
+const std::string NONE = "none";
+const std::string TOPIC = "topic";
+const std::string SERVICE = "service";
+const std::string ACTION_SERVER = "action_server";
+const std::string PARAM = "param";
+}
+
+/**
+ * @brief Describes how to detect that a launched component is ready, e.g. "action server
+ * move_group reachable" or "topic odom publishing at >= 10 Hz". The timeout is an upper
+ * bound after which loading continues anyway, unless the probe is required, in which case
+ * the feature fails to load. A probe of type "none" with a timeout simply waits for the timeout.
+ */
+struct ReadinessProbe
+{
+  ReadinessProbe(const std::string& type = probe_type::NONE
+  , const std::string& name = ""
+  , double timeout = 0.0
+  , bool required = false)
+  : type(type)
+  , name(name)
+  , min_rate(0.0)
+  , timeout(timeout)
+  , required(required)
+  {}
+
+  bool isEnabled() const
+  {
+    return type != probe_type::NONE || timeout > 0.0;
+  }
+
+  std::string type;
+  std::string name;   // Relative to the robot namespace unless it starts with '/'
+  double min_rate;    // Minimum publishing rate in Hz, used only by topic probes
+  double timeout;     // Seconds, 0 means the load timeout of the robot
+  bool required;      // Fail the load if the probe does not pass within the timeout
+};
+
+/**
+ * @brief Settings of the manipulation plan cache. Start states and goals are discretized
+ * with the given resolutions, so that nearly identical requests share a cached plan.
+ */
+struct PlanCacheConfig
+{
+  PlanCacheConfig()
+  : enabled(false)
+  , size(64)
+  , persistent(false)
+  , joint_resolution(0.01)
+  , position_resolution(0.005)
+  , orientation_resolution(0.01)
+  , validate(true)
+  {}
+
+  bool enabled;
+  unsigned int size;              // Maximum number of cached plans
+  bool persistent;                // Keep the cache in ~/.temoto over restarts
+  double joint_resolution;        // rad or m
+  double position_resolution;     // m
+  double orientation_resolution;  // Quaternion components
+  bool validate;                  // Check a cached plan against the planning scene before reusing it
+};
+
+namespace race_mode
+{
+const std::string FIRST = "first";        // Take the first valid plan
+const std::string SHORTEST = "shortest";  // Take the shortest plan found within the deadline
+}
+
+/**
+ * @brief Plans with several planners (and several instances of each planner) concurrently
+ * for a planning group. The planners which lose the race are terminated.
+ */
+struct PlannerRaceConfig
+{
+  PlannerRaceConfig()
+  : seeds(1)
+  , deadline(5.0)
+  , mode(race_mode::FIRST)
+  {}
+
+  std::vector<std::string> planner_ids;
+  unsigned int seeds;   // Number of concurrent instances per planner
+  double deadline;      // Seconds
+  std::string mode;
+};
+
   // Base class for all features
 class RobotFeature
 {
@@ -79,6 +184,17 @@ public:
     resource_id_ = id;
   }
 
+  // Load stages which have to be loaded before this feature
+  const std::vector<std::string>& getDependencies() const
+  {
+    return dependencies_;
+  }
+
+  const ReadinessProbe& getReadinessProbe() const
+  {
+    return readiness_probe_;
+  }
+
   bool setFromConfig(const YAML::Node& config, std::string& parameter)
   {
     if (config.IsDefined())
@@ -89,11 +205,58 @@ public:
     return false;
   }
 
+  bool setFromConfig(const YAML::Node& config, double& parameter)
+  {
+    if (config.IsDefined())
+    {
+      parameter = config.as<double>();
+      return true;
+    }
+    return false;
+  }
+
+  bool setFromConfig(const YAML::Node& config, std::vector<std::string>& parameter)
+  {
+    if (config.IsDefined())
+    {
+      parameter = config.as<std::vector<std::string>>();
+      return true;
+    }
+    return false;
+  }
+
+  bool setFromConfig(const YAML::Node& config, ReadinessProbe& probe)
+  {
+    if (!config.IsDefined())
+    {
+      return false;
+    }
+    // A probe without a type only waits for its timeout
+    probe = ReadinessProbe();
+    setFromConfig(config["type"], probe.type);
+    setFromConfig(config["name"], probe.name);
+    if (config["min_rate"].IsDefined())
+    {
+      probe.min_rate = config["min_rate"].as<double>();
+    }
+    if (config["timeout"].IsDefined())
+    {
+      probe.timeout = config["timeout"].as<double>();
+    }
+    if (config["required"].IsDefined())
+    {
+      probe.required = config["required"].as<bool>();
+    }
+    return true;
+  }
+
 protected:
   std::string name_;
   std::string package_name_;
   std::string executable_;
   std::string args_;
+  std::vector<std::string> dependencies_;
+  ReadinessProbe readiness_probe_;
   temoto_core::temoto_id::ID resource_id_;
   bool feature_enabled_;
   bool feature_loaded_;
@@ -150,21 +313,48 @@ public:
     return driver_args_;
   }
 
+  // Load stages which have to be loaded before the driver of this feature
+  const std::vector<std::string>& getDriverDependencies() const
+  {
+    return driver_dependencies_;
+  }
+
+  const ReadinessProbe& getDriverReadinessProbe() const
+  {
+    return driver_readiness_probe_;
+  }
+
 protected:
   bool driver_loaded_;
   bool driver_enabled_;
   std::string driver_package_name_;
   std::string driver_executable_;
   std::string driver_args_;
+  std::vector<std::string> driver_dependencies_;
+  ReadinessProbe driver_readiness_probe_;
   temoto_core::temoto_id::ID driver_resource_id_;
 };
 
 // URDF feature
+namespace urdf_loader
+{
+const std::string NATIVE = "native";   // Expanded and set by the robot manager
+const std::string SCRIPT = "script";   // Expanded and set by urdf_loader.py
+}
+
 class FeatureURDF : public RobotFeature
 {
   public:
   FeatureURDF();
   FeatureURDF(const YAML::Node& urdf_conf);
+
+  const std::string& getLoader() const
+  {
+    return loader_;
+  }
+
+private:
+  std::string loader_;
 };
 
 
@@ -190,10 +380,48 @@ public:
     //TODO: check if group exists
     active_planning_group_ = planning_group_name;
   }
+
+  /**
+   * @brief Maximum difference [rad or m] between a joint's current position and the start of
+   * a stored plan, after which the plan is considered outdated
+   */
+  double getStartStateTolerance() const
+  {
+    return start_state_tolerance_;
+  }
+
+  const PlanCacheConfig& getPlanCacheConfig() const
+  {
+    return plan_cache_config_;
+  }
+
+  // If set, the interfaces of the planning groups are created when a group is used first
+  bool hasLazyPlanningGroups() const
+  {
+    return lazy_planning_groups_;
+  }
+
+  bool hasPlannerRace(const std::string& planning_group_name) const
+  {
+    return planner_races_.find(planning_group_name) != planner_races_.end();
+  }
+
+  const PlannerRaceConfig& getPlannerRaceConfig(const std::string& planning_group_name) const
+  {
+    return planner_races_.at(planning_group_name);
+  }
   
 private:
+  void parsePlanCacheConfig(const YAML::Node& config);
+
+  void parsePlannerRaceConfigs(const YAML::Node& config);
+
   std::vector<std::string> planning_groups_;
   std::string active_planning_group_;
+  double start_state_tolerance_;
+  bool lazy_planning_groups_;
+  PlanCacheConfig plan_cache_config_;
+  std::map<std::string, PlannerRaceConfig> planner_races_;
 };
 
 
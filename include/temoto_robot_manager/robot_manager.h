@@ -25,14 +25,29 @@
 #include "temoto_robot_manager/robot_manager_services.h"
 #include "temoto_robot_manager/robot.h"
 #include "temoto_robot_manager/robot_config.h"
-#include <actionlib/client/simple_action_client.h>
+#include "temoto_robot_manager/robot_config_index.h"
+#include "temoto_robot_manager/remote_config_store.h"
+#include "temoto_robot_manager/readiness_monitor.h"
+#include "temoto_robot_manager/remote_client_pool.h"
+#include "temoto_robot_manager/metrics.h"
+#include "temoto_robot_manager/description_scanner.h"
+#include "temoto_robot_manager/RobotConfigSync.h"
 #include "std_msgs/String.h"
+#include <actionlib/client/simple_action_client.h>
 #include <tf2_geometry_msgs/tf2_geometry_msgs.h>
 #include <tf2_ros/transform_listener.h>
 #include <geometry_msgs/TransformStamped.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
 #include <mutex>
+#include <shared_mutex>
+#include <thread>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <boost/filesystem/operations.hpp>
 
 namespace temoto_robot_manager
@@ -40,12 +55,54 @@ namespace temoto_robot_manager
 // Forward declaration
 class Robot;
 
+/*
+ * The payload stays a string, so that the sync topic is compatible with the managers of the
+ * previous release. It carries either a serialized RobotConfigSync or the YAML document of
+ * the previous release
+ */
 typedef std_msgs::String PayloadType;
 
+// Packs the config sync into a payload of the sync topic
+PayloadType encodeConfigSync(const RobotConfigSync& config_sync);
+
+/**
+ * @brief Unpacks a config sync from a payload of the sync topic
+ * @return false if the payload is in the YAML format of the previous release
+ * @throws ros::serialization::StreamOverrunException if the payload is truncated
+ */
+bool decodeConfigSync(const PayloadType& payload, RobotConfigSync& config_sync);
+
+/**
+ * @brief Resources of the host which are kept free of warm standby robots. When either limit
+ * is exceeded, the robot which has been in standby the longest is unloaded
+ */
+struct WarmStandbyConfig
+{
+  // Available memory of the host (MB)
+  double min_available_memory = 1024.0;
+
+  // Load average per core
+  double max_cpu_load = 0.9;
+};
+
 class RobotManager : public temoto_core::BaseSubsystem
 {
 public:
-  RobotManager(const std::string& config_base_path);
+  /**
+   * @param hot_reload Watch the config base path for added or changed robot descriptions
+   * @param robot_status_rate Rate (Hz) of streaming the state of the local robots, 0 disables it
+   * @param enable_metrics Record the latencies from the start. Can be switched via the
+   * get_metrics service
+   * @param warm_standby_config Host resources for keeping the robots with warm_standby in
+   * their config running after they are unloaded
+   */
+  RobotManager(const std::string& config_base_path
+  , bool hot_reload = false
+  , double robot_status_rate = 10.0
+  , bool enable_metrics = false
+  , const WarmStandbyConfig& warm_standby_config = WarmStandbyConfig());
+
+  ~RobotManager();
 
   const std::string& getName() const
   {
@@ -53,6 +110,8 @@ public:
   }
 
 private:
+  // Measures the sync callback directly
+  friend class RobotManagerBenchmark;
 
   /**
    * @brief Restores the state of the Robot Manager via RR Catalog
@@ -60,6 +119,11 @@ private:
    */
   void restoreState();
 
+  /**
+   * @brief Recovers one robot of the restored RR catalog. Runs on a restore worker
+   */
+  void restoreRobot(const RobotLoad& query);
+
   /**
    * @brief Callback for loading a robot
    * @param Request that specifies the robot's parameters
@@ -83,6 +147,11 @@ private:
    */
   bool planManipulationPathCb(RobotPlanManipulation::Request& req, RobotPlanManipulation::Response& res);
 
+  /**
+   * @brief Plans for several goals concurrently. Each goal gets its own result and plan ID
+   */
+  bool planManipulationBatchCb(RobotPlanManipulationBatch::Request& req, RobotPlanManipulationBatch::Response& res);
+
   bool execManipulationPathCb(RobotExecutePlan::Request& req, RobotExecutePlan::Response& res);
 
   bool getManipulationTargetCb(RobotGetTarget::Request& req, RobotGetTarget::Response& res);
@@ -91,7 +160,49 @@ private:
 
   bool gripperControlPositionCb(RobotGripperControlPosition::Request& req, RobotGripperControlPosition::Response& res);
 
+  /**
+   * @brief Starts a navigation goal without blocking. The progress of the goal is published
+   * on the goal status topic
+   */
+  bool goalNavigationAsyncCb(RobotNavigationGoalAsync::Request& req, RobotNavigationGoalAsync::Response& res);
+
+  /**
+   * @brief Starts executing the last manipulation plan without blocking. The progress of the
+   * goal is published on the goal status topic
+   */
+  bool execManipulationPathAsyncCb(RobotExecutePlanAsync::Request& req, RobotExecutePlanAsync::Response& res);
+
+  bool cancelGoalCb(RobotCancelGoal::Request& req, RobotCancelGoal::Response& res);
+
+  /**
+   * @brief Returns the latest status of a goal, so that the clients which have missed the
+   * status messages can still resolve their goals
+   */
+  bool getGoalStatusCb(RobotGetGoalStatus::Request& req, RobotGetGoalStatus::Response& res);
+
+  /**
+   * @brief Starts navigating through a route of waypoints without blocking. Each passed
+   * waypoint is reported on the goal status topic
+   */
+  bool navigationRouteCb(RobotNavigationRoute::Request& req, RobotNavigationRoute::Response& res);
+
   bool getRobotConfigCb(RobotGetConfig::Request& req, RobotGetConfig::Response& res);
+
+  /**
+   * @brief Returns the configs of several robots in one call
+   */
+  bool getRobotConfigsCb(RobotGetConfigs::Request& req, RobotGetConfigs::Response& res);
+
+  /**
+   * @brief Finds the best local config of the robot, or the best remote one if there is no
+   * local config. Has to be called with registry_mutex_ held
+   * @return nullptr if the robot is not known
+   */
+  RobotConfigPtr findConfig(const std::string& robot_name);
+
+  bool getMetricsCb(RobotGetMetrics::Request& req, RobotGetMetrics::Response& res);
+
+  void publishMetrics(const ros::WallTimerEvent& event);
   
   bool setModeCb(RobotSetMode::Request& req, RobotSetMode::Response& res);
 
@@ -99,35 +210,293 @@ private:
 
   void advertiseConfig(RobotConfigPtr config);
 
-  void advertiseConfigs(RobotConfigs configs);
+  /**
+   * @brief Advertises the full configs together with their revisions. Receivers skip the
+   * configs of which they already know the same or a newer revision
+   * @param complete The configs are all local configs, advertised even if there are none
+   */
+  void advertiseConfigs(RobotConfigs configs, bool complete = false);
+
+  // Advertises all local configs
+  void advertiseLocalConfigs();
+
+  /**
+   * @brief Asks the manager in the given temoto namespace to advertise all of its configs.
+   * The other managers do not respond to it
+   */
+  void requestConfigs(const std::string& temoto_namespace);
+
+  /**
+   * @brief Advertises only the reliability of the config, without the YAML of the config.
+   * The revision of the config has to be bumped before
+   */
+  void advertiseReliability(RobotConfigPtr config);
+
+  void advertiseConfigSync(const RobotConfigSync& config_sync);
+
+  /**
+   * @brief Applies the advertised configs and reliabilities of a remote manager. The
+   * connections to a restarted manager are not valid anymore, they are dropped
+   */
+  void applyConfigDelta(const std::string& temoto_namespace, const RobotConfigSync& config_sync);
+
+  /**
+   * @brief Applies a YAML payload of a manager of the previous release, either a delta
+   * with revisions or all configs of the manager
+   * \TODO Remove in the next release
+   */
+  void applyLegacyPayload(const std::string& temoto_namespace, const std::string& payload);
 
   RobotConfigs parseRobotConfigs(const YAML::Node& config);
-  
-  RobotConfigs parseRobotConfigs(const YAML::Node& config, RobotConfigs configs);  
 
-  RobotConfigPtr findRobot(const std::string& robot_name, const RobotConfigs& robot_infos);
+  RobotConfigPtr findRobot(const std::string& robot_name, const RobotConfigIndex& robot_infos);
+
+  /**
+   * @brief Chooses between the local config and the configs of remote managers by their
+   * reliability and the load of their hosts. Logs the decision
+   * @param local_only Do not consider remote managers
+   * @param is_local Set to true if the local config was chosen
+   * @return nullptr if no config was found
+   */
+  RobotConfigPtr selectRobot(const std::string& robot_name, bool local_only, bool& is_local);
+
+  /**
+   * @brief Counts a load forwarded to a remote manager in the selection score of its host
+   * @param loaded The robot was loaded, it counts until the next host status of the manager
+   */
+  void beginForwardedLoad(const std::string& temoto_namespace);
+  void endForwardedLoad(const std::string& temoto_namespace, bool loaded);
+
+  HostStatus getHostStatus() const;
+
+  /**
+   * @brief Renews the lease of the remote manager. The configs of a manager which was not
+   * known to be alive are requested
+   */
+  void hostStatusCb(const HostStatus& msg);
+
+  /**
+   * @brief Drops the configs, host status and clients of the remote managers whose lease has
+   * expired, so that the requests are not forwarded to them
+   */
+  void evictExpiredManagers(const ros::WallTimerEvent& event);
+
+  void publishHostStatus(const ros::WallTimerEvent& event);
+
+  // Computes the state of each local robot once and publishes them in one message
+  void publishRobotStatus(const ros::WallTimerEvent& event);
+
+  void robotStatusCb(const RobotStatusArray& msg);
+
+  /**
+   * @brief Reads the end effector pose of the active planning group from the state that
+   * was relayed by a remote manager
+   * @return false if there is no recent state of the robot
+   */
+  bool getRemoteManipulationTarget(const std::string& temoto_namespace
+  , const std::string& robot_name
+  , geometry_msgs::Pose& pose) const;
 
   bool getVizInfoCb(RobotGetVizInfo::Request& req,
                     RobotGetVizInfo::Response& res);
 
   void resourceStatusCb(RobotLoad srv_msg, temoto_resource_registrar::Status status_msg);
 
-  void readRobotDescription(const std::string& path_file_rob_description);
+  /**
+   * @brief Parses the robot configs of a robot_description.yaml file
+   * @param content_hash Set to the hash of the file content
+   */
+  RobotConfigs readRobotDescription(const std::string& path_file_rob_description, size_t& content_hash);
 
-  void findRobotDescriptionFiles(boost::filesystem::path current_dir);
+  /**
+   * @brief Finds and parses all robot descriptions in parallel and advertises the
+   * robots once all of them are known
+   */
+  void discoverRobotDescriptions(const std::string& config_base_path, bool hot_reload);
+
+  /**
+   * @brief Adds the robots of an added or changed robot description and advertises them.
+   * The configs of robots which were defined by the same file are replaced
+   */
+  void reloadRobotDescription(const std::string& path_file_rob_description);
 
   std::shared_ptr<Robot> findLoadedRobot(const std::string& robot_name);
 
   typedef std::shared_ptr<Robot> RobotPtr;  
+
+  /**
+   * @brief A goal that is executed by a worker thread, so that long motions do not
+   * occupy the threads which serve the requests
+   */
+  struct AsyncGoal
+  {
+    std::string goal_id;
+    std::string robot_name;
+    std::string goal_type;
+    std::function<bool(AsyncGoal&)> execute;
+    std::function<void(const AsyncGoal&)> cancel;
+    std::atomic<bool> cancel_requested{false};
+    std::atomic<bool> finished{false};
+    std::atomic<int> waypoint_index{-1};
+    unsigned int waypoint_count = 0;
+    std::thread worker;
+
+    // Latest published status, answers the status queries of the clients which missed it
+    RobotGoalStatus last_status;
+    ros::WallTime finish_time;
+    std::mutex status_mutex;
+  };
+  typedef std::shared_ptr<AsyncGoal> AsyncGoalPtr;
+
+  /**
+   * @brief Starts the goal in a worker thread
+   * @return ID of the goal
+   */
+  std::string startAsyncGoal(const std::string& goal_id
+  , const std::string& robot_name
+  , const std::string& goal_type
+  , std::function<bool(AsyncGoal&)> execute
+  , std::function<void(const AsyncGoal&)> cancel
+  , unsigned int waypoint_count = 0);
+
+  /**
+   * @brief Runs the route goal on a remote robot manager and relays its progress to the
+   * local goal status topic
+   * @return true if the remote manager reported that the route was finished
+   */
+  bool forwardNavigationRoute(const std::string& temoto_namespace
+  , RobotNavigationRoute::Request req
+  , AsyncGoal& goal);
+
+  void publishGoalStatus(AsyncGoal& goal, uint8_t status, const std::string& message = "");
+
+  // Joins the workers of finished goals and drops the goals which have been finished for
+  // longer than the retention period. Has to be called with async_goals_mutex_ held
+  void reapFinishedGoals();
+
+  void reapGoalsCb(const ros::WallTimerEvent& event);
+
+  /**
+   * @brief Re-attaches the robot from warm standby, or starts the robot if there is none.
+   * The robots which are still being preloaded are rejected by the load query beforehand
+   */
+  RobotPtr loadWarmRobot(RobotConfigPtr config, const std::string& resource_id);
+
+  struct StandbyRobot;
+
+  /**
+   * @brief Starts the robot on a separate thread, so that its resources do not depend on a
+   * load query and keep running after the robot is unloaded
+   * @param standby Moves the started robot to standby, e.g. when it is preloaded
+   */
+  StandbyRobot startWarmRobot(RobotConfigPtr config, bool standby);
+
+  /**
+   * @brief Unloads the resources of the warm standby robots which were left running by a
+   * previous instance of the manager
+   */
+  void unloadOrphanedStandbyResources();
+
+  /**
+   * @brief Keeps the unloaded robot running if the host has resources for it
+   * @return false if the robot has to be unloaded
+   */
+  bool moveToStandby(RobotPtr robot);
+
+  bool hasStandbyRobot(const std::string& robot_name) const;
+
+  // Whether the robot is still being preloaded into warm standby
+  bool isStandbyRobotStarting(const std::string& robot_name) const;
+
+  // Starts the robots which are preloaded by their config
+  void preloadRobots();
+
+  bool isStandbyBudgetExceeded() const;
+
+  /**
+   * @brief Unloads the standby robots which have idled longer than their timeout, and the
+   * longest idling one when the host is short of resources
+   */
+  void evictStandbyRobots(const ros::WallTimerEvent& event);
   
-  std::vector<RobotPtr> loaded_robots_;
-  RobotConfigs local_configs_;
-  RobotConfigs remote_configs_;
+  // Latency histograms, declared before the robots which record into it
+  Metrics metrics_;
+
+  /*
+   * The registry of robots and configs is shared between the service callbacks. Readers
+   * take a shared lock, modifications take an exclusive lock. Robots are loaded and
+   * commanded outside of the lock, commands to the same robot are serialized by the robot.
+   */
+  std::unordered_map<std::string, RobotPtr> loaded_robots_;
+  RobotConfigIndex local_configs_;
+  RemoteConfigStore remote_configs_;
+  mutable std::shared_timed_mutex registry_mutex_;
+
+  // Robots which are being loaded, they are added to loaded_robots_ once they are ready
+  std::unordered_set<std::string> loading_robots_;
+
+  /*
+   * Robots which are not loaded but keep their resources running, by robot name. The robots
+   * which are being preloaded are included, their future becomes ready once they are started
+   */
+  struct StandbyRobot
+  {
+    RobotPtr robot;
+    std::shared_future<void> started;
+    ros::WallTime idle_since;
+
+    bool isStarting() const
+    {
+      return started.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+    }
+  };
+  std::unordered_map<std::string, StandbyRobot> standby_robots_;
+  mutable std::mutex standby_mutex_;
+  const WarmStandbyConfig warm_standby_config_;
+  ros::WallTimer standby_timer_;
+
+  // Robots of the restored RR catalog which are not recovered yet
+  std::unordered_set<std::string> recovering_robots_;
+  std::vector<std::thread> restore_workers_;
+
+  /*
+   * Revisions start over when a manager restarts. Each advertisement carries the start time
+   * of the manager, and the revisions of a namespace are discarded when it changes
+   */
+  const uint64_t sync_epoch_;
+
+  // The last host status of each remote manager
+  struct RemoteHost
+  {
+    HostStatus status;
+    ros::WallTime received;
+  };
+  std::unordered_map<std::string, RemoteHost> remote_hosts_;
+
+  // Loads forwarded to the remote managers, guarded by remote_hosts_mutex_
+  struct ForwardedLoads
+  {
+    unsigned int in_progress = 0;
+    unsigned int unreported = 0;
+  };
+  std::unordered_map<std::string, ForwardedLoads> forwarded_loads_;
+  mutable std::mutex remote_hosts_mutex_;
+  std::atomic<unsigned int> pending_loads_{0};
+
+  // The latest robot states relayed by each remote manager
+  struct RemoteRobotStatus
+  {
+    std::unordered_map<std::string, RobotStatus> robots;
+    ros::WallTime received;
+  };
+  std::unordered_map<std::string, RemoteRobotStatus> remote_robot_status_;
+  mutable std::mutex remote_robot_status_mutex_;
 
   geometry_msgs::PoseStamped default_target_pose_;
 
   ros::NodeHandle nh_;
   ros::ServiceServer server_plan_;
+  ros::ServiceServer server_plan_batch_;
   ros::ServiceServer server_exec_;
   ros::ServiceServer server_get_viz_cfg_;
   ros::ServiceServer server_set_manipulation_target_;
@@ -136,24 +505,57 @@ private:
   ros::ServiceServer server_navigation_goal_;
   ros::ServiceServer server_gripper_control_position_;
   ros::ServiceServer server_get_robot_config_;
-
-  ros::ServiceClient client_plan_;
-  ros::ServiceClient client_exec_;
-  ros::ServiceClient client_get_viz_cfg_;
-  ros::ServiceClient client_set_manipulation_target_;
-  ros::ServiceClient client_get_manipulation_target_;
-  ros::ServiceClient client_set_mode_;
-  ros::ServiceClient client_navigation_goal_;
-  ros::ServiceClient client_gripper_control_position_;
+  ros::ServiceServer server_get_robot_configs_;
+  ros::ServiceServer server_navigation_goal_async_;
+  ros::ServiceServer server_exec_async_;
+  ros::ServiceServer server_cancel_goal_;
+  ros::ServiceServer server_get_goal_status_;
+  ros::ServiceServer server_navigation_route_;
+  ros::Publisher goal_status_pub_;
+  ros::Publisher host_status_pub_;
+  ros::Subscriber host_status_sub_;
+  ros::WallTimer host_status_timer_;
+  ros::WallTimer lease_timer_;
+  ros::Publisher robot_status_pub_;
+  ros::Subscriber robot_status_sub_;
+  ros::WallTimer robot_status_timer_;
+  ros::ServiceServer server_get_metrics_;
+  ros::Publisher metrics_pub_;
+  ros::WallTimer metrics_timer_;
+
+  std::map<std::string, AsyncGoalPtr> async_goals_;
+  std::mutex async_goals_mutex_;
+  ros::WallTimer goal_reap_timer_;
+  unsigned int async_goal_count_ = 0;
+
+  // Persistent clients for forwarding the requests to remote robot managers
+  RemoteClientPool remote_clients_;
   
   // Keeps robot_infos in sync with other managers
   temoto_core::trr::ConfigSynchronizer<RobotManager, PayloadType> config_syncer_;
 
+  // Content hash and robot names of each robot description file
+  struct RobotDescription
+  {
+    size_t content_hash = 0;
+    std::vector<std::string> robot_names;
+  };
+  std::unordered_map<std::string, RobotDescription> robot_descriptions_;
+
   temoto_resource_registrar::ResourceRegistrarRos1 resource_registrar_;
   temoto_resource_registrar::Configuration rr_catalog_config_;
 
+  // Shared by all robots for detecting when their topics and parameters become available
+  ReadinessMonitor readiness_monitor_;
+
+  // Shared by all robots, so that robots with the same model expand it only once
+  UrdfCache urdf_cache_;
+
   tf2_ros::TransformListener tf2_listener;
   tf2_ros::Buffer tf2_buffer;
+
+  // Declared last, so that the watcher stops before the rest of the manager is destroyed
+  std::unique_ptr<DescriptionScanner> description_scanner_;
 };
 }
 
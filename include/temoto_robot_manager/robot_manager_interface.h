@@ -19,10 +19,19 @@
 
 #include "rr/ros1_resource_registrar.h"
 #include "temoto_robot_manager/robot_manager_services.h"
+#include "temoto_core/ConfigSync.h"
 #include "yaml-cpp/yaml.h"
 #include <vector>
 #include <string>
-#include <ctime>
+#include <functional>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
 
 namespace temoto_robot_manager
 {
@@ -49,6 +58,8 @@ public:
 
       client_plan_ =
         nh_.serviceClient<RobotPlanManipulation>(srv_name::SERVER_PLAN);
+      client_plan_batch_ =
+        nh_.serviceClient<RobotPlanManipulationBatch>(srv_name::SERVER_PLAN_BATCH);
       client_exec_ =
         nh_.serviceClient<RobotExecutePlan>(srv_name::SERVER_EXECUTE);
       client_viz_info_ =
@@ -63,6 +74,24 @@ public:
         nh_.serviceClient<RobotGripperControlPosition>(srv_name::SERVER_GRIPPER_CONTROL_POSITION);
       client_get_robot_config_ =
         nh_.serviceClient<RobotGetConfig>(srv_name::SERVER_GET_CONFIG);
+      client_get_robot_configs_ =
+        nh_.serviceClient<RobotGetConfigs>(srv_name::SERVER_GET_CONFIGS);
+      client_navigation_goal_async_ =
+        nh_.serviceClient<RobotNavigationGoalAsync>(srv_name::SERVER_NAVIGATION_GOAL_ASYNC);
+      client_exec_async_ =
+        nh_.serviceClient<RobotExecutePlanAsync>(srv_name::SERVER_EXECUTE_ASYNC);
+      client_cancel_goal_ =
+        nh_.serviceClient<RobotCancelGoal>(srv_name::SERVER_CANCEL_GOAL);
+      client_get_goal_status_ =
+        nh_.serviceClient<RobotGetGoalStatus>(srv_name::SERVER_GET_GOAL_STATUS);
+      client_navigation_route_ =
+        nh_.serviceClient<RobotNavigationRoute>(srv_name::SERVER_NAVIGATION_ROUTE);
+      goal_status_sub_ =
+        nh_.subscribe(srv_name::GOAL_STATUS_TOPIC, 100, &RobotManagerInterface::goalStatusCb, this);
+      goal_watchdog_timer_ =
+        nh_.createWallTimer(ros::WallDuration(1.0), &RobotManagerInterface::goalWatchdogCb, this);
+      config_sync_sub_ =
+        nh_.subscribe(srv_name::SYNC_TOPIC, 100, &RobotManagerInterface::configSyncCb, this);
 
       initialized_ = true;
     }
@@ -74,13 +103,24 @@ public:
 
   unsigned int createID()
   {
-    std::srand(std::time(nullptr));
-    return std::rand();
+    std::random_device random_device;
+    return std::uniform_int_distribution<unsigned int>()(random_device);
   }
 
+  /**
+   * @brief Returns the config of the robot. The configs are cached until a robot manager
+   * advertises a change of the configs
+   */
   YAML::Node getRobotConfig(const std::string& robot_name)
   try
   {
+    YAML::Node cached_config;
+    if (findCachedConfig(robot_name, cached_config))
+    {
+      return cached_config;
+    }
+
+    unsigned int cache_generation = getCacheGeneration();
     temoto_robot_manager::RobotGetConfig msg;
     msg.request.robot_name = robot_name;
     if (client_get_robot_config_.call(msg))
@@ -89,7 +129,9 @@ public:
       {
         throw TEMOTO_ERRSTACK("Could not get the config of robot '" + robot_name + "'");
       }
-      return YAML::Load(msg.response.robot_config);
+      YAML::Node config = YAML::Load(msg.response.robot_config);
+      cacheConfig(robot_name, config, cache_generation);
+      return config;
     }
     else
     {
@@ -101,6 +143,64 @@ public:
     throw TEMOTO_ERRSTACK(e.what());
   }
 
+  /**
+   * @brief Returns the configs of the robots, in the same order. The configs which are not
+   * cached are requested in a single call
+   */
+  std::vector<YAML::Node> getRobotConfigs(const std::vector<std::string>& robot_names)
+  try
+  {
+    std::vector<YAML::Node> configs(robot_names.size());
+    std::vector<unsigned int> missing_indices;
+    temoto_robot_manager::RobotGetConfigs msg;
+    for (unsigned int i = 0; i < robot_names.size(); i++)
+    {
+      if (!findCachedConfig(robot_names[i], configs[i]))
+      {
+        missing_indices.push_back(i);
+        msg.request.robot_names.push_back(robot_names[i]);
+      }
+    }
+
+    if (missing_indices.empty())
+    {
+      return configs;
+    }
+
+    unsigned int cache_generation = getCacheGeneration();
+    if (!client_get_robot_configs_.call(msg))
+    {
+      throw TEMOTO_ERRSTACK("Unable to reach robot_manager");
+    }
+
+    if (msg.response.found.size() < missing_indices.size()
+    || msg.response.robot_configs.size() < missing_indices.size())
+    {
+      std::string missing_names;
+      for (unsigned int i = std::min(msg.response.found.size(), msg.response.robot_configs.size()); i < missing_indices.size(); i++)
+      {
+        missing_names += (missing_names.empty() ? "'" : ", '") + robot_names[missing_indices[i]] + "'";
+      }
+      throw TEMOTO_ERRSTACK("The robot manager did not return the configs of robots " + missing_names);
+    }
+
+    for (unsigned int i = 0; i < missing_indices.size(); i++)
+    {
+      const std::string& robot_name = robot_names[missing_indices[i]];
+      if (!msg.response.found[i])
+      {
+        throw TEMOTO_ERRSTACK("Could not get the config of robot '" + robot_name + "'");
+      }
+      configs[missing_indices[i]] = YAML::Load(msg.response.robot_configs[i]);
+      cacheConfig(robot_name, configs[missing_indices[i]], cache_generation);
+    }
+    return configs;
+  }
+  catch(const std::exception& e)
+  {
+    throw TEMOTO_ERRSTACK(e.what());
+  }
+
   void loadRobot(const std::string& robot_name)
   try
   {
@@ -112,6 +212,7 @@ public:
     , load_robot_msg
     , std::bind(&RobotManagerInterface::statusInfoCb, this, std::placeholders::_1, std::placeholders::_2));
 
+    std::lock_guard<std::mutex> lock(allocated_robots_mutex_);
     allocated_robots_.push_back(load_robot_msg);
   }
   catch(resource_registrar::TemotoErrorStack e)
@@ -119,8 +220,80 @@ public:
     throw FWD_TEMOTO_ERRSTACK(e);
   }
 
+  /*
+   * Non-blocking variants of the calls. The calls run on a pool of at most MAX_ASYNC_CALLS
+   * threads, so that the commands to several robots are in flight at the same time. The
+   * future rethrows the error of the call. The destructor waits for the running calls, the
+   * futures of the calls which have not started yet throw std::future_error
+   */
+  std::future<void> loadRobotFuture(const std::string& robot_name)
+  {
+    return runAsync<void>([this, robot_name]
+    {
+      loadRobot(robot_name);
+    });
+  }
 
-  void planManipulation(const std::string& robot_name, std::string planning_group = "")
+  std::future<std::string> planManipulationFuture(const std::string& robot_name
+  , const std::string& planning_group
+  , const geometry_msgs::PoseStamped& pose
+  , const std::string& start_plan_id = "")
+  {
+    return runAsync<std::string>([this, robot_name, planning_group, pose, start_plan_id]
+    {
+      return planManipulation(robot_name, planning_group, pose, start_plan_id);
+    });
+  }
+
+  std::future<std::string> planManipulationFuture(const std::string& robot_name
+  , const std::string& planning_group
+  , const std::string& named_target_pose
+  , const std::string& start_plan_id = "")
+  {
+    return runAsync<std::string>([this, robot_name, planning_group, named_target_pose, start_plan_id]
+    {
+      return planManipulation(robot_name, planning_group, named_target_pose, start_plan_id);
+    });
+  }
+
+  std::future<void> executePlanFuture(const std::string& robot_name, const std::string& plan_id = "")
+  {
+    return runAsync<void>([this, robot_name, plan_id]
+    {
+      executePlan(robot_name, plan_id);
+    });
+  }
+
+  std::future<void> navigationGoalFuture(const std::string& robot_name
+  , const std::string& reference_frame
+  , const geometry_msgs::PoseStamped& pose)
+  {
+    return runAsync<void>([this, robot_name, reference_frame, pose]
+    {
+      navigationGoal(robot_name, reference_frame, pose);
+    });
+  }
+
+  std::future<geometry_msgs::Pose> getEndEffPoseFuture(const std::string& robot_name)
+  {
+    return runAsync<geometry_msgs::Pose>([this, robot_name]
+    {
+      return getEndEffPose(robot_name);
+    });
+  }
+
+  std::future<void> controlGripperPositionFuture(const std::string& robot_name, float position)
+  {
+    return runAsync<void>([this, robot_name, position]
+    {
+      controlGripperPosition(robot_name, position);
+    });
+  }
+
+  /**
+   * @return ID of the plan, which can be passed to executePlan
+   */
+  std::string planManipulation(const std::string& robot_name, std::string planning_group = "")
   {
     temoto_robot_manager::RobotPlanManipulation msg;
     msg.request.use_default_target = true;
@@ -136,11 +309,13 @@ public:
     {
       throw TEMOTO_ERRSTACK("Unsuccessful attempt to invoke 'planManipulation'");
     }
+    return msg.response.plan_id;
   }
 
-  void planManipulation(const std::string& robot_name
+  std::string planManipulation(const std::string& robot_name
   , const std::string& planning_group
-  , const geometry_msgs::PoseStamped& pose)
+  , const geometry_msgs::PoseStamped& pose
+  , const std::string& start_plan_id = "")
   {
     temoto_robot_manager::RobotPlanManipulation msg;
     msg.request.use_default_target = false;
@@ -148,6 +323,7 @@ public:
     msg.request.target_pose = pose;
     msg.request.planning_group = planning_group;
     msg.request.robot_name = robot_name;
+    msg.request.start_plan_id = start_plan_id;
     
     if (!client_plan_.call(msg))
     {
@@ -158,11 +334,13 @@ public:
     {
       throw TEMOTO_ERRSTACK("Unsuccessful attempt to 'planManipulation'");
     }
+    return msg.response.plan_id;
   }
 
-  void planManipulation(const std::string& robot_name
+  std::string planManipulation(const std::string& robot_name
   , const std::string& planning_group
-  , const std::string& named_target_pose)
+  , const std::string& named_target_pose
+  , const std::string& start_plan_id = "")
   {
     temoto_robot_manager::RobotPlanManipulation msg;
     msg.request.use_default_target = false;
@@ -170,6 +348,7 @@ public:
     msg.request.named_target = named_target_pose;
     msg.request.planning_group = planning_group;
     msg.request.robot_name = robot_name;
+    msg.request.start_plan_id = start_plan_id;
     
     if (!client_plan_.call(msg))
     {
@@ -180,12 +359,126 @@ public:
     {
       throw TEMOTO_ERRSTACK("Unsuccessful attempt to invoke 'planManipulation'");
     }
+    return msg.response.plan_id;
   }
 
-  void executePlan(const std::string& robot_name)
+  /**
+   * @brief Plans a path of straight end effector segments through the waypoints
+   * @param eef_step Maximum step of the end effector between path points [m]
+   * @param jump_threshold 0 disables the check for jumps in the joint space
+   */
+  std::string planCartesianPath(const std::string& robot_name
+  , const std::string& planning_group
+  , const std::vector<geometry_msgs::Pose>& waypoints
+  , double eef_step = 0.01
+  , double jump_threshold = 0.0
+  , const std::string& start_plan_id = "")
+  {
+    temoto_robot_manager::RobotPlanManipulation msg;
+    msg.request.planning_mode = temoto_robot_manager::RobotPlanManipulation::Request::CARTESIAN;
+    msg.request.cartesian_waypoints = waypoints;
+    msg.request.eef_step = eef_step;
+    msg.request.jump_threshold = jump_threshold;
+    msg.request.planning_group = planning_group;
+    msg.request.robot_name = robot_name;
+    msg.request.start_plan_id = start_plan_id;
+
+    if (!client_plan_.call(msg))
+    {
+      throw TEMOTO_ERRSTACK("Unable to reach robot_manager");
+    }
+
+    if (!msg.response.success)
+    {
+      throw TEMOTO_ERRSTACK("Unsuccessful attempt to invoke 'planCartesianPath'");
+    }
+    return msg.response.plan_id;
+  }
+
+  /**
+   * @brief Plans a path which is interpolated in the joint space, without a sampling based planner
+   */
+  std::string planJointPath(const std::string& robot_name
+  , const std::string& planning_group
+  , const std::vector<std::string>& joint_names
+  , const std::vector<double>& joint_values
+  , const std::string& start_plan_id = "")
+  {
+    temoto_robot_manager::RobotPlanManipulation msg;
+    msg.request.planning_mode = temoto_robot_manager::RobotPlanManipulation::Request::JOINT;
+    msg.request.joint_names = joint_names;
+    msg.request.joint_values = joint_values;
+    msg.request.planning_group = planning_group;
+    msg.request.robot_name = robot_name;
+    msg.request.start_plan_id = start_plan_id;
+
+    if (!client_plan_.call(msg))
+    {
+      throw TEMOTO_ERRSTACK("Unable to reach robot_manager");
+    }
+
+    if (!msg.response.success)
+    {
+      throw TEMOTO_ERRSTACK("Unsuccessful attempt to invoke 'planJointPath'");
+    }
+    return msg.response.plan_id;
+  }
+
+  std::string planJointPath(const std::string& robot_name
+  , const std::string& planning_group
+  , const std::string& named_target
+  , const std::string& start_plan_id = "")
+  {
+    temoto_robot_manager::RobotPlanManipulation msg;
+    msg.request.planning_mode = temoto_robot_manager::RobotPlanManipulation::Request::JOINT;
+    msg.request.use_named_target = true;
+    msg.request.named_target = named_target;
+    msg.request.planning_group = planning_group;
+    msg.request.robot_name = robot_name;
+    msg.request.start_plan_id = start_plan_id;
+
+    if (!client_plan_.call(msg))
+    {
+      throw TEMOTO_ERRSTACK("Unable to reach robot_manager");
+    }
+
+    if (!msg.response.success)
+    {
+      throw TEMOTO_ERRSTACK("Unsuccessful attempt to invoke 'planJointPath'");
+    }
+    return msg.response.plan_id;
+  }
+
+  /**
+   * @brief Plans for all goals concurrently
+   * @return One result per goal with the ID of its plan, which can be passed to executePlan
+   */
+  std::vector<RobotPlanResult> planManipulationBatch(const std::string& robot_name
+  , const std::vector<RobotPlanGoal>& goals)
+  {
+    temoto_robot_manager::RobotPlanManipulationBatch msg;
+    msg.request.robot_name = robot_name;
+    msg.request.goals = goals;
+    if (!client_plan_batch_.call(msg))
+    {
+      throw TEMOTO_ERRSTACK("Unable to reach robot_manager");
+    }
+
+    if (!msg.response.success)
+    {
+      throw TEMOTO_ERRSTACK("Unsuccessful attempt to invoke 'planManipulationBatch'");
+    }
+    return msg.response.results;
+  }
+
+  /**
+   * @param plan_id ID of the plan. The latest plan of the active planning group is executed when empty
+   */
+  void executePlan(const std::string& robot_name, const std::string& plan_id = "")
   {
     temoto_robot_manager::RobotExecutePlan msg;
     msg.request.robot_name = robot_name;
+    msg.request.plan_id = plan_id;
     if (!client_exec_.call(msg))
     {
       throw TEMOTO_ERRSTACK("Unable to reach robot_manager");
@@ -266,6 +559,120 @@ public:
     }
   }
 
+  /**
+   * @brief Sends a navigation goal without waiting for the robot to reach it
+   * @return Future which becomes ready when the goal has succeeded, failed or was canceled.
+   * The ID of the goal is in the status message and can be used for cancelling the goal
+   */
+  std::shared_future<RobotGoalStatus> navigationGoalAsync(const std::string& robot_name
+  , const std::string& reference_frame
+  , const geometry_msgs::PoseStamped& pose)
+  {
+    temoto_robot_manager::RobotNavigationGoalAsync msg;
+    msg.request.reference_frame = reference_frame;
+    msg.request.target_pose = pose;
+    msg.request.robot_name = robot_name;
+    msg.request.goal_id = createGoalId();
+
+    std::shared_future<RobotGoalStatus> goal_future = registerGoal(msg.request.goal_id);
+    if (!client_navigation_goal_async_.call(msg))
+    {
+      unregisterGoal(msg.request.goal_id);
+      throw TEMOTO_ERRSTACK("Unable to reach robot_manager");
+    }
+
+    if (!msg.response.success)
+    {
+      unregisterGoal(msg.request.goal_id);
+      throw TEMOTO_ERRSTACK("Unsuccessful attempt to invoke 'navigationGoalAsync'");
+    }
+    acceptGoal(msg.request.goal_id);
+    return goal_future;
+  }
+
+  /**
+   * @brief Starts executing the last plan without waiting for the execution to finish
+   * @return Future which becomes ready when the execution has succeeded, failed or was canceled
+   */
+  std::shared_future<RobotGoalStatus> executePlanAsync(const std::string& robot_name
+  , const std::string& plan_id = "")
+  {
+    temoto_robot_manager::RobotExecutePlanAsync msg;
+    msg.request.robot_name = robot_name;
+    msg.request.plan_id = plan_id;
+    msg.request.goal_id = createGoalId();
+
+    std::shared_future<RobotGoalStatus> goal_future = registerGoal(msg.request.goal_id);
+    if (!client_exec_async_.call(msg))
+    {
+      unregisterGoal(msg.request.goal_id);
+      throw TEMOTO_ERRSTACK("Unable to reach robot_manager");
+    }
+
+    if (!msg.response.success)
+    {
+      unregisterGoal(msg.request.goal_id);
+      throw TEMOTO_ERRSTACK("Unsuccessful attempt to invoke 'executePlanAsync'");
+    }
+    acceptGoal(msg.request.goal_id);
+    return goal_future;
+  }
+
+  typedef std::function<void(const RobotGoalStatus&)> GoalFeedbackCb;
+
+  /**
+   * @brief Sends the robot through a route of waypoints without stopping at each of them
+   * @param tolerances Either empty or the distance per waypoint within which it counts as passed
+   * @param look_ahead_radius Distance to the current waypoint at which the next one is sent
+   * @param feedback_cb Invoked each time a waypoint is passed
+   * @return Future which becomes ready when the route has succeeded, failed or was canceled
+   */
+  std::shared_future<RobotGoalStatus> navigationRoute(const std::string& robot_name
+  , const std::string& reference_frame
+  , const std::vector<geometry_msgs::PoseStamped>& route
+  , const std::vector<double>& tolerances = {}
+  , double look_ahead_radius = 0.0
+  , GoalFeedbackCb feedback_cb = GoalFeedbackCb())
+  {
+    temoto_robot_manager::RobotNavigationRoute msg;
+    msg.request.reference_frame = reference_frame;
+    msg.request.robot_name = robot_name;
+    msg.request.route = route;
+    msg.request.tolerances = tolerances;
+    msg.request.look_ahead_radius = look_ahead_radius;
+    msg.request.goal_id = createGoalId();
+
+    std::shared_future<RobotGoalStatus> goal_future = registerGoal(msg.request.goal_id, feedback_cb);
+    if (!client_navigation_route_.call(msg))
+    {
+      unregisterGoal(msg.request.goal_id);
+      throw TEMOTO_ERRSTACK("Unable to reach robot_manager");
+    }
+
+    if (!msg.response.success)
+    {
+      unregisterGoal(msg.request.goal_id);
+      throw TEMOTO_ERRSTACK("Unsuccessful attempt to invoke 'navigationRoute'");
+    }
+    acceptGoal(msg.request.goal_id);
+    return goal_future;
+  }
+
+  void cancelGoal(const std::string& goal_id)
+  {
+    temoto_robot_manager::RobotCancelGoal msg;
+    msg.request.goal_id = goal_id;
+    if (!client_cancel_goal_.call(msg))
+    {
+      throw TEMOTO_ERRSTACK("Unable to reach robot_manager");
+    }
+
+    if (!msg.response.success)
+    {
+      throw TEMOTO_ERRSTACK("Unsuccessful attempt to invoke 'cancelGoal'");
+    }
+  }
+
   void controlGripperPosition(const std::string& robot_name, const float& position)
   {
     temoto_robot_manager::RobotGripperControlPosition msg;    
@@ -325,31 +732,331 @@ public:
     throw FWD_TEMOTO_ERRSTACK(e);
   }
 
+  /**
+   * @brief Fails the goals which have not finished within the timeout. The goals are
+   * cancelled on the robot manager. Zero disables the timeout
+   */
+  void setGoalTimeout(double timeout)
+  {
+    std::lock_guard<std::mutex> lock(pending_goals_mutex_);
+    goal_timeout_ = timeout;
+  }
+
+  void goalStatusCb(const RobotGoalStatus& msg)
+  {
+    if (isFinalStatus(msg.status))
+    {
+      resolveGoal(msg);
+      return;
+    }
+
+    GoalFeedbackCb feedback_cb;
+    {
+      std::lock_guard<std::mutex> lock(pending_goals_mutex_);
+      auto goal_it = pending_goals_.find(msg.goal_id);
+      if (goal_it == pending_goals_.end())
+      {
+        return;
+      }
+      goal_it->second.last_update = ros::WallTime::now();
+      feedback_cb = goal_it->second.feedback_cb;
+    }
+
+    if (feedback_cb && msg.waypoint_index >= 0)
+    {
+      feedback_cb(msg);
+    }
+  }
+
+  // Any change of the configs is advertised on the sync topic
+  void configSyncCb(const temoto_core::ConfigSync& msg)
+  {
+    std::lock_guard<std::mutex> lock(config_cache_mutex_);
+    config_cache_.clear();
+    config_cache_generation_++;
+  }
+
   ~RobotManagerInterface()
   {
+    stopAsyncCalls();
+    goal_watchdog_timer_.shutdown();
+    goal_status_sub_.shutdown();
+
+    // Nobody will resolve the pending goals anymore
+    std::vector<RobotGoalStatus> abandoned_goals;
+    {
+      std::lock_guard<std::mutex> lock(pending_goals_mutex_);
+      for (const auto& pending_goal : pending_goals_)
+      {
+        abandoned_goals.push_back(failedStatus(pending_goal.first, "The interface was destroyed"));
+      }
+    }
+    for (const auto& status : abandoned_goals)
+    {
+      resolveGoal(status);
+    }
+
     // Shutdown robot manager clients.
     client_load_.shutdown();
     client_plan_.shutdown();
+    client_plan_batch_.shutdown();
     client_exec_.shutdown();
     client_viz_info_.shutdown();
     client_set_manipulation_target_.shutdown();
     client_get_manipulation_target_.shutdown();
     client_navigation_goal_.shutdown();
     client_gripper_control_position_.shutdown();
+    client_navigation_goal_async_.shutdown();
+    client_exec_async_.shutdown();
+    client_cancel_goal_.shutdown();
+    client_get_goal_status_.shutdown();
+    client_navigation_route_.shutdown();
+    config_sync_sub_.shutdown();
+    client_get_robot_config_.shutdown();
+    client_get_robot_configs_.shutdown();
 
     TEMOTO_DEBUG_("RobotManagerInterface destroyed.");
   }
 
 private:
 
+  template <typename Result>
+  std::future<Result> runAsync(std::function<Result()> call)
+  {
+    auto task = std::make_shared<std::packaged_task<Result()>>(call);
+    std::future<Result> result = task->get_future();
+    {
+      std::lock_guard<std::mutex> lock(async_calls_mutex_);
+      if (async_calls_stopped_)
+      {
+        throw TEMOTO_ERRSTACK("The interface is being destroyed");
+      }
+      async_calls_.push_back([task]{ (*task)(); });
+
+      // A worker is added only if the idle ones cannot take the call
+      if (async_calls_.size() > idle_async_workers_ && async_workers_.size() < MAX_ASYNC_CALLS)
+      {
+        async_workers_.emplace_back(&RobotManagerInterface::asyncWorker, this);
+      }
+    }
+    async_calls_cv_.notify_one();
+    return result;
+  }
+
+  void asyncWorker()
+  {
+    std::unique_lock<std::mutex> lock(async_calls_mutex_);
+    while (true)
+    {
+      idle_async_workers_++;
+      async_calls_cv_.wait(lock, [this]{ return async_calls_stopped_ || !async_calls_.empty(); });
+      idle_async_workers_--;
+      if (async_calls_stopped_)
+      {
+        return;
+      }
+
+      std::function<void()> call = std::move(async_calls_.front());
+      async_calls_.pop_front();
+      lock.unlock();
+      call();
+      lock.lock();
+    }
+  }
+
+  // Drops the calls which have not started and waits for the running ones
+  void stopAsyncCalls()
+  {
+    std::deque<std::function<void()>> dropped_calls;
+    std::vector<std::thread> async_workers;
+    {
+      std::lock_guard<std::mutex> lock(async_calls_mutex_);
+      async_calls_stopped_ = true;
+      dropped_calls.swap(async_calls_);
+      async_workers.swap(async_workers_);
+    }
+    async_calls_cv_.notify_all();
+    dropped_calls.clear();
+
+    for (auto& async_worker : async_workers)
+    {
+      async_worker.join();
+    }
+  }
+
+  std::string createGoalId()
+  {
+    std::lock_guard<std::mutex> lock(pending_goals_mutex_);
+    return rr_name_ + "/goal_" + std::to_string(goal_count_++);
+  }
+
+  // The goal is registered before it is sent, so that the final status cannot be missed
+  std::shared_future<RobotGoalStatus> registerGoal(const std::string& goal_id
+  , GoalFeedbackCb feedback_cb = GoalFeedbackCb())
+  {
+    std::lock_guard<std::mutex> lock(pending_goals_mutex_);
+    PendingGoal& pending_goal = pending_goals_[goal_id];
+    pending_goal.feedback_cb = feedback_cb;
+    pending_goal.last_update = ros::WallTime::now();
+    if (goal_timeout_ > 0.0)
+    {
+      pending_goal.deadline = pending_goal.last_update + ros::WallDuration(goal_timeout_);
+    }
+    return pending_goal.result.get_future().share();
+  }
+
+  void unregisterGoal(const std::string& goal_id)
+  {
+    std::lock_guard<std::mutex> lock(pending_goals_mutex_);
+    pending_goals_.erase(goal_id);
+  }
+
+  // The status of a goal is queried only after the robot manager has accepted it
+  void acceptGoal(const std::string& goal_id)
+  {
+    std::lock_guard<std::mutex> lock(pending_goals_mutex_);
+    auto goal_it = pending_goals_.find(goal_id);
+    if (goal_it != pending_goals_.end())
+    {
+      goal_it->second.accepted = true;
+    }
+  }
+
+  // Sets the result of the goal and forgets it. Only the first final status is used
+  void resolveGoal(const RobotGoalStatus& status)
+  {
+    std::lock_guard<std::mutex> lock(pending_goals_mutex_);
+    auto goal_it = pending_goals_.find(status.goal_id);
+    if (goal_it == pending_goals_.end())
+    {
+      return;
+    }
+    goal_it->second.result.set_value(status);
+    pending_goals_.erase(goal_it);
+  }
+
+  static bool isFinalStatus(uint8_t status)
+  {
+    return status != RobotGoalStatus::PENDING && status != RobotGoalStatus::ACTIVE;
+  }
+
+  static RobotGoalStatus failedStatus(const std::string& goal_id, const std::string& message)
+  {
+    RobotGoalStatus status;
+    status.goal_id = goal_id;
+    status.status = RobotGoalStatus::FAILED;
+    status.message = message;
+    status.waypoint_index = -1;
+    return status;
+  }
+
+  /**
+   * Status messages can be lost, or published before the subscription connected. Goals
+   * which have not been heard from for a while are resolved from the goal status service
+   */
+  void goalWatchdogCb(const ros::WallTimerEvent& event)
+  {
+    std::vector<std::string> expired_goals;
+    std::vector<std::string> silent_goals;
+    ros::WallTime now = ros::WallTime::now();
+    {
+      std::lock_guard<std::mutex> lock(pending_goals_mutex_);
+      for (const auto& pending_goal : pending_goals_)
+      {
+        if (!pending_goal.second.accepted)
+        {
+          continue;
+        }
+
+        if (!pending_goal.second.deadline.isZero() && now > pending_goal.second.deadline)
+        {
+          expired_goals.push_back(pending_goal.first);
+        }
+        else if ((now - pending_goal.second.last_update).toSec() > GOAL_STATUS_TIMEOUT)
+        {
+          silent_goals.push_back(pending_goal.first);
+        }
+      }
+    }
+
+    for (const auto& goal_id : expired_goals)
+    {
+      RobotCancelGoal cancel_msg;
+      cancel_msg.request.goal_id = goal_id;
+      client_cancel_goal_.call(cancel_msg);
+      resolveGoal(failedStatus(goal_id, "The goal timed out"));
+    }
+
+    for (const auto& goal_id : silent_goals)
+    {
+      RobotGetGoalStatus status_msg;
+      status_msg.request.goal_id = goal_id;
+      if (!client_get_goal_status_.call(status_msg))
+      {
+        resolveGoal(failedStatus(goal_id, "Unable to reach robot_manager for the status of the goal"));
+      }
+      else if (!status_msg.response.found)
+      {
+        resolveGoal(failedStatus(goal_id, "The robot manager does not know the goal"));
+      }
+      else if (isFinalStatus(status_msg.response.status.status))
+      {
+        resolveGoal(status_msg.response.status);
+      }
+      else
+      {
+        std::lock_guard<std::mutex> lock(pending_goals_mutex_);
+        auto goal_it = pending_goals_.find(goal_id);
+        if (goal_it != pending_goals_.end())
+        {
+          goal_it->second.last_update = now;
+        }
+      }
+    }
+  }
+
+  // Returns a copy, so that the caller cannot modify the cached config
+  bool findCachedConfig(const std::string& robot_name, YAML::Node& config)
+  {
+    std::lock_guard<std::mutex> lock(config_cache_mutex_);
+    auto config_it = config_cache_.find(robot_name);
+    if (config_it == config_cache_.end())
+    {
+      return false;
+    }
+    config = YAML::Clone(config_it->second);
+    return true;
+  }
+
+  unsigned int getCacheGeneration()
+  {
+    std::lock_guard<std::mutex> lock(config_cache_mutex_);
+    return config_cache_generation_;
+  }
+
+  /**
+   * @brief Caches the config, unless the cache was invalidated while the config was requested
+   * @param cache_generation Generation of the cache before the config was requested
+   */
+  void cacheConfig(const std::string& robot_name, const YAML::Node& config, unsigned int cache_generation)
+  {
+    std::lock_guard<std::mutex> lock(config_cache_mutex_);
+    if (cache_generation == config_cache_generation_)
+    {
+      config_cache_[robot_name] = YAML::Clone(config);
+    }
+  }
+
   std::string rr_name_;
   std::string unique_suffix_;
   bool initialized_;
   std::vector<RobotLoad> allocated_robots_;
+  std::mutex allocated_robots_mutex_;
 
   ros::NodeHandle nh_;
   ros::ServiceClient client_load_;
   ros::ServiceClient client_plan_;
+  ros::ServiceClient client_plan_batch_;
   ros::ServiceClient client_exec_;
   ros::ServiceClient client_viz_info_;
   ros::ServiceClient client_set_manipulation_target_;  
@@ -357,6 +1064,44 @@ private:
   ros::ServiceClient client_navigation_goal_;
   ros::ServiceClient client_gripper_control_position_;
   ros::ServiceClient client_get_robot_config_; 
+  ros::ServiceClient client_get_robot_configs_;
+  ros::ServiceClient client_navigation_goal_async_;
+  ros::ServiceClient client_exec_async_;
+  ros::ServiceClient client_cancel_goal_;
+  ros::ServiceClient client_get_goal_status_;
+  ros::ServiceClient client_navigation_route_;
+  ros::Subscriber goal_status_sub_;
+  ros::Subscriber config_sync_sub_;
+  ros::WallTimer goal_watchdog_timer_;
+
+  struct PendingGoal
+  {
+    std::promise<RobotGoalStatus> result;
+    GoalFeedbackCb feedback_cb;
+    bool accepted = false;
+    ros::WallTime last_update;
+    ros::WallTime deadline;
+  };
+  std::map<std::string, PendingGoal> pending_goals_;
+  std::mutex pending_goals_mutex_;
+  unsigned int goal_count_ = 0;
+  double goal_timeout_ = 0.0;
+
+  // Time (s) without status messages after which the status of a goal is queried
+  static constexpr double GOAL_STATUS_TIMEOUT = 5.0;
+
+  std::map<std::string, YAML::Node> config_cache_;
+  unsigned int config_cache_generation_ = 0;
+  std::mutex config_cache_mutex_;
+
+  // Calls of the non-blocking variants
+  static constexpr unsigned int MAX_ASYNC_CALLS = 8;
+  std::deque<std::function<void()>> async_calls_;
+  std::vector<std::thread> async_workers_;
+  unsigned int idle_async_workers_ = 0;
+  bool async_calls_stopped_ = false;
+  std::mutex async_calls_mutex_;
+  std::condition_variable async_calls_cv_;
 
   std::unique_ptr<temoto_resource_registrar::ResourceRegistrarRos1> resource_registrar_;
 };
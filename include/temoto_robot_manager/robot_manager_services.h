@@ -27,6 +27,17 @@
 #include "temoto_robot_manager/RobotNavigationGoal.h"
 #include "temoto_robot_manager/RobotGripperControlPosition.h"
 #include "temoto_robot_manager/RobotGetConfig.h"
+#include "temoto_robot_manager/RobotGetConfigs.h"
+#include "temoto_robot_manager/RobotNavigationGoalAsync.h"
+#include "temoto_robot_manager/RobotExecutePlanAsync.h"
+#include "temoto_robot_manager/RobotCancelGoal.h"
+#include "temoto_robot_manager/RobotGetGoalStatus.h"
+#include "temoto_robot_manager/RobotNavigationRoute.h"
+#include "temoto_robot_manager/RobotPlanManipulationBatch.h"
+#include "temoto_robot_manager/RobotGetMetrics.h"
+#include "temoto_robot_manager/RobotGoalStatus.h"
+#include "temoto_robot_manager/HostStatus.h"
+#include "temoto_robot_manager/RobotStatusArray.h"
 
 #include <string>
 
@@ -36,17 +47,41 @@ namespace srv_name
 {
 const std::string MANAGER = "robot_manager";
 const std::string SYNC_TOPIC = "/temoto_robot_manager/" + MANAGER + "/sync";
+const std::string HOST_STATUS_TOPIC = "/temoto_robot_manager/" + MANAGER + "/host_status";
+const std::string ROBOT_STATUS_TOPIC = "/temoto_robot_manager/" + MANAGER + "/robot_status";
 
 const std::string SERVER_LOAD = "load";
 const std::string SERVER_PLAN = "plan";
+const std::string SERVER_PLAN_BATCH = "plan_batch";
 const std::string SERVER_EXECUTE = "execute";
 const std::string SERVER_GET_VIZ_INFO = "get_visualization_info";
 const std::string SERVER_GET_CONFIG = "get_config";
+const std::string SERVER_GET_CONFIGS = "get_configs";
 const std::string SERVER_SET_MANIPULATION_TARGET = "set_manipulation_target";
 const std::string SERVER_GET_MANIPULATION_TARGET = "get_manipulation_target";
 const std::string SERVER_NAVIGATION_GOAL = "navigation_goal";
 const std::string SERVER_SET_MODE = "set_mode";
 const std::string SERVER_GRIPPER_CONTROL_POSITION = "gripper_control_position";
+const std::string SERVER_NAVIGATION_GOAL_ASYNC = "navigation_goal_async";
+const std::string SERVER_EXECUTE_ASYNC = "execute_async";
+const std::string SERVER_CANCEL_GOAL = "cancel_goal";
+const std::string SERVER_GET_GOAL_STATUS = "get_goal_status";
+const std::string SERVER_NAVIGATION_ROUTE = "navigation_route";
+const std::string SERVER_GET_METRICS = "get_metrics";
+const std::string GOAL_STATUS_TOPIC = "goal_status";
+const std::string METRICS_TOPIC = "metrics";
+
+// Latched visualization info (std_msgs/String) in the namespace of a robot, published on changes
+const std::string VIZ_INFO_TOPIC = "visualization_info";
+
+// Gripper setpoints (std_msgs/Float32) in the namespace of a robot. Only the latest one is executed
+const std::string GRIPPER_POSITION_TOPIC = "gripper_position";
+}
+
+namespace goal_type
+{
+const std::string NAVIGATION = "navigation";
+const std::string MANIPULATION = "manipulation";
 }
 
 namespace modes
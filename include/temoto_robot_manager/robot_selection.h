@@ -0,0 +1,59 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TEMOTO_ROBOT_MANAGER__ROBOT_SELECTION_H
+#define TEMOTO_ROBOT_MANAGER__ROBOT_SELECTION_H
+
+namespace temoto_robot_manager
+{
+
+/**
+ * @brief Load of a host as seen by the robot selection
+ */
+struct HostLoad
+{
+  // False if no recent host status has been received from the host
+  bool known = false;
+
+  // Load average per core
+  double cpu_load = 0.0;
+
+  // Loaded and pending robots reported by the host
+  unsigned int robots = 0;
+
+  // Loads forwarded to the host which its last host status does not reflect yet
+  unsigned int forwarded_loads = 0;
+};
+
+/**
+ * @brief Cost of a host, its CPU load plus a fixed cost per robot. A host with unknown load
+ * gets a fixed cost, the forwarded loads count as robots in either case
+ */
+double getHostCost(const HostLoad& host_load);
+
+/**
+ * @brief Score of a config, its reliability / (1 + host cost)
+ */
+double getSelectionScore(double reliability, double host_cost);
+
+/**
+ * @brief A remote config has to score noticeably better than the local one to be chosen
+ */
+bool isLocalPreferred(double local_score, double remote_score);
+
+} // namespace temoto_robot_manager
+
+#endif
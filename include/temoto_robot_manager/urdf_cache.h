@@ -0,0 +1,88 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TEMOTO_ROBOT_MANAGER__URDF_CACHE_H
+#define TEMOTO_ROBOT_MANAGER__URDF_CACHE_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace temoto_robot_manager
+{
+
+/**
+ * @brief Expands xacro files into URDF and caches the results in memory and on disk.
+ * An entry is valid as long as the xacro arguments, the content of the file and of all
+ * files it includes and the environment variables they refer to are unchanged, hence robots
+ * with the same model share one expansion, also across restarts. Plain URDF files are read
+ * as they are.
+ */
+class UrdfCache
+{
+public:
+  /**
+   * @param cache_dir The expansions are not persisted if empty
+   * @param xacro_command Command which runs xacro
+   */
+  UrdfCache(const std::string& cache_dir = ""
+  , const std::string& xacro_command = "rosrun xacro xacro");
+
+  /**
+   * @brief Returns the URDF of the file, expanding it if it is a xacro file
+   * @param xacro_args Arguments of the expansion, "name:=value" separated by whitespace
+   * @return false if the file could not be read or expanded
+   */
+  bool getRobotDescription(const std::string& file_path
+  , const std::string& xacro_args
+  , std::string& robot_description);
+
+private:
+  struct Entry
+  {
+    size_t content_hash = 0;
+    std::vector<std::string> dependencies;
+    std::string robot_description;
+    std::mutex entry_mutex;
+  };
+
+  /*
+   * Hash of the arguments, of the contents of the file and of its dependencies and of the
+   * environment variables they refer to, 0 if a file is missing
+   */
+  size_t getContentHash(const std::string& file_path
+  , const std::string& xacro_args
+  , const std::vector<std::string>& dependencies) const;
+
+  bool expandXacro(const std::string& file_path, const std::string& xacro_args, Entry& entry) const;
+
+  std::string getCacheFilePath(const std::string& file_path, const std::string& xacro_args) const;
+
+  bool loadEntry(const std::string& file_path, const std::string& xacro_args, Entry& entry) const;
+
+  void saveEntry(const std::string& file_path, const std::string& xacro_args, const Entry& entry) const;
+
+  std::string cache_dir_;
+  std::string xacro_command_;
+  std::map<std::string, std::shared_ptr<Entry>> entries_;
+  std::mutex entries_mutex_;
+};
+
+} // namespace temoto_robot_manager
+
+#endif
@@ -0,0 +1,47 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "temoto_robot_manager/cache_dir.h"
+#include <boost/filesystem/operations.hpp>
+#include <cstdlib>
+
+namespace temoto_robot_manager
+{
+
+std::string getTemotoCacheDir(const std::string& sub_dir)
+{
+  const char* home_path = std::getenv("HOME");
+  if (!home_path || std::string(home_path).empty())
+  {
+    return "";
+  }
+
+  std::string cache_dir = std::string(home_path) + "/.temoto";
+  if (!sub_dir.empty())
+  {
+    cache_dir += "/" + sub_dir;
+  }
+
+  boost::system::error_code error_code;
+  boost::filesystem::create_directories(cache_dir, error_code);
+  if (error_code)
+  {
+    return "";
+  }
+  return cache_dir;
+}
+
+} // namespace temoto_robot_manager
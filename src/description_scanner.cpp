@@ -0,0 +1,407 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "temoto_robot_manager/description_scanner.h"
+#include "temoto_core/common/temoto_log_macros.h"
+#include <boost/filesystem/operations.hpp>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace temoto_robot_manager
+{
+namespace
+{
+const std::string DESCRIPTION_FILE_NAME = "robot_description.yaml";
+const std::string CACHE_FILE_MAGIC = "temoto_description_scan_1";
+
+/*
+ * Modification times have a resolution of a second. A directory which was modified in
+ * the same second as it was scanned may change again unnoticed, hence it is not cached
+ */
+const std::time_t MTIME_SETTLE_TIME = 2;
+} // namespace
+
+DescriptionScanner::DescriptionScanner(const std::string& base_path
+, const std::string& cache_file_path
+, unsigned int thread_count)
+: base_path_(base_path)
+, cache_file_path_(cache_file_path)
+, thread_count_(thread_count ? thread_count : std::max(1u, std::thread::hardware_concurrency()))
+{
+  while (base_path_.size() > 1 && base_path_.back() == '/')
+  {
+    base_path_.pop_back();
+  }
+}
+
+DescriptionScanner::~DescriptionScanner()
+{
+  stopWatching();
+}
+
+std::string DescriptionScanner::makeCacheFileName(const std::string& temoto_namespace, const std::string& base_path)
+{
+  // FNV-1a, which unlike std::hash is the same across builds
+  uint64_t path_hash = 14695981039346656037ull;
+  for (unsigned char c : base_path)
+  {
+    path_hash = (path_hash ^ c) * 1099511628211ull;
+  }
+
+  std::string namespace_name = temoto_namespace;
+  std::replace_if(namespace_name.begin(), namespace_name.end(), [](unsigned char c)
+  {
+    return !std::isalnum(c) && c != '_' && c != '-';
+  }, '_');
+
+  std::stringstream file_name;
+  file_name << namespace_name << "_" << std::hex << std::setw(16) << std::setfill('0') << path_hash
+            << "_descriptions.cache";
+  return file_name.str();
+}
+
+std::vector<std::string> DescriptionScanner::scan()
+{
+  std::lock_guard<std::mutex> directories_lock(directories_mutex_);
+  loadCache();
+
+  std::unordered_map<std::string, Directory> scanned_dirs;
+  std::vector<std::string> description_files;
+  std::deque<std::string> pending_dirs{base_path_};
+  unsigned int busy_count = 0;
+  std::mutex scan_mutex;
+  std::condition_variable scan_cv;
+  std::time_t scan_time = std::time(nullptr);
+
+  // The workers take directories from the queue and queue their subdirectories
+  auto scan_worker = [&]
+  {
+    std::unique_lock<std::mutex> lock(scan_mutex);
+    while (true)
+    {
+      scan_cv.wait(lock, [&]{ return !pending_dirs.empty() || busy_count == 0; });
+      if (pending_dirs.empty())
+      {
+        return;
+      }
+
+      std::string path = pending_dirs.front();
+      pending_dirs.pop_front();
+      busy_count++;
+      lock.unlock();
+
+      Directory directory;
+      bool scanned = scanDirectory(path, directory, scan_time);
+
+      lock.lock();
+      busy_count--;
+      if (scanned)
+      {
+        for (const auto& subdir : directory.subdirs)
+        {
+          pending_dirs.push_back(path + "/" + subdir);
+        }
+        if (directory.has_description)
+        {
+          description_files.push_back(path + "/" + DESCRIPTION_FILE_NAME);
+        }
+        scanned_dirs[path] = std::move(directory);
+      }
+      scan_cv.notify_all();
+    }
+  };
+
+  std::vector<std::thread> scan_threads;
+  for (unsigned int i = 0; i < thread_count_; i++)
+  {
+    scan_threads.emplace_back(scan_worker);
+  }
+  for (auto& scan_thread : scan_threads)
+  {
+    scan_thread.join();
+  }
+
+  directories_.swap(scanned_dirs);
+  saveCache();
+
+  std::sort(description_files.begin(), description_files.end());
+  return description_files;
+}
+
+bool DescriptionScanner::scanDirectory(const std::string& path, Directory& directory, std::time_t scan_time) const
+{
+  boost::system::error_code error_code;
+  std::time_t mtime = boost::filesystem::last_write_time(path, error_code);
+  if (error_code)
+  {
+    return false;
+  }
+
+  // directories_ holds the cache while scanning and is not modified until the scan is done
+  auto cached_it = directories_.find(path);
+  if (cached_it != directories_.end() && cached_it->second.mtime == mtime)
+  {
+    directory = cached_it->second;
+    return true;
+  }
+
+  boost::filesystem::directory_iterator dir_it(path, error_code);
+  if (error_code)
+  {
+    return false;
+  }
+
+  for (boost::filesystem::directory_iterator end_it; dir_it != end_it; dir_it.increment(error_code))
+  {
+    if (error_code)
+    {
+      break;
+    }
+
+    if (boost::filesystem::is_directory(dir_it->status()))
+    {
+      directory.subdirs.push_back(dir_it->path().filename().string());
+    }
+    else if (dir_it->path().filename() == DESCRIPTION_FILE_NAME && boost::filesystem::is_regular_file(dir_it->status()))
+    {
+      directory.has_description = true;
+    }
+  }
+
+  directory.mtime = (mtime + MTIME_SETTLE_TIME < scan_time) ? mtime : 0;
+  return true;
+}
+
+void DescriptionScanner::loadCache()
+{
+  directories_.clear();
+  if (cache_file_path_.empty())
+  {
+    return;
+  }
+
+  std::ifstream in(cache_file_path_);
+  std::string line;
+  if (!std::getline(in, line) || line != CACHE_FILE_MAGIC || !std::getline(in, line) || line != base_path_)
+  {
+    return;
+  }
+
+  /*
+   * Each directory is stored as a line "<mtime> <has_description> <subdir_count> <path>",
+   * followed by the names of its subdirectories, one per line
+   */
+  std::time_t mtime;
+  int has_description;
+  size_t subdir_count;
+  while (in >> mtime >> has_description >> subdir_count && in.get() == ' ' && std::getline(in, line))
+  {
+    Directory& directory = directories_[line];
+    directory.mtime = mtime;
+    directory.has_description = has_description;
+    directory.subdirs.resize(subdir_count);
+    for (auto& subdir : directory.subdirs)
+    {
+      if (!std::getline(in, subdir))
+      {
+        directories_.clear();
+        return;
+      }
+    }
+  }
+}
+
+void DescriptionScanner::saveCache() const
+{
+  if (cache_file_path_.empty())
+  {
+    return;
+  }
+
+  // A unique temporary file, so that concurrent writers cannot interleave
+  std::string tmp_file_path = cache_file_path_ + ".XXXXXX";
+  int tmp_fd = mkstemp(&tmp_file_path[0]);
+  if (tmp_fd < 0)
+  {
+    TEMOTO_WARN("Could not create a temporary file for the description scan cache '%s'", cache_file_path_.c_str());
+    return;
+  }
+  close(tmp_fd);
+
+  {
+    std::ofstream out(tmp_file_path, std::ios::trunc);
+    out << CACHE_FILE_MAGIC << "\n" << base_path_ << "\n";
+    for (const auto& path_directory : directories_)
+    {
+      const Directory& directory = path_directory.second;
+      out << directory.mtime << " " << directory.has_description << " " << directory.subdirs.size()
+          << " " << path_directory.first << "\n";
+      for (const auto& subdir : directory.subdirs)
+      {
+        out << subdir << "\n";
+      }
+    }
+
+    if (!out)
+    {
+      TEMOTO_WARN("Could not write the description scan cache to '%s'", tmp_file_path.c_str());
+      std::remove(tmp_file_path.c_str());
+      return;
+    }
+  }
+
+  if (std::rename(tmp_file_path.c_str(), cache_file_path_.c_str()) != 0)
+  {
+    std::remove(tmp_file_path.c_str());
+  }
+}
+
+bool DescriptionScanner::startWatching(const DescriptionChangedCb& description_changed_cb)
+{
+  if (watching_)
+  {
+    return true;
+  }
+
+  inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotify_fd_ < 0)
+  {
+    return false;
+  }
+
+  description_changed_cb_ = description_changed_cb;
+  {
+    std::lock_guard<std::mutex> directories_lock(directories_mutex_);
+    for (const auto& path_directory : directories_)
+    {
+      addWatch(path_directory.first);
+    }
+  }
+
+  watching_ = true;
+  watch_thread_ = std::thread(&DescriptionScanner::watchLoop, this);
+  return true;
+}
+
+void DescriptionScanner::stopWatching()
+{
+  if (!watching_)
+  {
+    return;
+  }
+
+  watching_ = false;
+  watch_thread_.join();
+  close(inotify_fd_);
+  inotify_fd_ = -1;
+  watched_dirs_.clear();
+}
+
+void DescriptionScanner::addWatch(const std::string& path)
+{
+  int watch_descriptor = inotify_add_watch(inotify_fd_
+  , path.c_str()
+  , IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+
+  if (watch_descriptor < 0)
+  {
+    TEMOTO_WARN("Could not watch '%s', consider raising fs.inotify.max_user_watches", path.c_str());
+    return;
+  }
+  watched_dirs_[watch_descriptor] = path;
+}
+
+void DescriptionScanner::addWatchedTree(const std::string& path)
+{
+  // New directories are rare, hence they are scanned without the worker threads
+  std::deque<std::string> pending_dirs{path};
+  while (!pending_dirs.empty())
+  {
+    std::string dir_path = pending_dirs.front();
+    pending_dirs.pop_front();
+
+    Directory directory;
+    {
+      std::lock_guard<std::mutex> directories_lock(directories_mutex_);
+      if (!scanDirectory(dir_path, directory, std::time(nullptr)))
+      {
+        continue;
+      }
+      directories_[dir_path] = directory;
+    }
+
+    addWatch(dir_path);
+    for (const auto& subdir : directory.subdirs)
+    {
+      pending_dirs.push_back(dir_path + "/" + subdir);
+    }
+    if (directory.has_description)
+    {
+      description_changed_cb_(dir_path + "/" + DESCRIPTION_FILE_NAME);
+    }
+  }
+}
+
+void DescriptionScanner::watchLoop()
+{
+  alignas(struct inotify_event) char buffer[16 * 1024];
+  pollfd poll_fd{inotify_fd_, POLLIN, 0};
+
+  while (watching_)
+  {
+    // The timeout bounds the time it takes to stop watching
+    if (poll(&poll_fd, 1, 500) <= 0)
+    {
+      continue;
+    }
+
+    ssize_t length = read(inotify_fd_, buffer, sizeof(buffer));
+    for (ssize_t offset = 0; offset < length;)
+    {
+      const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(buffer + offset);
+      offset += sizeof(struct inotify_event) + event->len;
+
+      auto watched_dir_it = watched_dirs_.find(event->wd);
+      if (watched_dir_it == watched_dirs_.end() || event->len == 0)
+      {
+        continue;
+      }
+
+      std::string path = watched_dir_it->second + "/" + event->name;
+      if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO)))
+      {
+        addWatchedTree(path);
+      }
+      else if (DESCRIPTION_FILE_NAME == event->name && (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)))
+      {
+        description_changed_cb_(path);
+      }
+    }
+  }
+}
+
+} // namespace temoto_robot_manager
@@ -0,0 +1,154 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "temoto_robot_manager/metrics.h"
+#include <algorithm>
+#include <exception>
+
+namespace temoto_robot_manager
+{
+namespace
+{
+// Upper bounds of the histogram buckets [s], 1 ms to 100 s
+const std::vector<double> BUCKET_BOUNDS{0.001, 0.002, 0.005
+, 0.01, 0.02, 0.05
+, 0.1, 0.2, 0.5
+, 1.0, 2.0, 5.0
+, 10.0, 20.0, 50.0
+, 100.0};
+} // namespace
+
+Metrics::Metrics(bool enabled)
+: enabled_(enabled)
+{}
+
+void Metrics::setEnabled(bool enabled)
+{
+  enabled_ = enabled;
+}
+
+void Metrics::record(const std::string& subject, const std::string& operation, double duration, bool success)
+{
+  size_t bucket = std::lower_bound(BUCKET_BOUNDS.begin(), BUCKET_BOUNDS.end(), duration) - BUCKET_BOUNDS.begin();
+
+  std::lock_guard<std::mutex> lock(histograms_mutex_);
+  Histogram& histogram = histograms_[std::make_pair(subject, operation)];
+  if (histogram.count == 0)
+  {
+    histogram.bucket_counts.assign(BUCKET_BOUNDS.size() + 1, 0);
+    histogram.min = duration;
+    histogram.max = duration;
+    histogram.first_recorded = std::chrono::steady_clock::now();
+  }
+
+  histogram.bucket_counts[bucket]++;
+  histogram.count++;
+  histogram.failures += success ? 0 : 1;
+  histogram.sum += duration;
+  histogram.min = std::min(histogram.min, duration);
+  histogram.max = std::max(histogram.max, duration);
+}
+
+double Metrics::getPercentile(const Histogram& histogram, double share) const
+{
+  uint64_t cumulative_count = 0;
+  for (size_t i = 0; i < BUCKET_BOUNDS.size(); i++)
+  {
+    cumulative_count += histogram.bucket_counts[i];
+    if (cumulative_count >= share * histogram.count)
+    {
+      return std::min(BUCKET_BOUNDS[i], histogram.max);
+    }
+  }
+  return histogram.max;
+}
+
+RobotManagerMetrics Metrics::getMetrics(const std::string& subject) const
+{
+  RobotManagerMetrics msg;
+  msg.enabled = isEnabled();
+  auto now = std::chrono::steady_clock::now();
+
+  std::lock_guard<std::mutex> lock(histograms_mutex_);
+  for (const auto& histogram_entry : histograms_)
+  {
+    if (!subject.empty() && histogram_entry.first.first != subject)
+    {
+      continue;
+    }
+
+    const Histogram& histogram = histogram_entry.second;
+    OperationMetrics operation;
+    operation.subject = histogram_entry.first.first;
+    operation.operation = histogram_entry.first.second;
+    operation.count = histogram.count;
+    operation.failures = histogram.failures;
+    operation.min = histogram.min;
+    operation.max = histogram.max;
+    operation.mean = histogram.sum / histogram.count;
+    operation.p50 = getPercentile(histogram, 0.5);
+    operation.p90 = getPercentile(histogram, 0.9);
+    operation.p99 = getPercentile(histogram, 0.99);
+    operation.bucket_bounds = BUCKET_BOUNDS;
+    operation.bucket_counts = histogram.bucket_counts;
+
+    double elapsed = std::chrono::duration<double>(now - histogram.first_recorded).count();
+    operation.rate = (elapsed > 0.0) ? histogram.count / elapsed : 0.0;
+    msg.operations.push_back(operation);
+  }
+  return msg;
+}
+
+void Metrics::reset()
+{
+  std::lock_guard<std::mutex> lock(histograms_mutex_);
+  histograms_.clear();
+}
+
+ScopedSpan::ScopedSpan(Metrics& metrics
+, const std::string& subject
+, const char* operation
+, const std::string& detail)
+: metrics_(metrics)
+, active_(metrics.isEnabled())
+{
+  if (!active_)
+  {
+    return;
+  }
+
+  subject_ = subject;
+  operation_ = operation;
+  if (!detail.empty())
+  {
+    operation_ += "/" + detail;
+  }
+  start_time_ = std::chrono::steady_clock::now();
+}
+
+ScopedSpan::~ScopedSpan()
+{
+  if (!active_)
+  {
+    return;
+  }
+
+  double duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+  metrics_.record(subject_, operation_, duration, !failed_ && !std::uncaught_exception());
+}
+
+} // namespace temoto_robot_manager
@@ -0,0 +1,302 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "temoto_robot_manager/plan_cache.h"
+#include <ros/serialization.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace temoto_robot_manager
+{
+namespace
+{
+const std::string CACHE_FILE_MAGIC = "temoto_plan_cache_1";
+
+void writeBlock(std::ostream& out, const std::string& block)
+{
+  uint32_t length = block.size();
+  out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+  out.write(block.data(), length);
+}
+
+// The length is bounded by the rest of the file, so that a corrupt length is not allocated
+bool readBlock(std::istream& in, std::streamoff file_size, std::string& block)
+{
+  uint32_t length = 0;
+  if (!in.read(reinterpret_cast<char*>(&length), sizeof(length)))
+  {
+    return false;
+  }
+
+  std::streamoff position = in.tellg();
+  if (position < 0 || length > file_size - position)
+  {
+    return false;
+  }
+  block.resize(length);
+  return static_cast<bool>(in.read(&block[0], length));
+}
+} // namespace
+
+std::string PlanCache::makeCacheFileName(const std::string& temoto_namespace
+, const std::string& robot_name
+, const std::string& robot_model)
+{
+  // FNV-1a, which unlike std::hash is the same across builds
+  uint64_t model_hash = 14695981039346656037ull;
+  for (unsigned char c : robot_model)
+  {
+    model_hash = (model_hash ^ c) * 1099511628211ull;
+  }
+
+  std::string file_name_prefix = temoto_namespace + "_" + robot_name;
+  std::replace_if(file_name_prefix.begin(), file_name_prefix.end(), [](unsigned char c)
+  {
+    return !std::isalnum(c) && c != '_' && c != '-';
+  }, '_');
+
+  std::stringstream file_name;
+  file_name << file_name_prefix << "_" << std::hex << std::setw(16) << std::setfill('0') << model_hash << ".cache";
+  return file_name.str();
+}
+
+PlanCache::PlanCache(const PlanCacheConfig& config)
+: config_(config)
+{}
+
+long PlanCache::quantize(double value, double resolution) const
+{
+  return (resolution > 0.0) ? std::lround(value / resolution) : std::lround(value * 1e6);
+}
+
+std::string PlanCache::makeKey(const std::string& planning_group_name
+, const std::vector<std::string>& joint_names
+, const std::vector<double>& joint_positions
+, const std::string& goal_key) const
+{
+  std::stringstream key;
+  key << planning_group_name << "|";
+  for (unsigned int i = 0; i < joint_names.size() && i < joint_positions.size(); i++)
+  {
+    key << joint_names[i] << "=" << quantize(joint_positions[i], config_.joint_resolution) << ",";
+  }
+  key << "|" << goal_key;
+  return key.str();
+}
+
+std::string PlanCache::makeGoalKey(const std::string& named_target) const
+{
+  return "named:" + named_target;
+}
+
+std::string PlanCache::makeGoalKey(const geometry_msgs::Pose& pose) const
+{
+  // q and -q describe the same orientation
+  double sign = (pose.orientation.w < 0.0) ? -1.0 : 1.0;
+
+  std::stringstream key;
+  key << "pose:"
+      << quantize(pose.position.x, config_.position_resolution) << ","
+      << quantize(pose.position.y, config_.position_resolution) << ","
+      << quantize(pose.position.z, config_.position_resolution) << ","
+      << quantize(sign * pose.orientation.x, config_.orientation_resolution) << ","
+      << quantize(sign * pose.orientation.y, config_.orientation_resolution) << ","
+      << quantize(sign * pose.orientation.z, config_.orientation_resolution) << ","
+      << quantize(sign * pose.orientation.w, config_.orientation_resolution);
+  return key.str();
+}
+
+bool PlanCache::find(const std::string& key, moveit_msgs::RobotTrajectory& trajectory)
+{
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  auto index_it = entry_index_.find(key);
+  if (index_it == entry_index_.end())
+  {
+    stats_.misses++;
+    return false;
+  }
+
+  entries_.splice(entries_.begin(), entries_, index_it->second);
+  trajectory = index_it->second->second;
+  stats_.hits++;
+  return true;
+}
+
+void PlanCache::insert(const std::string& key, const moveit_msgs::RobotTrajectory& trajectory)
+{
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  auto index_it = entry_index_.find(key);
+  if (index_it != entry_index_.end())
+  {
+    index_it->second->second = trajectory;
+    entries_.splice(entries_.begin(), entries_, index_it->second);
+    return;
+  }
+
+  entries_.emplace_front(key, trajectory);
+  entry_index_[key] = entries_.begin();
+  evict();
+}
+
+void PlanCache::reject(const std::string& key)
+{
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  auto index_it = entry_index_.find(key);
+  if (index_it != entry_index_.end())
+  {
+    entries_.erase(index_it->second);
+    entry_index_.erase(index_it);
+  }
+  stats_.rejected++;
+}
+
+void PlanCache::evict()
+{
+  while (entries_.size() > config_.size)
+  {
+    entry_index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+}
+
+PlanCache::Stats PlanCache::getStats() const
+{
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  return stats_;
+}
+
+size_t PlanCache::size() const
+{
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  return entries_.size();
+}
+
+bool PlanCache::save(const std::string& file_path) const
+{
+  // The lookups are not blocked while the file is written
+  std::list<Entry> entries;
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    entries = entries_;
+  }
+
+  // A unique temporary file, so that concurrent writers cannot interleave
+  std::string tmp_file_path = file_path + ".XXXXXX";
+  int tmp_fd = mkstemp(&tmp_file_path[0]);
+  if (tmp_fd < 0)
+  {
+    return false;
+  }
+  close(tmp_fd);
+
+  {
+    std::ofstream out(tmp_file_path, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+      std::remove(tmp_file_path.c_str());
+      return false;
+    }
+
+    writeBlock(out, CACHE_FILE_MAGIC);
+    uint32_t entry_count = entries.size();
+    out.write(reinterpret_cast<const char*>(&entry_count), sizeof(entry_count));
+
+    // Least recently used first, so that loading restores the same order
+    for (auto entry_it = entries.rbegin(); entry_it != entries.rend(); ++entry_it)
+    {
+      uint32_t msg_length = ros::serialization::serializationLength(entry_it->second);
+      std::string msg_buffer(msg_length, '\0');
+      ros::serialization::OStream stream(reinterpret_cast<uint8_t*>(&msg_buffer[0]), msg_length);
+      ros::serialization::serialize(stream, entry_it->second);
+
+      writeBlock(out, entry_it->first);
+      writeBlock(out, msg_buffer);
+    }
+
+    if (!out)
+    {
+      std::remove(tmp_file_path.c_str());
+      return false;
+    }
+  }
+
+  if (std::rename(tmp_file_path.c_str(), file_path.c_str()) != 0)
+  {
+    std::remove(tmp_file_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool PlanCache::load(const std::string& file_path)
+try
+{
+  std::ifstream in(file_path, std::ios::binary | std::ios::ate);
+  std::streamoff file_size = in.tellg();
+  in.seekg(0);
+  std::string magic;
+  if (!in || !readBlock(in, file_size, magic) || magic != CACHE_FILE_MAGIC)
+  {
+    return false;
+  }
+
+  uint32_t entry_count = 0;
+  if (!in.read(reinterpret_cast<char*>(&entry_count), sizeof(entry_count)))
+  {
+    return false;
+  }
+
+  std::list<Entry> entries;
+  for (uint32_t i = 0; i < entry_count; i++)
+  {
+    std::string key;
+    std::string msg_buffer;
+    if (!readBlock(in, file_size, key) || !readBlock(in, file_size, msg_buffer))
+    {
+      return false;
+    }
+
+    moveit_msgs::RobotTrajectory trajectory;
+    ros::serialization::IStream stream(reinterpret_cast<uint8_t*>(&msg_buffer[0]), msg_buffer.size());
+    ros::serialization::deserialize(stream, trajectory);
+    entries.emplace_front(key, trajectory);
+  }
+
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  entries_.swap(entries);
+  entry_index_.clear();
+  for (auto entry_it = entries_.begin(); entry_it != entries_.end(); ++entry_it)
+  {
+    entry_index_[entry_it->first] = entry_it;
+  }
+  evict();
+  return true;
+}
+catch (const std::exception&)
+{
+  // A malformed cache only means a cold start
+  return false;
+}
+
+} // namespace temoto_robot_manager
@@ -0,0 +1,155 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "temoto_robot_manager/planner_race.h"
+#include "temoto_robot_manager/planning_utils.h"
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <thread>
+#include <vector>
+
+namespace temoto_robot_manager
+{
+namespace
+{
+struct Racer
+{
+  std::string planner_id;
+  planning_interface::PlanningContextPtr context;
+  planning_interface::MotionPlanResponse response;
+  bool solved = false;
+};
+} // namespace
+
+PlannerRace::PlannerRace(const InProcessPlannerPtr& planner, const PlannerRaceConfig& config)
+: config_(config)
+, planner_(planner)
+{}
+
+bool PlannerRace::plan(const planning_scene::PlanningSceneConstPtr& scene
+, moveit_msgs::MotionPlanRequest request
+, moveit::planning_interface::MoveGroupInterface::Plan& plan)
+{
+  std::lock_guard<std::mutex> race_lock(race_mutex_);
+  if (!planner_->isAvailable())
+  {
+    TEMOTO_ERROR("No planner was loaded for the planner race");
+    return false;
+  }
+
+  request.allowed_planning_time = config_.deadline;
+  request.num_planning_attempts = 1;
+
+  // Contexts are created one after another, each racer gets its own context
+  std::vector<Racer> racers;
+  for (const auto& planner_id : config_.planner_ids)
+  {
+    request.planner_id = planner_id;
+    for (unsigned int seed = 0; seed < config_.seeds; seed++)
+    {
+      Racer racer;
+      racer.planner_id = planner_id;
+      racer.context = planner_->createContext(scene, request);
+      if (!racer.context)
+      {
+        TEMOTO_WARN("Could not create a planning context for planner '%s'", planner_id.c_str());
+        break;
+      }
+      racers.push_back(racer);
+    }
+  }
+
+  if (racers.empty())
+  {
+    return false;
+  }
+
+  std::mutex result_mutex;
+  std::condition_variable result_cv;
+  unsigned int finished_count = 0;
+  int winner = -1;
+
+  auto start_time = std::chrono::steady_clock::now();
+  std::vector<std::thread> racer_threads;
+  for (unsigned int i = 0; i < racers.size(); i++)
+  {
+    racer_threads.emplace_back([&, i]
+    {
+      bool solved = racers[i].context->solve(racers[i].response) && racers[i].response.trajectory_;
+
+      std::lock_guard<std::mutex> lock(result_mutex);
+      racers[i].solved = solved;
+      finished_count++;
+      if (solved && winner < 0)
+      {
+        winner = i;
+      }
+      result_cv.notify_all();
+    });
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(result_mutex);
+    result_cv.wait_until(lock, start_time + std::chrono::duration<double>(config_.deadline), [&]
+    {
+      return finished_count == racers.size() || (config_.mode == race_mode::FIRST && winner >= 0);
+    });
+  }
+
+  for (auto& racer : racers)
+  {
+    racer.context->terminate();
+  }
+  for (auto& racer_thread : racer_threads)
+  {
+    racer_thread.join();
+  }
+
+  int best = winner;
+  if (config_.mode == race_mode::SHORTEST)
+  {
+    double shortest_length = std::numeric_limits<double>::max();
+    for (unsigned int i = 0; i < racers.size(); i++)
+    {
+      if (!racers[i].solved)
+      {
+        continue;
+      }
+
+      double length = getPathLength(*racers[i].response.trajectory_);
+      if (length < shortest_length)
+      {
+        shortest_length = length;
+        best = i;
+      }
+    }
+  }
+
+  if (best < 0)
+  {
+    return false;
+  }
+  TEMOTO_DEBUG("Planner '%s' won the race", racers[best].planner_id.c_str());
+
+  toExecutablePlan(*racers[best].response.trajectory_
+  , request
+  , std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count()
+  , plan);
+  return true;
+}
+
+} // namespace temoto_robot_manager
@@ -0,0 +1,68 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "temoto_robot_manager/planning_utils.h"
+#include <moveit/trajectory_processing/iterative_time_parameterization.h>
+#include <cmath>
+
+namespace temoto_robot_manager
+{
+
+double getPathLength(const robot_trajectory::RobotTrajectory& trajectory)
+{
+  double length = 0.0;
+  for (size_t i = 1; i < trajectory.getWayPointCount(); i++)
+  {
+    length += trajectory.getWayPoint(i - 1).distance(trajectory.getWayPoint(i));
+  }
+  return length;
+}
+
+double getPathLength(const trajectory_msgs::JointTrajectory& trajectory)
+{
+  double length = 0.0;
+  for (size_t i = 1; i < trajectory.points.size(); i++)
+  {
+    // Same metric as RobotState::distance, i.e., the sum of the joint distances
+    for (size_t j = 0; j < trajectory.points[i].positions.size() && j < trajectory.points[i - 1].positions.size(); j++)
+    {
+      length += std::fabs(trajectory.points[i].positions[j] - trajectory.points[i - 1].positions[j]);
+    }
+  }
+  return length;
+}
+
+double getDuration(const trajectory_msgs::JointTrajectory& trajectory)
+{
+  return trajectory.points.empty() ? 0.0 : trajectory.points.back().time_from_start.toSec();
+}
+
+void toExecutablePlan(robot_trajectory::RobotTrajectory& trajectory
+, const moveit_msgs::MotionPlanRequest& request
+, double planning_time
+, moveit::planning_interface::MoveGroupInterface::Plan& plan)
+{
+  trajectory_processing::IterativeParabolicTimeParameterization time_parameterization;
+  time_parameterization.computeTimeStamps(trajectory
+  , request.max_velocity_scaling_factor > 0.0 ? request.max_velocity_scaling_factor : 1.0
+  , request.max_acceleration_scaling_factor > 0.0 ? request.max_acceleration_scaling_factor : 1.0);
+
+  trajectory.getRobotTrajectoryMsg(plan.trajectory_);
+  plan.start_state_ = request.start_state;
+  plan.planning_time_ = planning_time;
+}
+
+} // namespace temoto_robot_manager
@@ -0,0 +1,249 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "temoto_robot_manager/readiness_monitor.h"
+#include <topic_tools/shape_shifter.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <vector>
+
+namespace temoto_robot_manager
+{
+ReadinessMonitor::ReadinessMonitor(double tick_rate)
+: tick_period_(1.0 / tick_rate)
+, running_(true)
+{
+  monitor_thread_ = std::thread(&ReadinessMonitor::monitorLoop, this);
+}
+
+ReadinessMonitor::~ReadinessMonitor()
+{
+  {
+    std::lock_guard<std::mutex> lock(pending_waits_mutex_);
+    running_ = false;
+  }
+  monitor_cv_.notify_all();
+  waiters_cv_.notify_all();
+  monitor_thread_.join();
+}
+
+bool ReadinessMonitor::waitForTopic(const std::string& topic
+, const ros::WallDuration& timeout
+, const std::function<bool()>& abort_condition)
+{
+  return wait(ResourceType::TOPIC, topic, timeout, abort_condition);
+}
+
+bool ReadinessMonitor::waitForParam(const std::string& param
+, const ros::WallDuration& timeout
+, const std::function<bool()>& abort_condition)
+{
+  return wait(ResourceType::PARAM, param, timeout, abort_condition);
+}
+
+bool ReadinessMonitor::waitForService(const std::string& service
+, const ros::WallDuration& timeout
+, const std::function<bool()>& abort_condition)
+{
+  return wait(ResourceType::SERVICE, service, timeout, abort_condition);
+}
+
+bool ReadinessMonitor::waitForTopicRate(const std::string& topic
+, double min_rate
+, const ros::WallDuration& timeout
+, const std::function<bool()>& abort_condition)
+{
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(timeout.toNSec());
+  if (!waitForTopic(topic, timeout, abort_condition))
+  {
+    return false;
+  }
+
+  /*
+   * Count the messages that arrived within the last measurement window
+   */
+  typedef std::chrono::steady_clock Clock;
+  const auto window = std::chrono::duration_cast<Clock::duration>(
+    std::chrono::duration<double>(std::max(1.0, 2.0 / min_rate)));
+  const size_t required_count = std::max<size_t>(2, std::ceil(min_rate * std::chrono::duration<double>(window).count()));
+
+  auto stamps = std::make_shared<std::deque<Clock::time_point>>();
+  auto stamps_mutex = std::make_shared<std::mutex>();
+
+  ros::NodeHandle nh;
+  ros::Subscriber sub = nh.subscribe<topic_tools::ShapeShifter>(topic
+  , 10
+  , boost::function<void(const topic_tools::ShapeShifter::ConstPtr&)>(
+    [stamps, stamps_mutex](const topic_tools::ShapeShifter::ConstPtr&)
+    {
+      std::lock_guard<std::mutex> lock(*stamps_mutex);
+      stamps->push_back(Clock::now());
+    }));
+
+  while (Clock::now() < deadline)
+  {
+    if (abort_condition && abort_condition())
+    {
+      return false;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(*stamps_mutex);
+      while (!stamps->empty() && stamps->front() < Clock::now() - window)
+      {
+        stamps->pop_front();
+      }
+      if (stamps->size() >= required_count)
+      {
+        return true;
+      }
+    }
+    tick_period_.sleep();
+  }
+  return false;
+}
+
+bool ReadinessMonitor::wait(ResourceType type
+, const std::string& name
+, const ros::WallDuration& timeout
+, const std::function<bool()>& abort_condition)
+{
+  auto pending_wait = std::make_shared<PendingWait>(PendingWait{type, name, false});
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(timeout.toNSec());
+
+  std::unique_lock<std::mutex> lock(pending_waits_mutex_);
+  pending_waits_.push_back(pending_wait);
+  monitor_cv_.notify_one();
+
+  /*
+   * The monitor notifies the waiters after every tick, hence the abort
+   * condition is also evaluated at the tick rate
+   */
+  while (!pending_wait->ready && running_)
+  {
+    if (abort_condition && abort_condition())
+    {
+      break;
+    }
+    if (waiters_cv_.wait_until(lock, deadline) == std::cv_status::timeout)
+    {
+      break;
+    }
+  }
+
+  pending_waits_.remove(pending_wait);
+  return pending_wait->ready;
+}
+
+void ReadinessMonitor::monitorLoop()
+{
+  while (true)
+  {
+    // Sleep until there is something to wait for
+    {
+      std::unique_lock<std::mutex> lock(pending_waits_mutex_);
+      monitor_cv_.wait(lock, [&]{ return !running_ || !pending_waits_.empty(); });
+      if (!running_)
+      {
+        return;
+      }
+    }
+
+    /*
+     * Take one snapshot of the master for all pending waits
+     */
+    std::unordered_set<std::string> topics;
+    ros::master::V_TopicInfo master_topics;
+    if (ros::master::getTopics(master_topics))
+    {
+      for (const auto& master_topic : master_topics)
+      {
+        topics.insert(master_topic.name);
+      }
+    }
+
+    std::vector<std::string> params;
+    std::unordered_set<std::string> services;
+    bool has_param_waits;
+    bool has_service_waits;
+    {
+      std::lock_guard<std::mutex> lock(pending_waits_mutex_);
+      has_param_waits = std::any_of(pending_waits_.begin(), pending_waits_.end()
+      , [](const std::shared_ptr<PendingWait>& w){ return w->type == ResourceType::PARAM; });
+      has_service_waits = std::any_of(pending_waits_.begin(), pending_waits_.end()
+      , [](const std::shared_ptr<PendingWait>& w){ return w->type == ResourceType::SERVICE; });
+    }
+    if (has_param_waits)
+    {
+      ros::param::getParamNames(params);
+      std::sort(params.begin(), params.end());
+    }
+    if (has_service_waits)
+    {
+      getMasterServices(services);
+    }
+
+    // Parameters with nested keys are also considered available
+    auto is_param_available = [&](const std::string& param)
+    {
+      auto it = std::lower_bound(params.begin(), params.end(), param);
+      return it != params.end() && (*it == param || it->compare(0, param.size() + 1, param + "/") == 0);
+    };
+
+    {
+      std::lock_guard<std::mutex> lock(pending_waits_mutex_);
+      for (auto& pending_wait : pending_waits_)
+      {
+        if (pending_wait->type == ResourceType::TOPIC)
+        {
+          pending_wait->ready = topics.count(pending_wait->name) != 0;
+        }
+        else if (pending_wait->type == ResourceType::SERVICE)
+        {
+          pending_wait->ready = services.count(pending_wait->name) != 0;
+        }
+        else
+        {
+          pending_wait->ready = is_param_available(pending_wait->name);
+        }
+      }
+    }
+    waiters_cv_.notify_all();
+
+    tick_period_.sleep();
+  }
+}
+
+bool ReadinessMonitor::getMasterServices(std::unordered_set<std::string>& services) const
+{
+  // getSystemState returns [publishers, subscribers, services] in a single call
+  XmlRpc::XmlRpcValue args, result, payload;
+  args[0] = ros::this_node::getName();
+  if (!ros::master::execute("getSystemState", args, result, payload, false))
+  {
+    return false;
+  }
+
+  XmlRpc::XmlRpcValue& master_services = payload[2];
+  for (int i = 0; i < master_services.size(); i++)
+  {
+    services.insert(static_cast<std::string>(master_services[i][0]));
+  }
+  return true;
+}
+} // namespace temoto_robot_manager
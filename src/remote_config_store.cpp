@@ -0,0 +1,191 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "temoto_robot_manager/remote_config_store.h"
+
+namespace temoto_robot_manager
+{
+
+RemoteConfigStore::RemoteConfigStore(double lease_duration)
+: lease_duration_(lease_duration)
+{}
+
+bool RemoteConfigStore::renewLease(const std::string& temoto_namespace)
+{
+  ros::WallTime now = ros::WallTime::now();
+  auto shard_it = shards_.find(temoto_namespace);
+  bool new_lease = shard_it == shards_.end() || isExpired(shard_it->second, now);
+  Shard& shard = shards_[temoto_namespace];
+  shard.leased = true;
+  shard.lease_expiry = now + lease_duration_;
+  return new_lease;
+}
+
+bool RemoteConfigStore::touch(const std::string& temoto_namespace)
+{
+  auto shard_it = shards_.find(temoto_namespace);
+  if (shard_it == shards_.end())
+  {
+    shards_.emplace(temoto_namespace, Shard());
+    return true;
+  }
+  if (!shard_it->second.leased)
+  {
+    return false;
+  }
+  return renewLease(temoto_namespace);
+}
+
+bool RemoteConfigStore::updateEpoch(const std::string& temoto_namespace, uint64_t epoch, size_t& erased_count)
+{
+  Shard& shard = shards_[temoto_namespace];
+  erased_count = 0;
+  if (shard.epoch_known && shard.epoch == epoch)
+  {
+    return false;
+  }
+
+  erased_count = eraseConfigs(temoto_namespace, shard);
+  shard.epoch_known = true;
+  shard.epoch = epoch;
+  return true;
+}
+
+bool RemoteConfigStore::insert(const RobotConfigPtr& config)
+{
+  shards_[config->getTemotoNamespace()].robot_names.insert(config->getName());
+  return configs_.insert(config);
+}
+
+bool RemoteConfigStore::getEpoch(const std::string& temoto_namespace, uint64_t& epoch) const
+{
+  auto shard_it = shards_.find(temoto_namespace);
+  if (shard_it == shards_.end() || !shard_it->second.epoch_known)
+  {
+    return false;
+  }
+  epoch = shard_it->second.epoch;
+  return true;
+}
+
+RobotConfigPtr RemoteConfigStore::find(const std::string& temoto_namespace, const std::string& robot_name) const
+{
+  return configs_.find(temoto_namespace, robot_name);
+}
+
+RobotConfigPtr RemoteConfigStore::findBest(const std::string& robot_name) const
+{
+  ros::WallTime now = ros::WallTime::now();
+  if (!robot_name.empty())
+  {
+    for (const auto& config : configs_.findAll(robot_name))
+    {
+      if (isAlive(config->getTemotoNamespace(), now))
+      {
+        return config;
+      }
+    }
+    return nullptr;
+  }
+
+  // If robot name is unspecified, pick the best one from all configs.
+  RobotConfigPtr best;
+  for (const auto& config : configs_.getConfigs())
+  {
+    if (isAlive(config->getTemotoNamespace(), now) &&
+        (!best || config->getReliability() > best->getReliability()))
+    {
+      best = config;
+    }
+  }
+  return best;
+}
+
+RobotConfigs RemoteConfigStore::findAll(const std::string& robot_name) const
+{
+  ros::WallTime now = ros::WallTime::now();
+  RobotConfigs configs;
+  for (const auto& config : configs_.findAll(robot_name))
+  {
+    if (isAlive(config->getTemotoNamespace(), now))
+    {
+      configs.push_back(config);
+    }
+  }
+  return configs;
+}
+
+void RemoteConfigStore::updateReliability(const std::string& robot_name)
+{
+  configs_.updateReliability(robot_name);
+}
+
+bool RemoteConfigStore::isAlive(const std::string& temoto_namespace) const
+{
+  return isAlive(temoto_namespace, ros::WallTime::now());
+}
+
+bool RemoteConfigStore::isAlive(const std::string& temoto_namespace, const ros::WallTime& now) const
+{
+  auto shard_it = shards_.find(temoto_namespace);
+  return shard_it != shards_.end() && !isExpired(shard_it->second, now);
+}
+
+bool RemoteConfigStore::isExpired(const Shard& shard, const ros::WallTime& now)
+{
+  return shard.leased && shard.lease_expiry < now;
+}
+
+std::vector<std::string> RemoteConfigStore::evictExpired()
+{
+  ros::WallTime now = ros::WallTime::now();
+  std::vector<std::string> evicted_namespaces;
+  for (auto shard_it = shards_.begin(); shard_it != shards_.end();)
+  {
+    if (!isExpired(shard_it->second, now))
+    {
+      ++shard_it;
+      continue;
+    }
+
+    eraseConfigs(shard_it->first, shard_it->second);
+    evicted_namespaces.push_back(shard_it->first);
+    shard_it = shards_.erase(shard_it);
+  }
+  return evicted_namespaces;
+}
+
+size_t RemoteConfigStore::eraseConfigs(const std::string& temoto_namespace, Shard& shard)
+{
+  size_t erased_count = 0;
+  for (const auto& robot_name : shard.robot_names)
+  {
+    RobotConfigPtr config = configs_.find(temoto_namespace, robot_name);
+    if (config && configs_.erase(config))
+    {
+      erased_count++;
+    }
+  }
+  shard.robot_names.clear();
+  return erased_count;
+}
+
+size_t RemoteConfigStore::size() const
+{
+  return configs_.size();
+}
+
+} // namespace temoto_robot_manager
@@ -16,28 +16,100 @@
 
 #include "temoto_robot_manager/robot.h"
 #include "temoto_core/temoto_error/temoto_error.h"
+#include "temoto_robot_manager/planning_utils.h"
+#include "temoto_robot_manager/cache_dir.h"
 #include "ros/package.h"
+#include <moveit/common_planning_interface_objects/common_objects.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_model_loader/robot_model_loader.h>
+#include <moveit/robot_state/conversions.h>
+#include <moveit_msgs/GetPlanningScene.h>
+#include <boost/filesystem/operations.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <thread>
 
 namespace temoto_robot_manager
 {
+namespace
+{
+std::string getErrorMessage(const temoto_core::error::ErrorStack& error_stack)
+{
+  return error_stack.empty() ? "Unknown error" : error_stack.front().message;
+}
+
+// Runs the function when the scope is left, after the locks which were taken later are released
+class ScopeExit
+{
+public:
+  ScopeExit(std::function<void()> on_exit)
+  : on_exit_(on_exit)
+  {}
+
+  ~ScopeExit()
+  {
+    on_exit_();
+  }
+
+private:
+  std::function<void()> on_exit_;
+};
+} // namespace
+
 Robot::Robot(RobotConfigPtr config
 , const std::string& resource_id
 , temoto_resource_registrar::ResourceRegistrarRos1& resource_registrar
+, ReadinessMonitor& readiness_monitor
+, UrdfCache& urdf_cache
+, Metrics& metrics
 , temoto_core::BaseSubsystem& b)
 : config_(config)
 , robot_resource_id_(resource_id)
 , resource_registrar_(resource_registrar)
-, is_plan_valid_(false)
+, readiness_monitor_(readiness_monitor)
+, urdf_cache_(urdf_cache)
+, metrics_(metrics)
+, plan_count_(0)
+, executing_group_(nullptr)
+, navigation_goal_done_(false)
+, navigation_waypoint_near_(false)
+, navigation_switch_radius_(0.0)
+, navigation_cancel_requested_(false)
 , robot_operational_(true)
 , state_in_error_(false)
 , robot_loaded_(false)
 , temoto_core::BaseSubsystem(b)
 {
   class_name_ = __func__;
+
+  // The features of remote configs are parsed only once a robot is created from them
+  config_->parseFeatures();
 }
 
 Robot::~Robot()
 {
+  gripper_position_sub_.shutdown();
+  if (gripper_stream_thread_.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> lock(gripper_setpoint_mutex_);
+      gripper_stream_stopped_ = true;
+      gripper_setpoint_cv_.notify_one();
+    }
+    gripper_stream_thread_.join();
+  }
+
+  stopRecoveries();
+
+  if (plan_cache_save_.valid())
+  {
+    plan_cache_save_.wait();
+  }
+
   if(isLocal())
   {
     // Unload features
@@ -103,6 +175,99 @@ Robot::~Robot()
   TEMOTO_DEBUG("Robot destructed");
 }
 
+void Robot::stopRecoveries()
+{
+  // Interrupt the recoveries which are still in progress
+  std::vector<Recovery> recoveries;
+  {
+    std::lock_guard<std::mutex> lock(recovery_mutex_);
+    recoveries.swap(recoveries_);
+  }
+  for (auto& recovery : recoveries)
+  {
+    *recovery.cancelled = true;
+  }
+  for (auto& recovery : recoveries)
+  {
+    recovery.result.wait();
+  }
+}
+
+void Robot::standby()
+{
+  in_standby_ = true;
+  setRobotOperational(false);
+  cancelNavigationGoal();
+  stopManipulation();
+
+  // The gripper setpoints are not followed in standby
+  gripper_position_sub_.shutdown();
+  {
+    std::lock_guard<std::mutex> lock(gripper_setpoint_mutex_);
+    gripper_setpoint_pending_ = false;
+  }
+
+  std::lock_guard<std::mutex> lock(plans_mutex_);
+  plans_.clear();
+  latest_plan_ids_.clear();
+  plan_order_.clear();
+}
+
+void Robot::resume()
+{
+  if (gripper_stream_thread_.joinable())
+  {
+    gripper_position_sub_ = nh_.subscribe(config_->getAbsRobotNamespace() + "/" + srv_name::GRIPPER_POSITION_TOPIC
+    , 1
+    , &Robot::gripperPositionCb
+    , this);
+  }
+  in_standby_ = false;
+  setRobotOperational(!isInError());
+}
+
+void Robot::interruptLoad()
+{
+  setInError(true);
+}
+
+std::string Robot::getStandbyResourceId(const RobotConfigPtr& config)
+{
+  return config->getTemotoNamespace() + "/" + srv_name::MANAGER + "/standby/" + config->getName();
+}
+
+void Robot::unloadResources()
+{
+  // The resources which are being unloaded are not recovered
+  robot_loaded_ = false;
+  stopRecoveries();
+
+  std::vector<temoto_er_manager::LoadExtResource> ext_resources;
+  {
+    std::lock_guard<std::mutex> lock(ext_resources_mutex_);
+    ext_resources.swap(ext_resources_);
+  }
+
+  // Controllers are unloaded before the drivers they depend on
+  for (auto ext_resource_it = ext_resources.rbegin(); ext_resource_it != ext_resources.rend(); ++ext_resource_it)
+  {
+    try
+    {
+      resource_registrar_.unload(temoto_er_manager::srv_name::MANAGER
+      , ext_resource_it->response.temoto_metadata.request_id);
+    }
+    catch (const resource_registrar::TemotoErrorStack& e)
+    {
+      TEMOTO_WARN("Could not unload '%s' of %s: %s", ext_resource_it->request.executable.c_str()
+      , config_->getName().c_str()
+      , e.what());
+    }
+    setResourceLoaded(*ext_resource_it, false);
+  }
+  updateVizInfo();
+  TEMOTO_DEBUG("Unloaded %lu resources of %s.", ext_resources.size(), config_->getName().c_str());
+}
+
 void Robot::load()
 {
   if (!isLocal())
@@ -118,97 +283,344 @@ void Robot::load()
                                                        "the configuration file.");
   }
 
-  // Load URDF
+  /*
+   * Load the features via a dependency graph, so that independent branches
+   * (e.g. navigation and gripper) are brought up concurrently
+   */
+  runLoadStages(getLoadStages());
+
+  robot_loaded_ = true;
+  updateVizInfo();
+}
+
+std::vector<Robot::LoadStage> Robot::getLoadStages()
+{
+  std::vector<LoadStage> stages;
+
   if (config_->getFeatureURDF().isEnabled())
   {
-    loadUrdf();
+    stages.push_back({load_stage::URDF
+    , config_->getFeatureURDF().getDependencies()
+    , std::bind(&Robot::loadUrdf, this)});
   }
 
-  /*
-   * Load manipulation
-   */ 
   if (config_->getFeatureManipulation().isDriverEnabled())
   {
-    loadManipulationDriver();
+    stages.push_back({load_stage::MANIPULATION_DRIVER
+    , config_->getFeatureManipulation().getDriverDependencies()
+    , std::bind(&Robot::loadManipulationDriver, this)});
   }
 
   if (config_->getFeatureManipulation().isEnabled())
   {
-    loadManipulationController();
+    stages.push_back({load_stage::MANIPULATION_CONTROLLER
+    , config_->getFeatureManipulation().getDependencies()
+    , std::bind(&Robot::loadManipulationController, this)});
   }
-  
-  /*
-   * Load navigation
-   */ 
+
   if (config_->getFeatureNavigation().isDriverEnabled())
   {
-    loadNavigationDriver();
+    stages.push_back({load_stage::NAVIGATION_DRIVER
+    , config_->getFeatureNavigation().getDriverDependencies()
+    , std::bind(&Robot::loadNavigationDriver, this)});
   }
 
   if (config_->getFeatureNavigation().isEnabled())
   {
-    loadNavigationController();
+    stages.push_back({load_stage::NAVIGATION_CONTROLLER
+    , config_->getFeatureNavigation().getDependencies()
+    , std::bind(&Robot::loadNavigationController, this)});
   }
 
-  /*
-   * Load gripper
-   */ 
   if (config_->getFeatureGripper().isDriverEnabled())
   {
-    loadGripperDriver();
-  }  
+    stages.push_back({load_stage::GRIPPER_DRIVER
+    , config_->getFeatureGripper().getDriverDependencies()
+    , std::bind(&Robot::loadGripperDriver, this)});
+  }
 
   if (config_->getFeatureGripper().isEnabled())
   {
-    loadGripperController();
+    stages.push_back({load_stage::GRIPPER_CONTROLLER
+    , config_->getFeatureGripper().getDependencies()
+    , std::bind(&Robot::loadGripperController, this)});
   }
 
-  robot_loaded_ = true;
+  return stages;
+}
+
+void Robot::runLoadStages(const std::vector<LoadStage>& stages)
+{
+  const std::vector<std::string> known_stages{load_stage::URDF
+  , load_stage::MANIPULATION_DRIVER
+  , load_stage::MANIPULATION_CONTROLLER
+  , load_stage::NAVIGATION_DRIVER
+  , load_stage::NAVIGATION_CONTROLLER
+  , load_stage::GRIPPER_DRIVER
+  , load_stage::GRIPPER_CONTROLLER};
+
+  /*
+   * Resolve the dependencies. Dependencies on features that are not enabled for
+   * this robot are ignored
+   */
+  std::map<std::string, std::vector<std::string>> dependencies;
+  for (const auto& stage : stages)
+  {
+    dependencies[stage.name];
+  }
+
+  for (const auto& stage : stages)
+  {
+    for (const auto& dependency : stage.dependencies)
+    {
+      if (std::find(known_stages.begin(), known_stages.end(), dependency) == known_stages.end())
+      {
+        throw CREATE_ERROR(temoto_core::error::Code::ROBOT_CONFIG_FAIL, "Stage '%s' depends on an unknown "
+          "stage '%s'.", stage.name.c_str(), dependency.c_str());
+      }
+      if (dependencies.find(dependency) != dependencies.end())
+      {
+        dependencies[stage.name].push_back(dependency);
+      }
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(load_stage_states_mutex_);
+    load_stage_states_.clear();
+    for (const auto& stage : stages)
+    {
+      load_stage_states_[stage.name] = LoadStageState::PENDING;
+    }
+  }
+
+  std::mutex scheduler_mutex;
+  std::condition_variable scheduler_cv;
+  std::exception_ptr first_error;
+  std::vector<std::thread> workers;
+  unsigned int running = 0;
+
+  auto get_state = [&](const std::string& name)
+  {
+    std::lock_guard<std::mutex> lock(load_stage_states_mutex_);
+    return load_stage_states_[name];
+  };
+
+  auto set_state = [&](const std::string& name, LoadStageState state)
+  {
+    std::lock_guard<std::mutex> lock(load_stage_states_mutex_);
+    load_stage_states_[name] = state;
+  };
+
+  std::unique_lock<std::mutex> scheduler_lock(scheduler_mutex);
+  while (true)
+  {
+    // Start all stages whose dependencies are ready
+    unsigned int pending = 0;
+    for (const auto& stage : stages)
+    {
+      if (get_state(stage.name) != LoadStageState::PENDING)
+      {
+        continue;
+      }
+      pending++;
+
+      if (first_error)
+      {
+        continue;
+      }
+
+      const auto& stage_dependencies = dependencies[stage.name];
+      bool dependencies_ready = std::all_of(stage_dependencies.begin()
+      , stage_dependencies.end()
+      , [&](const std::string& dependency)
+        {
+          return get_state(dependency) == LoadStageState::READY;
+        });
+
+      if (!dependencies_ready)
+      {
+        continue;
+      }
+
+      TEMOTO_DEBUG("Starting to load stage '%s'.", stage.name.c_str());
+      set_state(stage.name, LoadStageState::LOADING);
+      pending--;
+      running++;
+      workers.emplace_back([&, stage]
+      {
+        LoadStageState result = LoadStageState::READY;
+        std::exception_ptr error;
+        try
+        {
+          ScopedSpan span(metrics_, config_->getName(), "load", stage.name);
+          stage.load();
+        }
+        catch (...)
+        {
+          result = LoadStageState::FAILED;
+          error = std::current_exception();
+
+          // Interrupts the stages that are waiting for their resources
+          setInError(true);
+        }
+
+        set_state(stage.name, result);
+        std::lock_guard<std::mutex> lock(scheduler_mutex);
+        if (error && !first_error)
+        {
+          first_error = error;
+        }
+        running--;
+        scheduler_cv.notify_all();
+      });
+    }
+
+    if (running == 0 && (pending == 0 || first_error))
+    {
+      break;
+    }
+
+    if (running == 0 && pending != 0)
+    {
+      first_error = std::make_exception_ptr(CREATE_ERROR(temoto_core::error::Code::ROBOT_CONFIG_FAIL
+      , "The dependencies of the robot features contain a cycle."));
+      break;
+    }
+
+    // Wait until any of the running stages has finished
+    unsigned int running_before = running;
+    scheduler_cv.wait(scheduler_lock, [&]{ return running < running_before; });
+  }
+  scheduler_lock.unlock();
+
+  for (auto& worker : workers)
+  {
+    worker.join();
+  }
+
+  if (first_error)
+  {
+    std::rethrow_exception(first_error);
+  }
+}
+
+std::map<std::string, Robot::LoadStageState> Robot::getLoadStageStates() const
+{
+  std::lock_guard<std::mutex> lock(load_stage_states_mutex_);
+  return load_stage_states_;
 }
 
 void Robot::waitForParam(const std::string& param)
 {
-  //\TODO: add 30 sec timeout protection.
-  while (!nh_.hasParam(param))
+  ScopedSpan span(metrics_, config_->getName(), "wait_for_param");
+  TEMOTO_DEBUG("Waiting for %s ...", param.c_str());
+  if (!readiness_monitor_.waitForParam(param
+  , ros::WallDuration(config_->getLoadTimeout())
+  , [&]{ return isInError(); }))
   {
-    TEMOTO_DEBUG("Waiting for %s ...", param.c_str());
     if (isInError())
     {
       throw CREATE_ERROR(temoto_core::error::Code::SERVICE_STATUS_FAIL, "Loading interrupted. The robot is in a failed state.");
     }
-    ros::Duration(1).sleep();
+    throw CREATE_ERROR(temoto_core::error::Code::SERVICE_STATUS_FAIL, "Parameter '%s' did not appear within %.1f seconds."
+    , param.c_str(), config_->getLoadTimeout());
   }
   TEMOTO_DEBUG("Parameter '%s' was found.", param.c_str());
 }
 
 void Robot::waitForTopic(const std::string& topic)
 {
-  //\TODO: add 30 sec timeout protection.
-  while (!isTopicAvailable(topic))
+  waitForTopic(topic, [&]{ return isInError(); });
+}
+
+void Robot::waitForTopic(const std::string& topic, const std::function<bool()>& abort_condition)
+{
+  ScopedSpan span(metrics_, config_->getName(), "wait_for_topic");
+  TEMOTO_DEBUG("Waiting for %s ...", topic.c_str());
+  if (!readiness_monitor_.waitForTopic(topic
+  , ros::WallDuration(config_->getLoadTimeout())
+  , abort_condition))
   {
-    TEMOTO_DEBUG("Waiting for %s ...", topic.c_str());
-    if (isInError())
+    if (abort_condition())
     {
-      throw CREATE_ERROR(temoto_core::error::Code::SERVICE_STATUS_FAIL, "Loading interrupted. The robot is in a failed state.");
+      throw CREATE_ERROR(temoto_core::error::Code::SERVICE_STATUS_FAIL, "Waiting for topic '%s' was interrupted."
+      , topic.c_str());
     }
-    ros::Duration(1).sleep();
+    throw CREATE_ERROR(temoto_core::error::Code::SERVICE_STATUS_FAIL, "Topic '%s' did not appear within %.1f seconds."
+    , topic.c_str(), config_->getLoadTimeout());
   }
   TEMOTO_DEBUG("Topic '%s' was found.", topic.c_str());
 }
 
-bool Robot::isTopicAvailable(const std::string& topic)
+void Robot::waitForProbe(const ReadinessProbe& probe)
 {
-  ros::master::V_TopicInfo master_topics;
-  ros::master::getTopics(master_topics);
+  if (!probe.isEnabled())
+  {
+    return;
+  }
 
-  auto it = std::find_if(master_topics.begin()
-  , master_topics.end()
-  , [&](ros::master::TopicInfo& master_topic) -> bool 
-    { 
-      return master_topic.name == topic; 
-    });
-  
-  return it != master_topics.end();
+  ScopedSpan span(metrics_, config_->getName(), "wait_for_probe", probe.type);
+  double timeout = (probe.timeout > 0.0) ? probe.timeout : config_->getLoadTimeout();
+  if (probe.type == probe_type::NONE)
+  {
+    ros::Duration(timeout).sleep();
+    return;
+  }
+
+  std::string name = (!probe.name.empty() && probe.name.front() == '/')
+    ? probe.name
+    : config_->getAbsRobotNamespace() + "/" + probe.name;
+  auto abort_condition = [&]{ return isInError(); };
+
+  TEMOTO_DEBUG("Probing %s '%s' ...", probe.type.c_str(), name.c_str());
+  bool ready = false;
+  if (probe.type == probe_type::TOPIC && probe.min_rate > 0.0)
+  {
+    ready = readiness_monitor_.waitForTopicRate(name, probe.min_rate, ros::WallDuration(timeout), abort_condition);
+  }
+  else if (probe.type == probe_type::TOPIC)
+  {
+    ready = readiness_monitor_.waitForTopic(name, ros::WallDuration(timeout), abort_condition);
+  }
+  else if (probe.type == probe_type::SERVICE)
+  {
+    ready = readiness_monitor_.waitForService(name, ros::WallDuration(timeout), abort_condition);
+  }
+  else if (probe.type == probe_type::ACTION_SERVER)
+  {
+    // Action servers continuously publish their status
+    ready = readiness_monitor_.waitForTopic(name + "/status", ros::WallDuration(timeout), abort_condition);
+  }
+  else if (probe.type == probe_type::PARAM)
+  {
+    ready = readiness_monitor_.waitForParam(name, ros::WallDuration(timeout), abort_condition);
+  }
+  else
+  {
+    throw CREATE_ERROR(temoto_core::error::Code::ROBOT_CONFIG_FAIL, "Unknown readiness probe type '%s'."
+    , probe.type.c_str());
+  }
+
+  if (isInError())
+  {
+    throw CREATE_ERROR(temoto_core::error::Code::SERVICE_STATUS_FAIL, "Loading interrupted. The robot is in a failed state.");
+  }
+
+  if (ready)
+  {
+    TEMOTO_DEBUG("Readiness probe %s '%s' passed.", probe.type.c_str(), name.c_str());
+  }
+  else if (probe.required)
+  {
+    throw CREATE_ERROR(temoto_core::error::Code::SERVICE_STATUS_FAIL, "Readiness probe %s '%s' did not pass within %.1f seconds."
+    , probe.type.c_str(), name.c_str(), timeout);
+  }
+  else
+  {
+    TEMOTO_WARN("Readiness probe %s '%s' did not pass within %.1f seconds, continuing."
+    , probe.type.c_str(), name.c_str(), timeout);
+  }
 }
 
 // Load robot's urdf
@@ -217,10 +629,22 @@ try
 {
   FeatureURDF& ftr = config_->getFeatureURDF();
   std::string urdf_path = '/' + ros::package::getPath(ftr.getPackageName()) + '/' + ftr.getExecutable();
-  auto load_er_msg = rosExecute("temoto_robot_manager", "urdf_loader.py", urdf_path);
-
   std::string robot_desc_param = config_->getAbsRobotNamespace() + "/robot_description";
-  waitForParam(robot_desc_param);
+
+  if (ftr.getLoader() == urdf_loader::SCRIPT)
+  {
+    auto load_er_msg = rosExecute("temoto_robot_manager", "urdf_loader.py", urdf_path + " " + ftr.getArgs());
+    waitForParam(robot_desc_param);
+  }
+  else
+  {
+    std::string robot_description;
+    if (!urdf_cache_.getRobotDescription(urdf_path, ftr.getArgs(), robot_description))
+    {
+      throw CREATE_ERROR(temoto_core::error::Code::ROBOT_CONFIG_FAIL, "Could not expand the URDF '%s'.", urdf_path.c_str());
+    }
+    nh_.setParam(robot_desc_param, robot_description);
+  }
   ftr.setLoaded(true);
   TEMOTO_DEBUG("Feature 'URDF' loaded.");
 }
@@ -244,16 +668,9 @@ void Robot::loadManipulationController()
     //ftr.setResourceId(res_id);
     std::string desc_sem_param = config_->getAbsRobotNamespace() + "/robot_description_semantic";
     waitForParam(desc_sem_param);
-    ros::Duration(5).sleep();
-
-    // Add planning groups
-    // TODO: read groups from srdf automatically
-    for (auto group : ftr.getPlanningGroups())
-    {
-      TEMOTO_DEBUG("Adding planning group '%s'.", group.c_str());
-      addPlanningGroup(group);
-    }
+    waitForProbe(ftr.getReadinessProbe());
 
+    connectManipulation();
     ftr.setLoaded(true);
     TEMOTO_DEBUG("Feature 'Manipulation Controller' loaded.");
   }
@@ -279,6 +696,7 @@ void Robot::loadManipulationDriver()
 
     std::string joint_states_topic = config_->getAbsRobotNamespace() + "/joint_states";
     waitForTopic(joint_states_topic);
+    waitForProbe(ftr.getDriverReadinessProbe());
 
     ftr.setDriverLoaded(true);
     TEMOTO_DEBUG("Feature 'Manipulation Driver' loaded.");
@@ -307,16 +725,9 @@ void Robot::loadNavigationController()
     std::string cmd_vel_topic = config_->getAbsRobotNamespace() + "/" + ftr.getCmdVelTopic();
     waitForTopic(cmd_vel_topic);
 
-    // Subscribe to the pose messages
-    if (!ftr.getPoseTopic().empty())
-    {
-      localized_pose_sub_ = nh_.subscribe(config_->getAbsRobotNamespace() + "/" + ftr.getPoseTopic()
-      , 1
-      , &Robot::robotPoseCallback
-      , this);
-    }
-
-    ros::Duration(5).sleep();
+    connectLocalization();
+    waitForProbe(ftr.getReadinessProbe());
+    createNavigationClient();
     ftr.setLoaded(true);
     TEMOTO_DEBUG("Feature 'Navigation Controller' loaded.");
   }
@@ -341,6 +752,7 @@ void Robot::loadNavigationDriver()
     //ftr.setDriverResourceId(res_id);
     std::string odom_topic = config_->getAbsRobotNamespace() + "/" + ftr.getOdomTopic();
     waitForTopic(odom_topic);
+    waitForProbe(ftr.getDriverReadinessProbe());
     ftr.setDriverLoaded(true);
     TEMOTO_DEBUG("Feature 'Navigation Driver' loaded.");        
   }
@@ -362,8 +774,9 @@ void Robot::loadGripperController()
     FeatureGripper& ftr = config_->getFeatureGripper();
     rosExecute(ftr.getPackageName(), ftr.getExecutable(), ftr.getArgs());          
     //ftr.setResourceId(res_id);
-    std::string gripper_topic = config_->getAbsRobotNamespace() + "/gripper_control";
-    ros::service::waitForService(gripper_topic,-1);
+    waitForProbe(ftr.getReadinessProbe());
+    createGripperClient();
+    startGripperStream();
     ftr.setLoaded(true);
     TEMOTO_DEBUG("Feature 'Gripper Controller' loaded.");
     
@@ -385,9 +798,8 @@ void Robot::loadGripperDriver()
     FeatureGripper& ftr = config_->getFeatureGripper();
     rosExecute(ftr.getDriverPackageName(), ftr.getDriverExecutable(), ftr.getDriverArgs());
     //ftr.setDriverResourceId(res_id);
+    waitForProbe(ftr.getDriverReadinessProbe());
     TEMOTO_DEBUG("Feature 'Gripper driver' loaded.");
-    ros::Duration(5).sleep();
-    TEMOTO_INFO_STREAM("Finish Load Gripper Driver ");
     //
 
   }
@@ -402,6 +814,7 @@ temoto_er_manager::LoadExtResource Robot::rosExecute(const std::string& package_
 , const std::string& args)
 try
 {
+  ScopedSpan span(metrics_, config_->getName(), "ros_execute", executable);
   temoto_er_manager::LoadExtResource load_proc_srvc;
   load_proc_srvc.request.package_name = package_name;
   load_proc_srvc.request.ros_namespace = config_->getAbsRobotNamespace(); //Execute in robot namespace
@@ -414,6 +827,16 @@ try
   , load_proc_srvc
   , std::bind(&Robot::resourceStatusCb, this, std::placeholders::_1, std::placeholders::_2));
 
+  // Without a parent the resources of a warm standby robot would outlive a crashed manager
+  if (config_->isWarmStandby())
+  {
+    resource_registrar_.registerDependency(temoto_er_manager::srv_name::MANAGER
+    , load_proc_srvc.response.temoto_metadata.request_id
+    , getStandbyResourceId(config_));
+  }
+
+  std::lock_guard<std::mutex> lock(ext_resources_mutex_);
+  ext_resources_.push_back(load_proc_srvc);
   return load_proc_srvc;
 }
 catch(temoto_core::error::ErrorStack& error_stack)
@@ -427,209 +850,1173 @@ void Robot::resourceStatusCb(temoto_er_manager::LoadExtResource srv_msg
   TEMOTO_WARN_STREAM_("Received a status message: " << status_msg.message_);
   if (true /* TODO: check the type of the status message */)
   {
-    setInError(true);
     setRobotOperational(false);
+    setResourceLoaded(srv_msg, false);
+    updateVizInfo();
   }
 
   /* 
    * If the status message arrived while the robot was being loaded, then do not
-   * run the recovery procedure
+   * run the recovery procedure but interrupt the loading. The recoveries which are
+   * already in progress are not affected by a crash of another resource
    */ 
   if (!robot_loaded_)
   {
+    setInError(true);
     return;
   }
   else
   {
-    setInError(false);
-    resource_registrar_.unload(temoto_er_manager::srv_name::MANAGER
-    , srv_msg.response.temoto_metadata.request_id);
-
-    auto load_er_query = rosExecute(srv_msg.request.package_name
-    , srv_msg.request.executable
-    , srv_msg.request.args);
-
-    resource_registrar_.registerDependency(temoto_er_manager::srv_name::MANAGER
-    , load_er_query.response.temoto_metadata.request_id
-    , robot_resource_id_);
-
-    // TODO: make sure that the feature is actually properly loaded and obviously all of that
-    // has to be completely restructured
-    FeatureNavigation& ftr = config_->getFeatureNavigation();
-    if (ftr.getPackageName() == srv_msg.request.package_name &&
-        ftr.getExecutable()  == srv_msg.request.executable)
-    {
-      TEMOTO_WARN_STREAM_("The controller of " << config_->getName() << " crashed, restarting it ...");
-      // wait for command velocity to be published
-      std::string cmd_vel_topic = config_->getAbsRobotNamespace() + "/" + ftr.getCmdVelTopic();
-      waitForTopic(cmd_vel_topic);
-    }
-    else if (ftr.getDriverPackageName() == srv_msg.request.package_name &&
-             ftr.getDriverExecutable()  == srv_msg.request.executable)
-    {
-      TEMOTO_WARN_STREAM_("The driver of " << config_->getName() << " crashed, restarting it ...");
-      // wait for command velocity to be published
-      std::string odom_topic = config_->getAbsRobotNamespace() + "/" + ftr.getOdomTopic();
-      waitForTopic(odom_topic);
-      ftr.setDriverLoaded(true);
-    }
-
-     // Send the initial pose
-    ros::Publisher pub = nh_.advertise<geometry_msgs::PoseWithCovarianceStamped>(config_->getAbsRobotNamespace() + "/initialpose", 10);
-    while(pub.getNumSubscribers() < 1)
-    {
-      ros::Duration(0.5).sleep();
-    }
-      
-    // TODO: the inital pose subscriber sometimes ignores the message, hence the message is sent multiple times ...
-    pub.publish(current_pose_navigation_);
-    ros::Duration(1).sleep();
-    pub.publish(current_pose_navigation_);
-    ros::Duration(1).sleep();
-    pub.publish(current_pose_navigation_);
-    ros::Duration(1).sleep();
-    pub.publish(current_pose_navigation_);
-    ros::Duration(1).sleep();
-    pub.publish(current_pose_navigation_);
-    ros::Duration(1).sleep();
-    pub.publish(current_pose_navigation_);
-    ros::Duration(1).sleep();
-    pub.publish(current_pose_navigation_);
-    ros::Duration(1).sleep();
-    pub.publish(current_pose_navigation_);
-    ros::Duration(1).sleep();
-    pub.publish(current_pose_navigation_);
-    ros::Duration(1).sleep();
-    pub.publish(current_pose_navigation_);
-
-    setRobotOperational(true);
+    startRecovery(srv_msg);
   }
 }
 
-void Robot::addPlanningGroup(const std::string& planning_group_name)
-{
-  //Prepare robot description path and a nodehandle, which is in robot's namespace
-  std::string rob_desc = config_->getAbsRobotNamespace() + "/robot_description";
-  ros::NodeHandle mg_nh(config_->getAbsRobotNamespace());
-  moveit::planning_interface::MoveGroupInterface::Options opts(planning_group_name, rob_desc, mg_nh);
-  std::unique_ptr<moveit::planning_interface::MoveGroupInterface> group(
-      new moveit::planning_interface::MoveGroupInterface(opts));
-  group->setPlannerId("RRTConnectkConfigDefault");
-  //group->setPlannerId("ESTkConfigDefault");
-  group->setNumPlanningAttempts(2);
-  group->setPlanningTime(5);
-
-  // Playing around with tolerances
-  group->setGoalPositionTolerance(0.001);
-  group->setGoalOrientationTolerance(0.001);
-  group->setGoalJointTolerance(0.001);
-  TEMOTO_DEBUG("Active end effector link: %s", group->getEndEffectorLink().c_str());
-
-  planning_groups_.emplace(planning_group_name, std::move(group));
-}
-
-void Robot::removePlanningGroup(const std::string& planning_group_name)
+void Robot::startRecovery(const temoto_er_manager::LoadExtResource& srv_msg)
 {
-  planning_groups_.erase(planning_group_name);
+  std::lock_guard<std::mutex> lock(recovery_mutex_);
+  recoveries_.erase(std::remove_if(recoveries_.begin()
+  , recoveries_.end()
+  , [](const Recovery& recovery)
+    {
+      return recovery.result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    })
+  , recoveries_.end());
+
+  Recovery recovery;
+  recovery.cancelled = std::make_shared<std::atomic<bool>>(false);
+  recoveries_in_progress_++;
+  recovery.result = std::async(std::launch::async, &Robot::recoverResource, this, srv_msg, recovery.cancelled);
+  recoveries_.push_back(std::move(recovery));
 }
 
-void Robot::planManipulationPath(std::string& planning_group_name, const geometry_msgs::PoseStamped& target_pose)
+void Robot::recoverResource(temoto_er_manager::LoadExtResource srv_msg, CancelToken cancelled)
+try
 {
-  if (!planning_groups_.size())
+  ScopedSpan span(metrics_, config_->getName(), "recover", srv_msg.request.executable);
+  auto abort_condition = [&]{ return cancelled->load(); };
+  resource_registrar_.unload(temoto_er_manager::srv_name::MANAGER
+  , srv_msg.response.temoto_metadata.request_id);
   {
-    throw CREATE_ERROR(temoto_core::error::Code::ROBOT_PLAN_FAIL,"Robot has no planning groups.");
+    std::lock_guard<std::mutex> lock(ext_resources_mutex_);
+    ext_resources_.erase(std::remove_if(ext_resources_.begin()
+    , ext_resources_.end()
+    , [&](const temoto_er_manager::LoadExtResource& ext_resource)
+      {
+        return ext_resource.response.temoto_metadata.request_id == srv_msg.response.temoto_metadata.request_id;
+      })
+    , ext_resources_.end());
   }
 
-  FeatureManipulation& ftr = config_->getFeatureManipulation();
-
-  planning_group_name = (planning_group_name == "") ? ftr.getActivePlanningGroup() : planning_group_name;
-  auto group_it = planning_groups_.find(planning_group_name);
-  if (group_it == planning_groups_.end())
+  if (abort_condition())
   {
-    throw CREATE_ERROR(temoto_core::error::Code::PLANNING_GROUP_NOT_FOUND, "Planning group '%s' was not found.",
-                       planning_group_name.c_str());
+    throw CREATE_ERROR(temoto_core::error::Code::SERVICE_STATUS_FAIL, "The recovery was cancelled.");
   }
 
-  ftr.setActivePlanningGroup(planning_group_name);
+  auto load_er_query = rosExecute(srv_msg.request.package_name
+  , srv_msg.request.executable
+  , srv_msg.request.args);
 
-  group_it->second->setStartStateToCurrentState();
-
-  // NOTE: Using Pose instead of PoseStamped because in that case it would replace the frame id of the header with empty "" 
-  group_it->second->setPoseTarget(target_pose.pose);
-  is_plan_valid_ = static_cast<bool>(group_it->second->plan(last_plan));
-  
-  TEMOTO_DEBUG("Plan %s",  is_plan_valid_ ? "FOUND" : "FAILED");
-  if(!is_plan_valid_)
+  // The resources of warm standby robots outlive the load query, they depend on the standby resource
+  if (!config_->isWarmStandby())
   {
-    throw CREATE_ERROR(temoto_core::error::Code::ROBOT_PLAN_FAIL,"Planning with group '%s' failed.", group_it->first.c_str());
+    resource_registrar_.registerDependency(temoto_er_manager::srv_name::MANAGER
+    , load_er_query.response.temoto_metadata.request_id
+    , robot_resource_id_);
   }
-}
 
-void Robot::planManipulationPath(std::string& planning_group_name, const std::string& named_target)
-{
-  if (!planning_groups_.size())
+  FeatureNavigation& ftr = config_->getFeatureNavigation();
+  bool navigation_restarted = false;
+  if (ftr.getPackageName() == srv_msg.request.package_name &&
+      ftr.getExecutable()  == srv_msg.request.executable)
   {
-    throw CREATE_ERROR(temoto_core::error::Code::ROBOT_PLAN_FAIL,"Robot has no planning groups.");
+    TEMOTO_WARN_STREAM_("The controller of " << config_->getName() << " crashed, restarting it ...");
+    // wait for command velocity to be published
+    std::string cmd_vel_topic = config_->getAbsRobotNamespace() + "/" + ftr.getCmdVelTopic();
+    waitForTopic(cmd_vel_topic, abort_condition);
+    navigation_restarted = true;
   }
-
-  FeatureManipulation& ftr = config_->getFeatureManipulation();
-
-  planning_group_name = (planning_group_name == "") ? ftr.getActivePlanningGroup() : planning_group_name;
-  auto group_it = planning_groups_.find(planning_group_name);
-  if (group_it == planning_groups_.end())
+  else if (ftr.getDriverPackageName() == srv_msg.request.package_name &&
+           ftr.getDriverExecutable()  == srv_msg.request.executable)
   {
-    throw CREATE_ERROR(temoto_core::error::Code::PLANNING_GROUP_NOT_FOUND, "Planning group '%s' was not found.",
-                       planning_group_name.c_str());
+    TEMOTO_WARN_STREAM_("The driver of " << config_->getName() << " crashed, restarting it ...");
+    // wait for command velocity to be published
+    std::string odom_topic = config_->getAbsRobotNamespace() + "/" + ftr.getOdomTopic();
+    waitForTopic(odom_topic, abort_condition);
+    navigation_restarted = true;
   }
-  ftr.setActivePlanningGroup(planning_group_name);
-  group_it->second->setStartStateToCurrentState();
-  group_it->second->setNamedTarget(named_target);
-  is_plan_valid_ = static_cast<bool>(group_it->second->plan(last_plan));
-  
-  TEMOTO_DEBUG("Plan %s",  is_plan_valid_ ? "FOUND" : "FAILED");
-  if(!is_plan_valid_)
+  else
   {
-    throw CREATE_ERROR(temoto_core::error::Code::ROBOT_PLAN_FAIL,"Planning with group '%s' failed.", group_it->first.c_str());
+    TEMOTO_WARN_STREAM_("'" << srv_msg.request.executable << "' of " << config_->getName() << " crashed, restarted it.");
   }
-}
 
-void Robot::executeManipulationPath()
-{
-  std::string planning_group_name = config_->getFeatureManipulation().getActivePlanningGroup();
-  moveit::planning_interface::MoveGroupInterface::Plan empty_plan;
-  if (!is_plan_valid_)
-  {
-    TEMOTO_ERROR("Unable to execute group '%s' without a plan.", planning_group_name.c_str());
-    return;
-  }
-  auto group_it =
-      planning_groups_.find(planning_group_name);  ///< Will throw if group does not exist
-  if (group_it != planning_groups_.end())
+  // The localization starts over, hence it is given the last pose before the crash
+  geometry_msgs::PoseWithCovarianceStamped last_pose;
   {
-    bool success;
-    group_it->second->setStartStateToCurrentState();
-    group_it->second->setRandomTarget();
-    success = static_cast<bool>(group_it->second->execute(last_plan));
-    TEMOTO_DEBUG("Execution %s",  success ? "SUCCESSFUL" : "FAILED");
+    std::lock_guard<std::mutex> lock(localized_pose_mutex_);
+    last_pose = current_pose_navigation_;
   }
-  else
+  if (navigation_restarted && !last_pose.header.frame_id.empty() && !restoreLocalization(last_pose, abort_condition))
   {
-    TEMOTO_ERROR("Planning group '%s' was not found.", planning_group_name.c_str());
+    TEMOTO_WARN("The localization of %s did not confirm the initial pose.", config_->getName().c_str());
   }
+  setResourceLoaded(srv_msg, true);
+  updateVizInfo();
+  finishRecovery(true);
+}
+catch (temoto_core::error::ErrorStack& error_stack)
+{
+  TEMOTO_ERROR("Failed to recover '%s' of %s.", srv_msg.request.executable.c_str(), config_->getName().c_str());
+  finishRecovery(false);
+}
+catch (const resource_registrar::TemotoErrorStack& e)
+{
+  TEMOTO_ERROR_STREAM(e.what());
+  finishRecovery(false);
+}
+catch (const std::exception& e)
+{
+  TEMOTO_ERROR("Failed to recover '%s' of %s: %s", srv_msg.request.executable.c_str(), config_->getName().c_str(), e.what());
+  finishRecovery(false);
 }
 
-geometry_msgs::Pose Robot::getManipulationTarget()
+void Robot::setResourceLoaded(const temoto_er_manager::LoadExtResource& srv_msg, bool loaded)
 {
-  std::string planning_group_name = config_->getFeatureManipulation().getActivePlanningGroup();
-  
-  auto group_it = planning_groups_.find(planning_group_name);
+  auto is_resource = [&](const std::string& package_name, const std::string& executable)
+  {
+    return package_name == srv_msg.request.package_name && executable == srv_msg.request.executable;
+  };
+
+  std::vector<FeatureWithDriver*> features = {&config_->getFeatureManipulation()
+  , &config_->getFeatureNavigation()
+  , &config_->getFeatureGripper()};
+  for (FeatureWithDriver* feature : features)
+  {
+    if (feature->isEnabled() && is_resource(feature->getPackageName(), feature->getExecutable()))
+    {
+      feature->setLoaded(loaded);
+    }
+    if (feature->isDriverEnabled() && is_resource(feature->getDriverPackageName(), feature->getDriverExecutable()))
+    {
+      feature->setDriverLoaded(loaded);
+    }
+  }
+}
+
+void Robot::finishRecovery(bool recovered)
+{
+  std::lock_guard<std::mutex> lock(recovery_mutex_);
+  recoveries_in_progress_--;
+  recovery_failed_ = recovery_failed_ || !recovered;
+  if (recoveries_in_progress_)
+  {
+    return;
+  }
+
+  if (recovery_failed_)
+  {
+    setInError(true);
+  }
+  else
+  {
+    setRobotOperational(!isInStandby());
+    TEMOTO_DEBUG("Robot %s recovered.", config_->getName().c_str());
+  }
+  recovery_failed_ = false;
+}
+
+bool Robot::restoreLocalization(const geometry_msgs::PoseWithCovarianceStamped& pose
+, const std::function<bool()>& abort_condition)
+{
+  // The localization may drop the first messages while it starts up, hence they are resent
+  const auto resend_period = std::chrono::milliseconds(200);
+  const double position_tolerance = 0.1;     // [m]
+  const double orientation_tolerance = 0.1;  // [rad]
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(config_->getLoadTimeout());
+  while (initial_pose_pub_.getNumSubscribers() == 0)
+  {
+    if (std::chrono::steady_clock::now() > deadline || abort_condition())
+    {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+
+  auto is_accepted = [&](const geometry_msgs::PoseWithCovarianceStamped& localized_pose)
+  {
+    const geometry_msgs::Pose& p1 = localized_pose.pose.pose;
+    const geometry_msgs::Pose& p2 = pose.pose.pose;
+    double position_error = std::hypot(p1.position.x - p2.position.x, p1.position.y - p2.position.y);
+    double dot = std::fabs(p1.orientation.x * p2.orientation.x + p1.orientation.y * p2.orientation.y
+      + p1.orientation.z * p2.orientation.z + p1.orientation.w * p2.orientation.w);
+    double orientation_error = 2.0 * std::acos(std::min(1.0, dot));
+    return position_error < position_tolerance && orientation_error < orientation_tolerance;
+  };
+
+  geometry_msgs::PoseWithCovarianceStamped initial_pose = pose;
+  initial_pose.header.stamp = ros::Time::now();
+
+  // Only the poses which the localization reports after the initial pose was sent are considered
+  std::unique_lock<std::mutex> lock(localized_pose_mutex_);
+  unsigned int sent_pose_count = localized_pose_count_;
+  while (std::chrono::steady_clock::now() < deadline && !abort_condition())
+  {
+    initial_pose_pub_.publish(initial_pose);
+    if (localized_pose_cv_.wait_for(lock, resend_period, [&]
+    {
+      return localized_pose_count_ != sent_pose_count && is_accepted(localized_pose_);
+    }))
+    {
+      TEMOTO_DEBUG("The localization of %s accepted the initial pose.", config_->getName().c_str());
+      return true;
+    }
+  }
+  return false;
+}
+
+void Robot::connectManipulation()
+{
+  loadRobotModel();
+
+  // Add planning groups
+  // TODO: read groups from srdf automatically
+  FeatureManipulation& ftr = config_->getFeatureManipulation();
+  if (ftr.hasLazyPlanningGroups())
+  {
+    TEMOTO_DEBUG("Planning groups are added on first use.");
+  }
+  else
+  {
+    // The interfaces are created concurrently, each one waits for move_group on its own
+    std::vector<std::pair<std::string, std::future<std::unique_ptr<MoveGroupInterface>>>> pending_groups;
+    for (const auto& group : ftr.getPlanningGroups())
+    {
+      TEMOTO_DEBUG("Adding planning group '%s'.", group.c_str());
+      pending_groups.emplace_back(group, std::async(std::launch::async, &Robot::createPlanningGroup, this, group));
+    }
+
+    for (auto& pending_group : pending_groups)
+    {
+      pending_group.second.wait();
+    }
+    std::lock_guard<std::mutex> lock(planning_groups_mutex_);
+    for (auto& pending_group : pending_groups)
+    {
+      insertPlanningGroup(pending_group.first, pending_group.second.get());
+    }
+  }
+
+  if (ftr.getPlanCacheConfig().enabled)
+  {
+    createPlanCache();
+  }
+}
+
+void Robot::loadRobotModel()
+{
+  if (robot_model_)
+  {
+    return;
+  }
+
+  ScopedSpan span(metrics_, config_->getName(), "load_robot_model");
+  std::string rob_desc = config_->getAbsRobotNamespace() + "/robot_description";
+  robot_model_loader::RobotModelLoader robot_model_loader(rob_desc, false);
+  robot_model_ = robot_model_loader.getModel();
+  if (!robot_model_)
+  {
+    throw TEMOTO_ERRSTACK("Could not load the robot model from '" + rob_desc + "'");
+  }
+}
+
+std::unique_ptr<Robot::MoveGroupInterface> Robot::createPlanningGroup(const std::string& planning_group_name) const
+{
+  ScopedSpan span(metrics_, config_->getName(), "create_planning_group", planning_group_name);
+
+  //Prepare robot description path and a nodehandle, which is in robot's namespace
+  std::string rob_desc = config_->getAbsRobotNamespace() + "/robot_description";
+  ros::NodeHandle mg_nh(config_->getAbsRobotNamespace());
+  MoveGroupInterface::Options opts(planning_group_name, rob_desc, mg_nh);
+  opts.robot_model_ = robot_model_;
+  std::unique_ptr<MoveGroupInterface> group(new MoveGroupInterface(opts));
+  group->setPlannerId("RRTConnectkConfigDefault");
+  //group->setPlannerId("ESTkConfigDefault");
+  group->setNumPlanningAttempts(2);
+  group->setPlanningTime(5);
+
+  // Playing around with tolerances
+  group->setGoalPositionTolerance(0.001);
+  group->setGoalOrientationTolerance(0.001);
+  group->setGoalJointTolerance(0.001);
+  TEMOTO_DEBUG("Active end effector link: %s", group->getEndEffectorLink().c_str());
+  return group;
+}
+
+void Robot::insertPlanningGroup(const std::string& planning_group_name, std::unique_ptr<MoveGroupInterface> group)
+{
+  const FeatureManipulation& ftr = config_->getFeatureManipulation();
+  if (ftr.hasPlannerRace(planning_group_name))
+  {
+    TEMOTO_DEBUG("Planning group '%s' races %lu planners.", planning_group_name.c_str()
+    , ftr.getPlannerRaceConfig(planning_group_name).planner_ids.size());
+    planner_races_[planning_group_name] = std::make_unique<PlannerRace>(getInProcessPlanner()
+    , ftr.getPlannerRaceConfig(planning_group_name));
+  }
+
+  planning_groups_[planning_group_name] = std::move(group);
+}
+
+void Robot::addPlanningGroup(const std::string& planning_group_name)
+{
+  loadRobotModel();
+  std::unique_ptr<MoveGroupInterface> group = createPlanningGroup(planning_group_name);
+  std::lock_guard<std::mutex> lock(planning_groups_mutex_);
+  insertPlanningGroup(planning_group_name, std::move(group));
+}
+
+void Robot::removePlanningGroup(const std::string& planning_group_name)
+{
+  // Waits until the interfaces of the group are not used for planning or execution
+  std::lock_guard<std::mutex> planning_lock(planning_mutex_);
+  std::lock_guard<std::mutex> execution_lock(execution_mutex_);
+  std::lock_guard<std::mutex> lock(planning_groups_mutex_);
+  planner_races_.erase(planning_group_name);
+  planning_groups_.erase(planning_group_name);
+  execution_groups_.erase(planning_group_name);
+}
+
+const InProcessPlannerPtr& Robot::getInProcessPlanner()
+{
+  if (!in_process_planner_)
+  {
+    ros::NodeHandle move_group_nh(config_->getAbsRobotNamespace() + "/move_group");
+    in_process_planner_ = std::make_shared<InProcessPlanner>(robot_model_, move_group_nh);
+  }
+  return in_process_planner_;
+}
+
+Robot::MoveGroupInterface* Robot::getPlanningGroup(const std::string& planning_group_name)
+{
+  {
+    std::lock_guard<std::mutex> lock(planning_groups_mutex_);
+    auto group_it = planning_groups_.find(planning_group_name);
+    if (group_it != planning_groups_.end())
+    {
+      return group_it->second.get();
+    }
+  }
+
+  const FeatureManipulation& ftr = config_->getFeatureManipulation();
+  std::vector<std::string> group_names = ftr.getPlanningGroups();
+  if (!ftr.hasLazyPlanningGroups()
+  || !ftr.isLoaded()
+  || std::find(group_names.begin(), group_names.end(), planning_group_name) == group_names.end())
+  {
+    return nullptr;
+  }
+
+  // Connecting to move_group takes a while, the other groups are not blocked meanwhile
+  TEMOTO_DEBUG("Adding planning group '%s' on first use.", planning_group_name.c_str());
+  std::unique_ptr<MoveGroupInterface> group = createPlanningGroup(planning_group_name);
+
+  std::lock_guard<std::mutex> lock(planning_groups_mutex_);
+  auto group_it = planning_groups_.find(planning_group_name);
+  if (group_it != planning_groups_.end())
+  {
+    // Another request created the group first
+    return group_it->second.get();
+  }
+  insertPlanningGroup(planning_group_name, std::move(group));
+  return planning_groups_.at(planning_group_name).get();
+}
+
+Robot::MoveGroupInterface* Robot::getExecutionGroup(const std::string& planning_group_name)
+{
+  {
+    std::lock_guard<std::mutex> lock(planning_groups_mutex_);
+    if (!planning_groups_.count(planning_group_name))
+    {
+      return nullptr;
+    }
+
+    auto group_it = execution_groups_.find(planning_group_name);
+    if (group_it != execution_groups_.end())
+    {
+      return group_it->second.get();
+    }
+  }
+
+  // Only one execution at a time, hence no other request creates the interface meanwhile
+  TEMOTO_DEBUG("Adding the execution interface of group '%s' on first use.", planning_group_name.c_str());
+  std::unique_ptr<MoveGroupInterface> group = createPlanningGroup(planning_group_name);
+
+  std::lock_guard<std::mutex> lock(planning_groups_mutex_);
+  return (execution_groups_[planning_group_name] = std::move(group)).get();
+}
+
+std::string Robot::planManipulationPath(std::string& planning_group_name
+, const geometry_msgs::PoseStamped& target_pose
+, const std::string& start_plan_id)
+{
+  std::string goal_key = plan_cache_ ? plan_cache_->makeGoalKey(target_pose.pose) : "";
+  return planWithGroup(planning_group_name, start_plan_id, goal_key, [&](MoveGroupInterface& group)
+  {
+    // NOTE: Using Pose instead of PoseStamped because in that case it would replace the frame id of the header with empty "" 
+    group.setPoseTarget(target_pose.pose);
+  });
+}
+
+std::string Robot::planManipulationPath(std::string& planning_group_name
+, const std::string& named_target
+, const std::string& start_plan_id)
+{
+  std::string goal_key = plan_cache_ ? plan_cache_->makeGoalKey(named_target) : "";
+  return planWithGroup(planning_group_name, start_plan_id, goal_key, [&](MoveGroupInterface& group)
+  {
+    group.setNamedTarget(named_target);
+  });
+}
+
+std::string Robot::planCartesianPath(std::string& planning_group_name
+, const std::vector<geometry_msgs::Pose>& waypoints
+, double eef_step
+, double jump_threshold
+, const std::string& start_plan_id)
+{
+  // The active planning group may change, the visualization info is updated without the planning lock
+  ScopeExit viz_info_update([this]{ updateVizInfo(); });
+  std::lock_guard<std::mutex> planning_lock(planning_mutex_);
+  robot_state::RobotStatePtr start_state;
+  MoveGroupInterface& group = prepareStartState(planning_group_name, start_plan_id, start_state);
+  ScopedSpan span(metrics_, config_->getName(), "plan_cartesian", planning_group_name);
+
+  MoveGroupInterface::Plan plan;
+  auto start_time = std::chrono::steady_clock::now();
+  double fraction = group.computeCartesianPath(waypoints
+  , eef_step > 0.0 ? eef_step : 0.01
+  , jump_threshold
+  , plan.trajectory_);
+  plan.planning_time_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+  TEMOTO_DEBUG("Cartesian path covers %.1f%% of the waypoints", fraction * 100.0);
+  if (fraction < 1.0 - 1e-6)
+  {
+    throw CREATE_ERROR(temoto_core::error::Code::ROBOT_PLAN_FAIL, "Cartesian path of group '%s' covers only %.1f%% of the waypoints.",
+                       planning_group_name.c_str(), fraction * 100.0);
+  }
+  moveit::core::robotStateToRobotStateMsg(*start_state, plan.start_state_);
+  return storePlan(planning_group_name, plan);
+}
+
+std::string Robot::planJointPath(std::string& planning_group_name
+, const std::string& named_target
+, const std::string& start_plan_id)
+{
+  std::map<std::string, double> target_values;
+  {
+    std::lock_guard<std::mutex> planning_lock(planning_mutex_);
+    planning_group_name = (planning_group_name == "") ? getActivePlanningGroup() : planning_group_name;
+    MoveGroupInterface* group = getPlanningGroup(planning_group_name);
+    if (group)
+    {
+      target_values = group->getNamedTargetValues(named_target);
+    }
+  }
+
+  if (target_values.empty())
+  {
+    throw CREATE_ERROR(temoto_core::error::Code::ROBOT_PLAN_FAIL, "Named target '%s' of group '%s' was not found.",
+                       named_target.c_str(), planning_group_name.c_str());
+  }
+
+  std::vector<std::string> joint_names;
+  std::vector<double> joint_values;
+  for (const auto& target_value : target_values)
+  {
+    joint_names.push_back(target_value.first);
+    joint_values.push_back(target_value.second);
+  }
+  return planJointPath(planning_group_name, joint_names, joint_values, start_plan_id);
+}
+
+std::string Robot::planJointPath(std::string& planning_group_name
+, const std::vector<std::string>& joint_names
+, const std::vector<double>& joint_values
+, const std::string& start_plan_id)
+{
+  // Maximum change of a joint between two waypoints of the interpolated path [rad or m]
+  const double max_joint_step = 0.05;
+
+  if (joint_names.size() != joint_values.size())
+  {
+    throw CREATE_ERROR(temoto_core::error::Code::ROBOT_PLAN_FAIL, "Got %lu joint values for %lu joints.",
+                       joint_values.size(), joint_names.size());
+  }
+
+  // The active planning group may change, the visualization info is updated without the planning lock
+  ScopeExit viz_info_update([this]{ updateVizInfo(); });
+  std::lock_guard<std::mutex> planning_lock(planning_mutex_);
+  robot_state::RobotStatePtr start_state;
+  MoveGroupInterface& group = prepareStartState(planning_group_name, start_plan_id, start_state);
+  ScopedSpan span(metrics_, config_->getName(), "plan_joint", planning_group_name);
+  auto start_time = std::chrono::steady_clock::now();
+
+  const moveit::core::JointModelGroup* joint_group = start_state->getJointModelGroup(planning_group_name);
+  if (!joint_group)
+  {
+    throw CREATE_ERROR(temoto_core::error::Code::PLANNING_GROUP_NOT_FOUND, "Robot model has no group '%s'.",
+                       planning_group_name.c_str());
+  }
+
+  // Only the joints of the group are planned for, other joints would be silently ignored
+  const std::vector<std::string>& group_variables = joint_group->getVariableNames();
+  for (const auto& joint_name : joint_names)
+  {
+    if (std::find(group_variables.begin(), group_variables.end(), joint_name) == group_variables.end())
+    {
+      throw CREATE_ERROR(temoto_core::error::Code::ROBOT_PLAN_FAIL, "Joint '%s' is not in the group '%s'.",
+                         joint_name.c_str(), planning_group_name.c_str());
+    }
+  }
+
+  robot_state::RobotState goal_state(*start_state);
+  goal_state.setVariablePositions(joint_names, joint_values);
+  goal_state.update();
+  if (!goal_state.satisfiesBounds(joint_group))
+  {
+    throw CREATE_ERROR(temoto_core::error::Code::ROBOT_PLAN_FAIL, "The joint target of group '%s' is out of bounds.",
+                       planning_group_name.c_str());
+  }
+
+  double max_joint_distance = 0.0;
+  for (const moveit::core::JointModel* joint : joint_group->getActiveJointModels())
+  {
+    max_joint_distance = std::max(max_joint_distance
+    , joint->distance(start_state->getJointPositions(joint), goal_state.getJointPositions(joint)));
+  }
+
+  robot_trajectory::RobotTrajectory trajectory(start_state->getRobotModel(), planning_group_name);
+  unsigned int step_count = std::max(1u, static_cast<unsigned int>(std::ceil(max_joint_distance / max_joint_step)));
+  robot_state::RobotState waypoint(*start_state);
+  for (unsigned int i = 0; i <= step_count; i++)
+  {
+    start_state->interpolate(goal_state, static_cast<double>(i) / step_count, waypoint, joint_group);
+    waypoint.update();
+    trajectory.addSuffixWayPoint(waypoint, 0.0);
+  }
+
+  planning_scene::PlanningScenePtr scene = getPlanningScene(group);
+  if (!scene || !scene->isPathValid(trajectory, planning_group_name))
+  {
+    throw CREATE_ERROR(temoto_core::error::Code::ROBOT_PLAN_FAIL, "The joint path of group '%s' is not collision free.",
+                       planning_group_name.c_str());
+  }
+
+  MoveGroupInterface::Plan plan;
+  moveit_msgs::MotionPlanRequest request;
+  moveit::core::robotStateToRobotStateMsg(*start_state, request.start_state);
+  toExecutablePlan(trajectory
+  , request
+  , std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count()
+  , plan);
+  return storePlan(planning_group_name, plan);
+}
+
+Robot::MoveGroupInterface& Robot::prepareStartState(std::string& planning_group_name
+, const std::string& start_plan_id
+, robot_state::RobotStatePtr& start_state)
+{
+  FeatureManipulation& ftr = config_->getFeatureManipulation();
+  if (!ftr.getPlanningGroups().size())
+  {
+    throw CREATE_ERROR(temoto_core::error::Code::ROBOT_PLAN_FAIL,"Robot has no planning groups.");
+  }
+
+  if (!ftr.isLoaded())
+  {
+    throw CREATE_ERROR(temoto_core::error::Code::ROBOT_PLAN_FAIL, "The manipulation controller of robot '%s' is not loaded.",
+                       config_->getName().c_str());
+  }
+
+  planning_group_name = (planning_group_name == "") ? getActivePlanningGroup() : planning_group_name;
+  MoveGroupInterface* group_ptr = getPlanningGroup(planning_group_name);
+  if (!group_ptr)
+  {
+    throw CREATE_ERROR(temoto_core::error::Code::PLANNING_GROUP_NOT_FOUND, "Planning group '%s' was not found.",
+                       planning_group_name.c_str());
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(active_planning_group_mutex_);
+    ftr.setActivePlanningGroup(planning_group_name);
+  }
+
+  MoveGroupInterface& group = *group_ptr;
+  moveit::core::RobotStatePtr current_state = group.getCurrentState();
+  if (!current_state)
+  {
+    throw CREATE_ERROR(temoto_core::error::Code::ROBOT_PLAN_FAIL, "The current state of group '%s' is not known.",
+                       planning_group_name.c_str());
+  }
+
+  // A copy, the state of the interface is not modified
+  start_state = std::make_shared<robot_state::RobotState>(*current_state);
+  if (start_plan_id.empty())
+  {
+    group.setStartStateToCurrentState();
+  }
+  else
+  {
+    trajectory_msgs::JointTrajectory start_trajectory;
+    {
+      std::lock_guard<std::mutex> plans_lock(plans_mutex_);
+      auto plan_it = plans_.find(start_plan_id);
+      if (plan_it == plans_.end())
+      {
+        throw CREATE_ERROR(temoto_core::error::Code::ROBOT_PLAN_FAIL, "Start plan '%s' was not found.",
+                           start_plan_id.c_str());
+      }
+      start_trajectory = plan_it->second.plan.trajectory_.joint_trajectory;
+    }
+
+    if (!start_trajectory.points.empty())
+    {
+      start_state->setVariablePositions(start_trajectory.joint_names, start_trajectory.points.back().positions);
+    }
+    group.setStartState(*start_state);
+  }
+  return group;
+}
+
+std::string Robot::planWithGroup(std::string& planning_group_name
+, const std::string& start_plan_id
+, const std::string& goal_key
+, const std::function<void(MoveGroupInterface&)>& set_target)
+{
+  // The active planning group may change, the visualization info is updated without the planning lock
+  ScopeExit viz_info_update([this]{ updateVizInfo(); });
+  std::lock_guard<std::mutex> planning_lock(planning_mutex_);
+  robot_state::RobotStatePtr start_state;
+  MoveGroupInterface& group = prepareStartState(planning_group_name, start_plan_id, start_state);
+  ScopedSpan span(metrics_, config_->getName(), "plan", planning_group_name);
+
+  MoveGroupInterface::Plan plan;
+  std::string cache_key;
+  if (findCachedPlan(group, planning_group_name, *start_state, goal_key, cache_key, plan))
+  {
+    return storePlan(planning_group_name, plan);
+  }
+
+  set_target(group);
+  bool plan_found = false;
+  PlannerRace* planner_race = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(planning_groups_mutex_);
+    auto race_it = planner_races_.find(planning_group_name);
+    planner_race = (race_it != planner_races_.end()) ? race_it->second.get() : nullptr;
+  }
+
+  if (planner_race)
+  {
+    moveit_msgs::MotionPlanRequest request;
+    group.constructMotionPlanRequest(request);
+    planning_scene::PlanningScenePtr scene = getPlanningScene(group);
+    plan_found = scene && planner_race->plan(scene, request, plan);
+  }
+  else
+  {
+    plan_found = static_cast<bool>(group.plan(plan));
+  }
+  
+  TEMOTO_DEBUG("Plan %s",  plan_found ? "FOUND" : "FAILED");
+  if(!plan_found)
+  {
+    throw CREATE_ERROR(temoto_core::error::Code::ROBOT_PLAN_FAIL,"Planning with group '%s' failed.", planning_group_name.c_str());
+  }
+
+  if (plan_cache_)
+  {
+    plan_cache_->insert(cache_key, plan.trajectory_);
+    savePlanCache();
+  }
+  return storePlan(planning_group_name, plan);
+}
+
+void Robot::createPlanCache()
+{
+  const PlanCacheConfig& cache_config = config_->getFeatureManipulation().getPlanCacheConfig();
+  plan_cache_ = std::make_unique<PlanCache>(cache_config);
+
+  if (!cache_config.persistent)
+  {
+    return;
+  }
+
+  std::string cache_dir = getTemotoCacheDir("plan_cache");
+  if (cache_dir.empty())
+  {
+    TEMOTO_WARN("The plans of '%s' are not persisted, there is no cache directory", config_->getName().c_str());
+    return;
+  }
+  // The cached plans are only valid for the model they were planned with
+  std::string urdf;
+  std::string srdf;
+  ros::param::get(config_->getAbsRobotNamespace() + "/robot_description", urdf);
+  ros::param::get(config_->getAbsRobotNamespace() + "/robot_description_semantic", srdf);
+  plan_cache_file_path_ = cache_dir + "/" + PlanCache::makeCacheFileName(config_->getTemotoNamespace()
+  , config_->getName()
+  , urdf + "\n" + srdf);
+
+  if (plan_cache_->load(plan_cache_file_path_))
+  {
+    TEMOTO_DEBUG("Loaded %lu cached plans from '%s'", plan_cache_->size(), plan_cache_file_path_.c_str());
+  }
+}
+
+bool Robot::findCachedPlan(MoveGroupInterface& group
+, const std::string& planning_group_name
+, const robot_state::RobotState& start_state
+, const std::string& goal_key
+, std::string& cache_key
+, MoveGroupInterface::Plan& plan)
+{
+  if (!plan_cache_)
+  {
+    return false;
+  }
+
+  std::vector<double> start_positions;
+  for (const auto& joint_name : group.getActiveJoints())
+  {
+    start_positions.push_back(start_state.getVariablePosition(joint_name));
+  }
+  cache_key = plan_cache_->makeKey(planning_group_name, group.getActiveJoints(), start_positions, goal_key);
+
+  if (!plan_cache_->find(cache_key, plan.trajectory_))
+  {
+    return false;
+  }
+
+  if (config_->getFeatureManipulation().getPlanCacheConfig().validate
+  && !isTrajectoryValid(group, start_state, plan.trajectory_))
+  {
+    TEMOTO_DEBUG("The cached plan for group '%s' is not valid anymore", planning_group_name.c_str());
+    plan_cache_->reject(cache_key);
+    return false;
+  }
+
+  moveit::core::robotStateToRobotStateMsg(start_state, plan.start_state_);
+  plan.planning_time_ = 0.0;
+  PlanCache::Stats stats = plan_cache_->getStats();
+  TEMOTO_DEBUG("Reusing a cached plan for group '%s' (%u hits, %u misses)"
+  , planning_group_name.c_str(), stats.hits, stats.misses);
+  return true;
+}
+
+void Robot::savePlanCache()
+{
+  if (plan_cache_file_path_.empty())
+  {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(plan_cache_save_mutex_);
+  plan_cache_dirty_ = true;
+  if (plan_cache_saving_)
+  {
+    return;
+  }
+
+  plan_cache_saving_ = true;
+  plan_cache_save_ = std::async(std::launch::async, [this]
+  {
+    while (true)
+    {
+      {
+        std::lock_guard<std::mutex> lock(plan_cache_save_mutex_);
+        if (!plan_cache_dirty_)
+        {
+          plan_cache_saving_ = false;
+          return;
+        }
+        plan_cache_dirty_ = false;
+      }
+
+      if (!plan_cache_->save(plan_cache_file_path_))
+      {
+        TEMOTO_WARN("Could not write the plan cache to '%s'", plan_cache_file_path_.c_str());
+      }
+    }
+  });
+}
+
+planning_scene::PlanningScenePtr Robot::getPlanningScene(MoveGroupInterface& group)
+{
+  moveit_msgs::GetPlanningScene scene_srv;
+  scene_srv.request.components.components = moveit_msgs::PlanningSceneComponents::SCENE_SETTINGS
+    | moveit_msgs::PlanningSceneComponents::ROBOT_STATE
+    | moveit_msgs::PlanningSceneComponents::ROBOT_STATE_ATTACHED_OBJECTS
+    | moveit_msgs::PlanningSceneComponents::WORLD_OBJECT_GEOMETRY
+    | moveit_msgs::PlanningSceneComponents::OCTOMAP
+    | moveit_msgs::PlanningSceneComponents::TRANSFORMS
+    | moveit_msgs::PlanningSceneComponents::ALLOWED_COLLISION_MATRIX
+    | moveit_msgs::PlanningSceneComponents::LINK_PADDING_AND_SCALING
+    | moveit_msgs::PlanningSceneComponents::OBJECT_COLORS;
+
+  std::string scene_service = config_->getAbsRobotNamespace() + "/get_planning_scene";
+  if (!ros::service::call(scene_service, scene_srv))
+  {
+    TEMOTO_WARN("Could not get the planning scene from '%s'", scene_service.c_str());
+    return nullptr;
+  }
+
+  auto scene = std::make_shared<planning_scene::PlanningScene>(group.getRobotModel());
+  scene->setPlanningSceneMsg(scene_srv.response.scene);
+  return scene;
+}
+
+bool Robot::isTrajectoryValid(MoveGroupInterface& group
+, const robot_state::RobotState& start_state
+, const moveit_msgs::RobotTrajectory& trajectory)
+{
+  planning_scene::PlanningScenePtr scene = getPlanningScene(group);
+  if (!scene)
+  {
+    return false;
+  }
+
+  moveit_msgs::RobotState start_state_msg;
+  moveit::core::robotStateToRobotStateMsg(start_state, start_state_msg);
+  return scene->isPathValid(start_state_msg, trajectory, group.getName());
+}
+
+std::string Robot::storePlan(const std::string& planning_group_name, const MoveGroupInterface::Plan& plan)
+{
+  // Bounds the memory used by plans which are never executed
+  const unsigned int max_stored_plans = 64;
+
+  std::lock_guard<std::mutex> plans_lock(plans_mutex_);
+  std::string plan_id = planning_group_name + "_" + std::to_string(plan_count_++);
+  plans_[plan_id] = StoredPlan{planning_group_name, plan};
+  latest_plan_ids_[planning_group_name] = plan_id;
+  plan_order_.push_back(plan_id);
+
+  while (plan_order_.size() > max_stored_plans)
+  {
+    erasePlan(plan_order_.front());
+  }
+  return plan_id;
+}
+
+void Robot::erasePlan(const std::string& plan_id)
+{
+  auto plan_it = plans_.find(plan_id);
+  if (plan_it == plans_.end())
+  {
+    return;
+  }
+  std::string planning_group_name = plan_it->second.planning_group_name;
+  plans_.erase(plan_it);
+  plan_order_.erase(std::remove(plan_order_.begin(), plan_order_.end(), plan_id), plan_order_.end());
+
+  // An older plan would start from an outdated state, hence it does not become the latest one
+  auto latest_it = latest_plan_ids_.find(planning_group_name);
+  if (latest_it != latest_plan_ids_.end() && latest_it->second == plan_id)
+  {
+    latest_plan_ids_.erase(latest_it);
+  }
+}
+
+std::vector<RobotPlanResult> Robot::planManipulationPaths(const std::vector<RobotPlanGoal>& goals)
+{
+  std::vector<RobotPlanResult> results(goals.size());
+  std::vector<moveit_msgs::MotionPlanRequest> requests(goals.size());
+  std::vector<std::string> group_names(goals.size());
+  std::vector<std::string> cache_keys(goals.size());
+  planning_scene::PlanningScenePtr scene;
+  InProcessPlannerPtr planner;
+
+  /*
+   * The start states are prepared and the cache is looked up as for a single goal. The
+   * requests of the cache misses are composed by the group interfaces, which hold the targets
+   */
+  {
+    std::lock_guard<std::mutex> planning_lock(planning_mutex_);
+    for (unsigned int i = 0; i < goals.size(); i++)
+    try
+    {
+      group_names[i] = goals[i].planning_group;
+      robot_state::RobotStatePtr start_state;
+      MoveGroupInterface& group = prepareStartState(group_names[i], goals[i].start_plan_id, start_state);
+
+      std::string goal_key;
+      if (plan_cache_)
+      {
+        goal_key = goals[i].use_named_target
+          ? plan_cache_->makeGoalKey(goals[i].named_target)
+          : plan_cache_->makeGoalKey(goals[i].target_pose.pose);
+      }
+
+      MoveGroupInterface::Plan plan;
+      if (findCachedPlan(group, group_names[i], *start_state, goal_key, cache_keys[i], plan))
+      {
+        setPlanResult(storePlan(group_names[i], plan), plan, results[i]);
+        continue;
+      }
+
+      if (goals[i].use_named_target)
+      {
+        group.setNamedTarget(goals[i].named_target);
+      }
+      else
+      {
+        group.setPoseTarget(goals[i].target_pose.pose);
+      }
+      group.constructMotionPlanRequest(requests[i]);
+      moveit::core::robotStateToRobotStateMsg(*start_state, requests[i].start_state);
+
+      if (!scene)
+      {
+        scene = getPlanningScene(group);
+      }
+    }
+    catch (temoto_core::error::ErrorStack& error_stack)
+    {
+      results[i].message = getErrorMessage(error_stack);
+    }
+    catch (const std::exception& e)
+    {
+      results[i].message = e.what();
+    }
+
+    std::lock_guard<std::mutex> lock(planning_groups_mutex_);
+    if (robot_model_)
+    {
+      planner = getInProcessPlanner();
+    }
+  }
+  updateVizInfo();
+
+  if (!scene || !planner || !planner->isAvailable())
+  {
+    TEMOTO_WARN("The planners are not available in-process, planning the goals one after another.");
+    planManipulationPathsSequentially(goals, results);
+    return results;
+  }
+
+  std::vector<planning_interface::PlanningContextPtr> contexts(goals.size());
+  std::vector<unsigned int> pending_goals;
+  for (unsigned int i = 0; i < goals.size(); i++)
+  {
+    if (results[i].success || !results[i].message.empty())
+    {
+      continue;
+    }
+
+    contexts[i] = planner->createContext(scene, requests[i]);
+    if (contexts[i])
+    {
+      pending_goals.push_back(i);
+    }
+    else
+    {
+      results[i].message = "Could not create a planning context.";
+    }
+  }
+
+  // Each worker takes the next pending goal until all goals are planned
+  std::atomic<unsigned int> next_goal(0);
+  auto plan_goals = [&]
+  {
+    for (unsigned int n = next_goal++; n < pending_goals.size(); n = next_goal++)
+    {
+      unsigned int i = pending_goals[n];
+      auto start_time = std::chrono::steady_clock::now();
+      planning_interface::MotionPlanResponse response;
+      if (!contexts[i]->solve(response) || !response.trajectory_)
+      {
+        results[i].message = "Planning with group '" + group_names[i] + "' failed.";
+        continue;
+      }
+
+      MoveGroupInterface::Plan plan;
+      toExecutablePlan(*response.trajectory_
+      , requests[i]
+      , std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count()
+      , plan);
+      if (plan_cache_)
+      {
+        plan_cache_->insert(cache_keys[i], plan.trajectory_);
+      }
+      setPlanResult(storePlan(group_names[i], plan), plan, results[i]);
+    }
+  };
+
+  unsigned int worker_count = std::max(1u, std::min<unsigned int>(pending_goals.size(), std::thread::hardware_concurrency()));
+  std::vector<std::thread> workers;
+  for (unsigned int i = 0; i < worker_count; i++)
+  {
+    workers.emplace_back(plan_goals);
+  }
+  for (auto& worker : workers)
+  {
+    worker.join();
+  }
+
+  if (plan_cache_ && !pending_goals.empty())
+  {
+    savePlanCache();
+  }
+  return results;
+}
+
+void Robot::planManipulationPathsSequentially(const std::vector<RobotPlanGoal>& goals
+, std::vector<RobotPlanResult>& results)
+{
+  for (unsigned int i = 0; i < goals.size(); i++)
+  {
+    if (results[i].success || !results[i].message.empty())
+    {
+      continue;
+    }
+
+    try
+    {
+      std::string group_name = goals[i].planning_group;
+      std::string plan_id = goals[i].use_named_target
+        ? planManipulationPath(group_name, goals[i].named_target, goals[i].start_plan_id)
+        : planManipulationPath(group_name, goals[i].target_pose, goals[i].start_plan_id);
+
+      std::lock_guard<std::mutex> plans_lock(plans_mutex_);
+      setPlanResult(plan_id, plans_.at(plan_id).plan, results[i]);
+    }
+    catch (temoto_core::error::ErrorStack& error_stack)
+    {
+      results[i].message = getErrorMessage(error_stack);
+    }
+    catch (const std::exception& e)
+    {
+      results[i].message = e.what();
+    }
+  }
+}
+
+void Robot::setPlanResult(const std::string& plan_id
+, const MoveGroupInterface::Plan& plan
+, RobotPlanResult& result) const
+{
+  result.success = true;
+  result.plan_id = plan_id;
+  result.duration = getDuration(plan.trajectory_.joint_trajectory);
+  result.path_length = getPathLength(plan.trajectory_.joint_trajectory);
+}
+
+bool Robot::isPlanStartValid(MoveGroupInterface& group, const MoveGroupInterface::Plan& plan) const
+{
+  const trajectory_msgs::JointTrajectory& trajectory = plan.trajectory_.joint_trajectory;
+  if (trajectory.points.empty())
+  {
+    return true;
+  }
+
+  double tolerance = config_->getFeatureManipulation().getStartStateTolerance();
+  moveit::core::RobotStatePtr current_state = group.getCurrentState();
+  if (!current_state)
+  {
+    return false;
+  }
+
+  for (unsigned int i = 0; i < trajectory.joint_names.size(); i++)
+  {
+    double current_position = current_state->getVariablePosition(trajectory.joint_names[i]);
+    if (std::fabs(current_position - trajectory.points.front().positions[i]) > tolerance)
+    {
+      TEMOTO_DEBUG("Joint '%s' has drifted from the start of the plan", trajectory.joint_names[i].c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+void Robot::executeManipulationPath(const std::string& plan_id)
+{
+  std::lock_guard<std::mutex> execution_lock(execution_mutex_);
+  std::string planning_group_name = getActivePlanningGroup();
+
+  StoredPlan stored_plan;
+  {
+    std::lock_guard<std::mutex> plans_lock(plans_mutex_);
+    std::string stored_plan_id = plan_id;
+    if (stored_plan_id.empty())
+    {
+      auto latest_it = latest_plan_ids_.find(planning_group_name);
+      if (latest_it != latest_plan_ids_.end())
+      {
+        stored_plan_id = latest_it->second;
+      }
+    }
+
+    auto plan_it = plans_.find(stored_plan_id);
+    if (plan_it == plans_.end())
+    {
+      throw TEMOTO_ERRSTACK(plan_id.empty()
+        ? "Unable to execute group '" + planning_group_name + "' without a plan."
+        : "Plan '" + plan_id + "' was not found, it has either been executed or dropped.");
+    }
+
+    // A plan is executed only once, afterwards its start state is outdated
+    stored_plan = plan_it->second;
+    erasePlan(stored_plan_id);
+    planning_group_name = stored_plan.planning_group_name;
+  }
+
+  // The plans of the next motions are made meanwhile with the planning interface of the group
+  MoveGroupInterface* group = getExecutionGroup(planning_group_name);
+  if (!group)
+  {
+    throw TEMOTO_ERRSTACK("Planning group '" + planning_group_name + "' was not found.");
+  }
+
+  if (!isPlanStartValid(*group, stored_plan.plan))
+  {
+    throw TEMOTO_ERRSTACK("The plan of group '" + planning_group_name
+      + "' no longer starts from the current state of the robot.");
+  }
+
+  ScopedSpan span(metrics_, config_->getName(), "execute", planning_group_name);
+  executing_group_ = group;
+  bool success = static_cast<bool>(group->execute(stored_plan.plan));
+  executing_group_ = nullptr;
+  TEMOTO_DEBUG("Execution %s",  success ? "SUCCESSFUL" : "FAILED");
+
+  if (!success)
+  {
+    throw TEMOTO_ERRSTACK("Execution with group '" + planning_group_name + "' failed.");
+  }
+}
+
+void Robot::stopManipulation()
+{
+  moveit::planning_interface::MoveGroupInterface* group = executing_group_;
+  if (group)
+  {
+    group->stop();
+  }
+}
+
+geometry_msgs::Pose Robot::getManipulationTarget()
+{
+  std::lock_guard<std::mutex> planning_lock(planning_mutex_);
+  std::string planning_group_name = getActivePlanningGroup();
+  
+  MoveGroupInterface* group = getPlanningGroup(planning_group_name);
   TEMOTO_INFO_STREAM(planning_group_name.c_str());
 
   geometry_msgs::Pose current_pose;
   
-  if (group_it != planning_groups_.end())
+  if (group)
   {    
-    current_pose = group_it->second->getCurrentPose().pose;    
+    current_pose = group->getCurrentPose().pose;    
   }
   else 
   {
@@ -640,55 +2027,167 @@ geometry_msgs::Pose Robot::getManipulationTarget()
 }
 
 void Robot::goalNavigation(const std::string& reference_frame, const geometry_msgs::PoseStamped& target_pose)
+{
+  goalNavigationRoute(reference_frame, {target_pose}, {}, 0.0);
+}
+
+void Robot::goalNavigationRoute(const std::string& reference_frame
+, const std::vector<geometry_msgs::PoseStamped>& route
+, const std::vector<double>& tolerances
+, double look_ahead_radius
+, WaypointPassedCb waypoint_passed_cb)
 {
   if (!isRobotOperational())
   {
     throw TEMOTO_ERRSTACK("Could not navigate the robot because robot is not operational");
   }
 
-  FeatureNavigation& ftr = config_->getFeatureNavigation();
-  std::string act_rob_ns = config_->getAbsRobotNamespace() + "/move_base";
-  MoveBaseClient ac(act_rob_ns, true);    
-  
-  if (!ac.waitForServer(ros::Duration(5.0)))
+  if (route.empty())
+  {
+    throw TEMOTO_ERRSTACK("Could not navigate the robot because the route has no waypoints");
+  }
+
+  if (!tolerances.empty() && tolerances.size() != route.size())
   {
-    TEMOTO_ERRSTACK("The move_base action server did not come up");
+    throw TEMOTO_ERRSTACK("Got " + std::to_string(tolerances.size()) + " tolerances for "
+      + std::to_string(route.size()) + " waypoints");
   }
 
-  move_base_msgs::MoveBaseGoal goal;  
-  goal.target_pose.pose = target_pose.pose;
-  goal.target_pose.header.frame_id = reference_frame;         
-  goal.target_pose.header.stamp = ros::Time::now();  
-  ac.sendGoal(goal);
+  std::lock_guard<std::mutex> navigation_lock(navigation_mutex_);
+  ScopedSpan span(metrics_, config_->getName(), "navigation");
+  if (!move_base_client_)
+  {
+    throw TEMOTO_ERRSTACK("Could not navigate the robot because its navigation controller is not loaded");
+  }
 
-  // Wait until either the goal is finished or robot has encountered a system issue
-  while((ac.getState() == actionlib::SimpleClientGoalState::PENDING || ac.getState() == actionlib::SimpleClientGoalState::ACTIVE)
-     && isRobotOperational())
+  if (!move_base_client_->isServerConnected() && !move_base_client_->waitForServer(ros::Duration(5.0)))
   {
-    ros::Duration(1).sleep();
+    throw TEMOTO_ERRSTACK("The move_base action server did not come up");
   }
 
-  if (!isRobotOperational())
   {
-    ac.cancelGoal();
-    throw TEMOTO_ERRSTACK("Could not finish the navigation goal because the robot is not operational");
+    std::lock_guard<std::mutex> goal_lock(navigation_goal_mutex_);
+    navigation_cancel_requested_ = false;
+  }
+
+  for (unsigned int i = 0; i < route.size(); i++)
+  {
+    bool last_waypoint = (i == route.size() - 1);
+
+    move_base_msgs::MoveBaseGoal goal;  
+    goal.target_pose.pose = route[i].pose;
+    goal.target_pose.header.frame_id = reference_frame;         
+    goal.target_pose.header.stamp = ros::Time::now();  
+
+    {
+      std::lock_guard<std::mutex> state_lock(navigation_state_mutex_);
+      navigation_goal_done_ = false;
+      navigation_waypoint_near_ = false;
+      navigation_waypoint_ = goal.target_pose;
+      navigation_switch_radius_ = last_waypoint
+        ? 0.0
+        : std::max(look_ahead_radius, tolerances.empty() ? 0.0 : tolerances[i]);
+    }
+
+    {
+      // Sending a new goal preempts the previous one, hence the base keeps on moving
+      std::lock_guard<std::mutex> goal_lock(navigation_goal_mutex_);
+      if (navigation_cancel_requested_)
+      {
+        throw TEMOTO_ERRSTACK("The navigation goal was canceled");
+      }
+      move_base_client_->sendGoal(goal
+      , boost::bind(&Robot::navigationDoneCb, this, _1, _2)
+      , MoveBaseClient::SimpleActiveCallback()
+      , boost::bind(&Robot::navigationFeedbackCb, this, _1));
+    }
+
+    std::unique_lock<std::mutex> state_lock(navigation_state_mutex_);
+
+    // Wait until either the waypoint is reached or robot has encountered a system issue
+    navigation_state_cv_.wait(state_lock, [&]
+    {
+      return navigation_goal_done_ || navigation_waypoint_near_ || !isRobotOperational();
+    });
+
+    if (!navigation_goal_done_ && !navigation_waypoint_near_)
+    {
+      state_lock.unlock();
+      move_base_client_->cancelGoal();
+      throw TEMOTO_ERRSTACK("Could not finish the navigation goal because the robot is not operational");
+    }
+    else if(navigation_goal_done_ && move_base_client_->getState() != actionlib::SimpleClientGoalState::SUCCEEDED)
+    {
+      throw TEMOTO_ERRSTACK("The base failed to move to waypoint " + std::to_string(i));
+    }
+    state_lock.unlock();
+
+    TEMOTO_DEBUG_STREAM("Passed waypoint " << i + 1 << "/" << route.size());
+    if (waypoint_passed_cb)
+    {
+      waypoint_passed_cb(i);
+    }
+  }
+}
+
+void Robot::cancelNavigationGoal()
+{
+  std::lock_guard<std::mutex> goal_lock(navigation_goal_mutex_);
+  navigation_cancel_requested_ = true;
+  if (move_base_client_)
+  {
+    move_base_client_->cancelGoal();
+  }
+}
+
+void Robot::navigationDoneCb(const actionlib::SimpleClientGoalState& state
+, const move_base_msgs::MoveBaseResultConstPtr& result)
+{
+  TEMOTO_DEBUG("Navigation goal finished with state %s", state.toString().c_str());
+  std::lock_guard<std::mutex> lock(navigation_state_mutex_);
+  navigation_goal_done_ = true;
+  navigation_state_cv_.notify_all();
+}
+
+void Robot::navigationFeedbackCb(const move_base_msgs::MoveBaseFeedbackConstPtr& feedback)
+{
+  std::lock_guard<std::mutex> lock(navigation_state_mutex_);
+
+  // The distance is comparable only when the route is given in the global frame of move_base
+  if (navigation_switch_radius_ <= 0.0
+  || navigation_waypoint_near_
+  || feedback->base_position.header.frame_id != navigation_waypoint_.header.frame_id)
+  {
+    return;
   }
-  else if(ac.getState() != actionlib::SimpleClientGoalState::SUCCEEDED)
+
+  double dx = feedback->base_position.pose.position.x - navigation_waypoint_.pose.position.x;
+  double dy = feedback->base_position.pose.position.y - navigation_waypoint_.pose.position.y;
+  if (std::hypot(dx, dy) <= navigation_switch_radius_)
   {
-    throw TEMOTO_ERRSTACK("The base failed to move");
+    navigation_waypoint_near_ = true;
+    navigation_state_cv_.notify_all();
   }
 }
 
+void Robot::createNavigationClient()
+{
+  std::string act_rob_ns = config_->getAbsRobotNamespace() + "/move_base";
+  move_base_client_ = std::make_unique<MoveBaseClient>(act_rob_ns, true);
+}
+
 void Robot::controlGripper(const std::string& robot_name,const float position)
 {
+  std::lock_guard<std::mutex> gripper_lock(gripper_mutex_);
+  ScopedSpan span(metrics_, config_->getName(), "gripper");
   try
   {
-    FeatureGripper& ftr = config_->getFeatureGripper();   
-    std::string argument = std::to_string(position);
-    std::string gripper_topic = config_->getAbsRobotNamespace() + "/gripper_control";
-    
-    TEMOTO_DEBUG("Feature 'Gripper' loaded.");
-    client_gripper_control_ = nh_.serviceClient<temoto_robot_manager::GripperControl>(gripper_topic);
+    // The connection is lost when the gripper controller restarts
+    if (!client_gripper_control_.isValid())
+    {
+      createGripperClient();
+    }
+
     temoto_robot_manager::GripperControl gripper_srvc;
     gripper_srvc.request.robot_name = robot_name;
     gripper_srvc.request.position = position;    
@@ -699,6 +2198,8 @@ void Robot::controlGripper(const std::string& robot_name,const float position)
     else
     {
       TEMOTO_ERROR("Call to remote RobotManager service failed.");
+      client_gripper_control_.shutdown();
+      span.setFailed();
     }  
   }
   catch(temoto_core::error::ErrorStack& error_stack)
@@ -707,6 +2208,62 @@ void Robot::controlGripper(const std::string& robot_name,const float position)
   }
 }
 
+void Robot::createGripperClient()
+{
+  // Persistent, so that streamed setpoints do not pay for a new connection each
+  std::string gripper_topic = config_->getAbsRobotNamespace() + "/gripper_control";
+  client_gripper_control_ = nh_.serviceClient<temoto_robot_manager::GripperControl>(gripper_topic, true);
+}
+
+void Robot::startGripperStream()
+{
+  if (gripper_stream_thread_.joinable())
+  {
+    return;
+  }
+
+  gripper_stream_thread_ = std::thread(&Robot::gripperStreamLoop, this);
+  gripper_position_sub_ = nh_.subscribe(config_->getAbsRobotNamespace() + "/" + srv_name::GRIPPER_POSITION_TOPIC
+  , 1
+  , &Robot::gripperPositionCb
+  , this);
+}
+
+void Robot::gripperPositionCb(const std_msgs::Float32& msg)
+{
+  std::lock_guard<std::mutex> lock(gripper_setpoint_mutex_);
+  gripper_setpoint_ = msg.data;
+  gripper_setpoint_pending_ = true;
+  gripper_setpoint_cv_.notify_one();
+}
+
+void Robot::gripperStreamLoop()
+{
+  std::unique_lock<std::mutex> lock(gripper_setpoint_mutex_);
+  while (true)
+  {
+    gripper_setpoint_cv_.wait(lock, [&]{ return gripper_setpoint_pending_ || gripper_stream_stopped_; });
+    if (gripper_stream_stopped_)
+    {
+      return;
+    }
+
+    float setpoint = gripper_setpoint_;
+    gripper_setpoint_pending_ = false;
+    lock.unlock();
+
+    try
+    {
+      controlGripper(config_->getName(), setpoint);
+    }
+    catch (temoto_core::error::ErrorStack& error_stack)
+    {
+      TEMOTO_WARN("Failed to move the gripper of %s to %f.", config_->getName().c_str(), setpoint);
+    }
+    lock.lock();
+  }
+}
+
 bool Robot::isLocal() const
 {
   if (config_) 
@@ -718,38 +2275,177 @@ bool Robot::isLocal() const
 
 std::string Robot::getVizInfo()
 {
-  std::string act_rob_ns = config_->getAbsRobotNamespace();
+  updateVizInfo();
+  std::lock_guard<std::mutex> lock(viz_info_mutex_);
+  return viz_info_;
+}
+
+void Robot::updateVizInfo()
+{
+  const std::string& act_rob_ns = config_->getAbsRobotNamespace();
+  FeatureURDF& ftr_urdf = config_->getFeatureURDF();
+  FeatureManipulation& ftr_manipulation = config_->getFeatureManipulation();
+  FeatureNavigation& ftr_navigation = config_->getFeatureNavigation();
+  FeatureGripper& ftr_gripper = config_->getFeatureGripper();
+
+  // Everything else in the info is fixed by the config
+  std::string active_planning_group = getActivePlanningGroup();
+  std::string state;
+  state += ftr_urdf.isLoaded() ? '1' : '0';
+  state += ftr_manipulation.isLoaded() ? '1' : '0';
+  state += ftr_navigation.isLoaded() ? '1' : '0';
+  state += ftr_gripper.isLoaded() ? '1' : '0';
+  state += active_planning_group;
+
+  std::lock_guard<std::mutex> lock(viz_info_mutex_);
+  if (!viz_info_.empty() && state == viz_info_state_)
+  {
+    return;
+  }
+
   YAML::Node info;
   YAML::Node rviz = info["RViz"];
 
   // RViz options
-  //TODO: SYNC info about robot features and if thet are actually loaded or not.
-
-  if (config_->getFeatureURDF().isEnabled())
+  if (ftr_urdf.isEnabled())
   {
     rviz["urdf"]["robot_description"] = act_rob_ns + "/robot_description";
+    rviz["urdf"]["loaded"] = ftr_urdf.isLoaded();
   }
 
-  if (config_->getFeatureManipulation().isEnabled())
+  if (ftr_manipulation.isEnabled())
   {
     rviz["manipulation"]["move_group_ns"] = act_rob_ns;
-    rviz["manipulation"]["active_planning_group"] =
-        config_->getFeatureManipulation().getActivePlanningGroup();
+    rviz["manipulation"]["active_planning_group"] = active_planning_group;
+    rviz["manipulation"]["loaded"] = ftr_manipulation.isLoaded();
   }
 
-  if (config_->getFeatureNavigation().isEnabled())
+  if (ftr_navigation.isEnabled())
   {
     rviz["navigation"]["move_base_ns"] = act_rob_ns;
-    rviz["navigation"]["global_planner"] = config_->getFeatureNavigation().getGlobalPlanner();
-    rviz["navigation"]["local_planner"] = config_->getFeatureNavigation().getLocalPlanner();
+    rviz["navigation"]["global_planner"] = ftr_navigation.getGlobalPlanner();
+    rviz["navigation"]["local_planner"] = ftr_navigation.getLocalPlanner();
+    rviz["navigation"]["loaded"] = ftr_navigation.isLoaded();
   }
 
-  if (config_->getFeatureGripper().isEnabled())
+  if (ftr_gripper.isEnabled())
   {
     rviz["gripper"]["gripper_ns"] = act_rob_ns;    
+    rviz["gripper"]["loaded"] = ftr_gripper.isLoaded();
   }
   
-  return YAML::Dump(info);
+  viz_info_ = YAML::Dump(info);
+  viz_info_state_ = state;
+
+  if (!isLocal())
+  {
+    return;
+  }
+  if (!viz_info_pub_)
+  {
+    viz_info_pub_ = nh_.advertise<std_msgs::String>(act_rob_ns + "/" + srv_name::VIZ_INFO_TOPIC, 1, true);
+  }
+  std_msgs::String viz_info_msg;
+  viz_info_msg.data = viz_info_;
+  viz_info_pub_.publish(viz_info_msg);
+}
+
+RobotStatus Robot::getStatus()
+{
+  RobotStatus status;
+  status.robot_name = config_->getName();
+  status.temoto_namespace = config_->getTemotoNamespace();
+  status.stamp = ros::Time::now();
+  status.operational = isRobotOperational() && !isInStandby();
+  status.in_error = isInError();
+
+  if (config_->getFeatureManipulation().isLoaded())
+  {
+    status.active_planning_group = getActivePlanningGroup();
+
+    // The group interfaces are not used, they are not thread-safe and may block for a second
+    std::vector<std::pair<std::string, std::string>> end_effector_links;
+    moveit::core::RobotModelConstPtr robot_model;
+    {
+      std::lock_guard<std::mutex> groups_lock(planning_groups_mutex_);
+      for (const auto& group : planning_groups_)
+      {
+        if (!group.second->getEndEffectorLink().empty())
+        {
+          end_effector_links.emplace_back(group.first, group.second->getEndEffectorLink());
+        }
+      }
+      robot_model = robot_model_;
+    }
+
+    moveit::core::RobotStatePtr current_state = end_effector_links.empty()
+      ? nullptr
+      : getCurrentRobotState(robot_model);
+    for (const auto& end_effector_link : end_effector_links)
+    {
+      if (!current_state || !robot_model->hasLinkModel(end_effector_link.second))
+      {
+        continue;
+      }
+
+      const auto& transform = current_state->getGlobalLinkTransform(end_effector_link.second);
+      Eigen::Quaterniond orientation(transform.rotation());
+      geometry_msgs::PoseStamped end_effector_pose;
+      end_effector_pose.header.frame_id = robot_model->getModelFrame();
+      end_effector_pose.header.stamp = status.stamp;
+      end_effector_pose.pose.position.x = transform.translation().x();
+      end_effector_pose.pose.position.y = transform.translation().y();
+      end_effector_pose.pose.position.z = transform.translation().z();
+      end_effector_pose.pose.orientation.x = orientation.x();
+      end_effector_pose.pose.orientation.y = orientation.y();
+      end_effector_pose.pose.orientation.z = orientation.z();
+      end_effector_pose.pose.orientation.w = orientation.w();
+
+      status.planning_groups.push_back(end_effector_link.first);
+      status.end_effector_poses.push_back(end_effector_pose);
+    }
+  }
+
+  if (config_->getFeatureNavigation().isLoaded())
+  {
+    std::lock_guard<std::mutex> lock(localized_pose_mutex_);
+    status.has_navigation_pose = localized_pose_count_ > 0;
+    status.navigation_pose = current_pose_navigation_;
+  }
+  return status;
+}
+
+moveit::core::RobotStatePtr Robot::getCurrentRobotState(const moveit::core::RobotModelConstPtr& robot_model)
+{
+  std::lock_guard<std::mutex> lock(state_monitor_mutex_);
+  if (!state_monitor_)
+  {
+    // The monitor of the joint states is shared with the group interfaces
+    ros::NodeHandle robot_nh(config_->getAbsRobotNamespace());
+    state_monitor_ = moveit::planning_interface::getSharedStateMonitor(robot_model
+    , moveit::planning_interface::getSharedTF()
+    , robot_nh);
+  }
+
+  if (!state_monitor_)
+  {
+    return nullptr;
+  }
+  if (!state_monitor_->isActive())
+  {
+    state_monitor_->startStateMonitor();
+  }
+  if (!state_monitor_->haveCompleteState())
+  {
+    return nullptr;
+  }
+  return state_monitor_->getCurrentState();
+}
+
+std::string Robot::getActivePlanningGroup() const
+{
+  std::lock_guard<std::mutex> lock(active_planning_group_mutex_);
+  return config_->getFeatureManipulation().getActivePlanningGroup();
 }
 
 bool Robot::isRobotOperational() const
@@ -760,16 +2456,41 @@ bool Robot::isRobotOperational() const
 
 void Robot::setRobotOperational(bool robot_operational)
 {
-  std::lock_guard<std::recursive_mutex> lock(robot_operational_mutex_);
-  robot_operational_ = robot_operational;
+  {
+    std::lock_guard<std::recursive_mutex> lock(robot_operational_mutex_);
+    robot_operational_ = robot_operational;
+  }
+
+  // Wake up the navigation goal, so that it is cancelled immediately
+  std::lock_guard<std::mutex> lock(navigation_state_mutex_);
+  navigation_state_cv_.notify_all();
 }
 
 void Robot::robotPoseCallback(const geometry_msgs::PoseWithCovarianceStamped& msg)
 {
+  std::lock_guard<std::mutex> lock(localized_pose_mutex_);
+  localized_pose_ = msg;
+  localized_pose_count_++;
   if (isRobotOperational())
   {
     current_pose_navigation_ = msg;
   }
+  localized_pose_cv_.notify_all();
+}
+
+void Robot::connectLocalization()
+{
+  initial_pose_pub_ = nh_.advertise<geometry_msgs::PoseWithCovarianceStamped>(config_->getAbsRobotNamespace() + "/initialpose", 10);
+
+  // Subscribe to the pose messages
+  const FeatureNavigation& ftr = config_->getFeatureNavigation();
+  if (!ftr.getPoseTopic().empty())
+  {
+    localized_pose_sub_ = nh_.subscribe(config_->getAbsRobotNamespace() + "/" + ftr.getPoseTopic()
+    , 1
+    , &Robot::robotPoseCallback
+    , this);
+  }
 }
 
 void Robot::recover(const std::string& parent_query_id)
@@ -780,7 +2501,8 @@ void Robot::recover(const std::string& parent_query_id)
    * TODO: this method needs data race protection via mutexes
    */
 
-  auto erm_queries = resource_registrar_.getRosChildQueries<temoto_er_manager::LoadExtResource>(parent_query_id
+  auto erm_queries = resource_registrar_.getRosChildQueries<temoto_er_manager::LoadExtResource>(
+    config_->isWarmStandby() ? getStandbyResourceId(config_) : parent_query_id
   , temoto_er_manager::srv_name::SERVER);
 
   TEMOTO_DEBUG_STREAM_("size of erm_queries: " << erm_queries.size());
@@ -791,6 +2513,9 @@ void Robot::recover(const std::string& parent_query_id)
     , temoto_er_manager::srv_name::SERVER
     , erm_query.second.response.temoto_metadata.request_id
     , std::bind(&Robot::resourceStatusCb, this, std::placeholders::_1, std::placeholders::_2));
+
+    std::lock_guard<std::mutex> lock(ext_resources_mutex_);
+    ext_resources_.push_back(erm_query.second);
   }
 
   /*
@@ -803,6 +2528,19 @@ void Robot::recover(const std::string& parent_query_id)
     config_->getFeatureURDF().setLoaded(true);
   }
   
+  // Recover the manipulation driver
+  if (config_->getFeatureManipulation().isDriverEnabled())
+  {
+    config_->getFeatureManipulation().setDriverLoaded(true);
+  }
+
+  // Recover the manipulation controller, move_group is running already
+  if (config_->getFeatureManipulation().isEnabled())
+  {
+    connectManipulation();
+    config_->getFeatureManipulation().setLoaded(true);
+  }
+
   // Recover the navigation driver
   if (config_->getFeatureNavigation().isDriverEnabled())
   {
@@ -812,19 +2550,22 @@ void Robot::recover(const std::string& parent_query_id)
   // Recover the navigation controller
   if (config_->getFeatureNavigation().isEnabled())
   {
-    // Subscribe to the pose messages
-    if (!config_->getFeatureNavigation().getPoseTopic().empty())
-    {
-      localized_pose_sub_ = nh_.subscribe(config_->getAbsRobotNamespace() + "/" + config_->getFeatureNavigation().getPoseTopic()
-      , 1
-      , &Robot::robotPoseCallback
-      , this);
-    }
+    connectLocalization();
+    createNavigationClient();
     config_->getFeatureNavigation().setLoaded(true);
   }
 
+  // Recover the gripper controller
+  if (config_->getFeatureGripper().isEnabled())
+  {
+    createGripperClient();
+    startGripperStream();
+    config_->getFeatureGripper().setLoaded(true);
+  }
+
   robot_loaded_ = true;
   setRobotOperational(true);
+  updateVizInfo();
 }
 
 void Robot::setResourceId(const std::string& resource_id)
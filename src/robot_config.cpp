@@ -21,8 +21,12 @@
 
 namespace temoto_robot_manager
 {
-RobotConfig::RobotConfig(YAML::Node yaml_config, temoto_core::BaseSubsystem& b)
+RobotConfig::RobotConfig(YAML::Node yaml_config, temoto_core::BaseSubsystem& b, bool parse_features)
 : yaml_config_(yaml_config)
+, load_timeout_(30.0)
+, warm_standby_(false)
+, preload_(false)
+, standby_idle_timeout_(600.0)
 , temoto_core::BaseSubsystem(b)
 {
   class_name_ = "RobotConfig";
@@ -41,6 +45,22 @@ RobotConfig::RobotConfig(YAML::Node yaml_config, temoto_core::BaseSubsystem& b)
   parseTemotoNamespace();
   parseDescription();
   parseReliability();
+  parseLoadTimeout();
+  parseWarmStandby();
+
+  if (parse_features)
+  {
+    parseFeatures();
+  }
+}
+
+void RobotConfig::parseFeatures()
+{
+  if (features_parsed_)
+  {
+    return;
+  }
+  features_parsed_ = true;
 
   // Parse robot features
   parseUrdf();
@@ -100,6 +120,54 @@ void RobotConfig::parseReliability()
   }
 }
 
+void RobotConfig::parseLoadTimeout()
+{
+  if (yaml_config_["load_timeout"].IsDefined())
+  {
+    try
+    {
+      load_timeout_ = yaml_config_["load_timeout"].as<double>();
+    }
+    catch (YAML::Exception& e)
+    {
+      TEMOTO_WARN("CONFIG: error parsing load_timeout: %s", e.what());
+    }
+  }
+}
+
+void RobotConfig::parseWarmStandby()
+{
+  const YAML::Node& warm_standby = yaml_config_["warm_standby"];
+  if (!warm_standby.IsDefined())
+  {
+    return;
+  }
+
+  try
+  {
+    // Either a flag or a map of the standby options
+    if (warm_standby.IsScalar())
+    {
+      warm_standby_ = warm_standby.as<bool>();
+      return;
+    }
+
+    warm_standby_ = true;
+    if (warm_standby["preload"].IsDefined())
+    {
+      preload_ = warm_standby["preload"].as<bool>();
+    }
+    if (warm_standby["idle_timeout"].IsDefined())
+    {
+      standby_idle_timeout_ = warm_standby["idle_timeout"].as<double>();
+    }
+  }
+  catch (YAML::Exception& e)
+  {
+    TEMOTO_WARN("CONFIG: error parsing warm_standby: %s", e.what());
+  }
+}
+
 void RobotConfig::parseUrdf()
 {
   if (!yaml_config_["urdf"].IsDefined())
@@ -178,6 +246,7 @@ std::string RobotConfig::toString() const
   ret += "ROBOT: " + getName() + "\n";
   ret += "  description : " + getDescription() + "\n";
   ret += "  reliability : " + std::to_string(getReliability()) + "\n";
+  ret += warm_standby_ ? "  warm standby" + std::string(preload_ ? ", preloaded" : "") + "\n" : "";
   ret += "  features: \n";
   ret += feature_urdf_.isEnabled() ? "    urdf\n" : "";
   ret += feature_manipulation_.isEnabled() ? "    manipulation\n" : "";
@@ -0,0 +1,159 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "temoto_robot_manager/robot_config_index.h"
+#include <algorithm>
+
+namespace temoto_robot_manager
+{
+namespace
+{
+bool moreReliable(const RobotConfigPtr& rc1, const RobotConfigPtr& rc2)
+{
+  return rc1->getReliability() > rc2->getReliability();
+}
+
+const RobotConfigs EMPTY_CONFIGS;
+}
+
+bool RobotConfigIndex::insert(const RobotConfigPtr& config)
+{
+  bool replaced = erase(config);
+  RobotConfigs& configs = configs_by_name_[config->getName()];
+  configs.insert(std::upper_bound(configs.begin(), configs.end(), config, moreReliable), config);
+  size_++;
+  return replaced;
+}
+
+bool RobotConfigIndex::erase(const RobotConfigPtr& config)
+{
+  auto name_it = configs_by_name_.find(config->getName());
+  if (name_it == configs_by_name_.end())
+  {
+    return false;
+  }
+
+  RobotConfigs& configs = name_it->second;
+  auto config_it = std::find_if(configs.begin()
+  , configs.end()
+  , [&](const RobotConfigPtr& c)
+    {
+      return c->getTemotoNamespace() == config->getTemotoNamespace();
+    });
+
+  if (config_it == configs.end())
+  {
+    return false;
+  }
+
+  configs.erase(config_it);
+  size_--;
+  if (configs.empty())
+  {
+    configs_by_name_.erase(name_it);
+  }
+  return true;
+}
+
+RobotConfigPtr RobotConfigIndex::find(const std::string& temoto_namespace, const std::string& robot_name) const
+{
+  for (const auto& config : findAll(robot_name))
+  {
+    if (config->getTemotoNamespace() == temoto_namespace)
+    {
+      return config;
+    }
+  }
+  return nullptr;
+}
+
+RobotConfigPtr RobotConfigIndex::findBest(const std::string& robot_name) const
+{
+  // If robot name is unspecified, pick the best one from all configs.
+  if (robot_name.empty())
+  {
+    RobotConfigPtr best;
+    for (const auto& name_configs : configs_by_name_)
+    {
+      if (!best || moreReliable(name_configs.second.front(), best))
+      {
+        best = name_configs.second.front();
+      }
+    }
+    return best;
+  }
+
+  const RobotConfigs& configs = findAll(robot_name);
+  return configs.empty() ? nullptr : configs.front();
+}
+
+const RobotConfigs& RobotConfigIndex::findAll(const std::string& robot_name) const
+{
+  auto name_it = configs_by_name_.find(robot_name);
+  return (name_it == configs_by_name_.end()) ? EMPTY_CONFIGS : name_it->second;
+}
+
+void RobotConfigIndex::updateReliability(const std::string& robot_name)
+{
+  auto name_it = configs_by_name_.find(robot_name);
+  if (name_it != configs_by_name_.end())
+  {
+    std::stable_sort(name_it->second.begin(), name_it->second.end(), moreReliable);
+  }
+}
+
+bool RobotConfigIndex::contains(const std::string& robot_name) const
+{
+  return configs_by_name_.find(robot_name) != configs_by_name_.end();
+}
+
+size_t RobotConfigIndex::eraseNamespace(const std::string& temoto_namespace)
+{
+  size_t erased_count = 0;
+  for (auto name_it = configs_by_name_.begin(); name_it != configs_by_name_.end();)
+  {
+    RobotConfigs& configs = name_it->second;
+    auto configs_end = std::remove_if(configs.begin()
+    , configs.end()
+    , [&](const RobotConfigPtr& c)
+      {
+        return c->getTemotoNamespace() == temoto_namespace;
+      });
+
+    erased_count += std::distance(configs_end, configs.end());
+    configs.erase(configs_end, configs.end());
+    name_it = configs.empty() ? configs_by_name_.erase(name_it) : std::next(name_it);
+  }
+  size_ -= erased_count;
+  return erased_count;
+}
+
+RobotConfigs RobotConfigIndex::getConfigs() const
+{
+  RobotConfigs configs;
+  configs.reserve(size_);
+  for (const auto& name_configs : configs_by_name_)
+  {
+    configs.insert(configs.end(), name_configs.second.begin(), name_configs.second.end());
+  }
+  return configs;
+}
+
+size_t RobotConfigIndex::size() const
+{
+  return size_;
+}
+} // namespace temoto_robot_manager
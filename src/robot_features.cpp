@@ -15,6 +15,7 @@
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 #include "temoto_robot_manager/robot_features.h"
+#include <algorithm>
 #include <iostream>
 
 // ALL OF THESE CLASSES MAY THROW YAML EXCEPTIONS
@@ -31,22 +32,34 @@ FeatureWithDriver::FeatureWithDriver(const std::string& name)
 }
 
 FeatureURDF::FeatureURDF() : RobotFeature("urdf")
+, loader_(urdf_loader::NATIVE)
 {
 }
 
 FeatureURDF::FeatureURDF(const YAML::Node& urdf_conf) : RobotFeature("urdf")
+, loader_(urdf_loader::NATIVE)
 {
   this->package_name_ = urdf_conf["package_name"].as<std::string>();
   this->executable_ = urdf_conf["executable"].as<std::string>();
+  if (urdf_conf["args"])
+  {
+    this->args_ = urdf_conf["args"].as<std::string>();
+  }
+  setFromConfig(urdf_conf["depends_on"], this->dependencies_);
+  setFromConfig(urdf_conf["loader"], this->loader_);
   this->feature_enabled_ = true;
 }
 
 FeatureManipulation::FeatureManipulation() : FeatureWithDriver("manipulation")
+, start_state_tolerance_(0.01)
+, lazy_planning_groups_(false)
 {
 }
 
 FeatureManipulation::FeatureManipulation(const YAML::Node& manip_conf)
   : FeatureWithDriver("manipulation")
+  , start_state_tolerance_(0.01)
+  , lazy_planning_groups_(false)
 {
   this->package_name_ = manip_conf["controller"]["package_name"].as<std::string>();
   if (manip_conf["controller"]["executable"])
@@ -63,6 +76,16 @@ FeatureManipulation::FeatureManipulation(const YAML::Node& manip_conf)
     this->args_ = manip_conf["controller"]["args"].as<std::string>();
   }
 
+  // move_group needs the URDF and the joint states published by the driver
+  if (!setFromConfig(manip_conf["controller"]["depends_on"], this->dependencies_))
+  {
+    this->dependencies_ = {load_stage::URDF, load_stage::MANIPULATION_DRIVER};
+  }
+  if (!setFromConfig(manip_conf["controller"]["readiness_probe"], this->readiness_probe_))
+  {
+    this->readiness_probe_ = ReadinessProbe(probe_type::ACTION_SERVER, "move_group", 5.0);
+  }
+
   // parse planning groups
   YAML::Node yaml_groups = manip_conf["controller"]["planning_groups"];
   for (YAML::const_iterator it = yaml_groups.begin(); it != yaml_groups.end(); ++it)
@@ -73,6 +96,13 @@ FeatureManipulation::FeatureManipulation(const YAML::Node& manip_conf)
   {
     active_planning_group_ = planning_groups_.front();
   }
+  setFromConfig(manip_conf["controller"]["start_state_tolerance"], start_state_tolerance_);
+  if (manip_conf["controller"]["lazy_planning_groups"].IsDefined())
+  {
+    lazy_planning_groups_ = manip_conf["controller"]["lazy_planning_groups"].as<bool>();
+  }
+  parsePlanCacheConfig(manip_conf["controller"]["plan_cache"]);
+  parsePlannerRaceConfigs(manip_conf["controller"]["planner_race"]);
   this->feature_enabled_ = true;
 
   this->driver_package_name_ = manip_conf["driver"]["package_name"].as<std::string>();
@@ -81,9 +111,75 @@ FeatureManipulation::FeatureManipulation(const YAML::Node& manip_conf)
   {
     this->driver_args_ = manip_conf["driver"]["args"].as<std::string>();
   }
+  if (!setFromConfig(manip_conf["driver"]["depends_on"], this->driver_dependencies_))
+  {
+    this->driver_dependencies_ = {load_stage::URDF};
+  }
+  setFromConfig(manip_conf["driver"]["readiness_probe"], this->driver_readiness_probe_);
   this->driver_enabled_ = true;
 }
 
+void FeatureManipulation::parsePlanCacheConfig(const YAML::Node& config)
+{
+  if (!config.IsDefined())
+  {
+    return;
+  }
+
+  plan_cache_config_.enabled = true;
+  if (config["enabled"].IsDefined())
+  {
+    plan_cache_config_.enabled = config["enabled"].as<bool>();
+  }
+  if (config["size"].IsDefined())
+  {
+    plan_cache_config_.size = config["size"].as<unsigned int>();
+  }
+  if (config["persistent"].IsDefined())
+  {
+    plan_cache_config_.persistent = config["persistent"].as<bool>();
+  }
+  if (config["validate"].IsDefined())
+  {
+    plan_cache_config_.validate = config["validate"].as<bool>();
+  }
+  setFromConfig(config["joint_resolution"], plan_cache_config_.joint_resolution);
+  setFromConfig(config["position_resolution"], plan_cache_config_.position_resolution);
+  setFromConfig(config["orientation_resolution"], plan_cache_config_.orientation_resolution);
+}
+
+void FeatureManipulation::parsePlannerRaceConfigs(const YAML::Node& config)
+{
+  if (!config.IsDefined())
+  {
+    return;
+  }
+
+  // The races are given per planning group
+  for (YAML::const_iterator it = config.begin(); it != config.end(); ++it)
+  {
+    PlannerRaceConfig race_config;
+    setFromConfig(it->second["planner_ids"], race_config.planner_ids);
+    setFromConfig(it->second["deadline"], race_config.deadline);
+    setFromConfig(it->second["mode"], race_config.mode);
+    if (it->second["seeds"].IsDefined())
+    {
+      race_config.seeds = std::max(1u, it->second["seeds"].as<unsigned int>());
+    }
+
+    if (race_config.planner_ids.empty())
+    {
+      continue;
+    }
+
+    if (race_config.mode != race_mode::FIRST && race_config.mode != race_mode::SHORTEST)
+    {
+      race_config.mode = race_mode::FIRST;
+    }
+    planner_races_[it->first.as<std::string>()] = race_config;
+  }
+}
+
 FeatureNavigation::FeatureNavigation() : FeatureWithDriver("navigation")
 {
 }
@@ -107,6 +203,14 @@ FeatureNavigation::FeatureNavigation(const YAML::Node& nav_conf)
       setFromConfig(nav_conf["controller"]["global_planner"], this->global_planner_);
       setFromConfig(nav_conf["controller"]["local_planner"], this->local_planner_);
       setFromConfig(nav_conf["controller"]["pose_topic"], this->pose_topic_);
+      if (!setFromConfig(nav_conf["controller"]["depends_on"], this->dependencies_))
+      {
+        this->dependencies_ = {load_stage::NAVIGATION_DRIVER};
+      }
+      if (!setFromConfig(nav_conf["controller"]["readiness_probe"], this->readiness_probe_))
+      {
+        this->readiness_probe_ = ReadinessProbe(probe_type::ACTION_SERVER, "move_base", 5.0);
+      }
     }
   }
 
@@ -121,6 +225,8 @@ FeatureNavigation::FeatureNavigation(const YAML::Node& nav_conf)
     setFromConfig(nav_conf["driver"]["args"], this->driver_args_);
     setFromConfig(nav_conf["driver"]["odom_topic"], this->odom_topic_);
     setFromConfig(nav_conf["driver"]["cmd_vel_topic"], this->cmd_vel_topic_);
+    setFromConfig(nav_conf["driver"]["depends_on"], this->driver_dependencies_);
+    setFromConfig(nav_conf["driver"]["readiness_probe"], this->driver_readiness_probe_);
   }
 }
 
@@ -145,6 +251,15 @@ FeatureGripper::FeatureGripper(const YAML::Node& grip_conf)
   {
     this->args_ = grip_conf["controller"]["args"].as<std::string>();
   }
+  if (!setFromConfig(grip_conf["controller"]["depends_on"], this->dependencies_))
+  {
+    this->dependencies_ = {load_stage::GRIPPER_DRIVER};
+  }
+  if (!setFromConfig(grip_conf["controller"]["readiness_probe"], this->readiness_probe_))
+  {
+    // The gripper is commanded via this service, the feature is useless without it
+    this->readiness_probe_ = ReadinessProbe(probe_type::SERVICE, "gripper_control", 0.0, true);
+  }
   this->feature_enabled_ = true;
   this->driver_package_name_ = grip_conf["driver"]["package_name"].as<std::string>();
   this->driver_executable_ = grip_conf["driver"]["executable"].as<std::string>();
@@ -152,6 +267,14 @@ FeatureGripper::FeatureGripper(const YAML::Node& grip_conf)
   {
     this->driver_args_ = grip_conf["driver"]["args"].as<std::string>();
   }
+  setFromConfig(grip_conf["driver"]["depends_on"], this->driver_dependencies_);
+
+  // Nothing is known about the readiness of an arbitrary gripper driver, hence
+  // unless a probe is specified, just give it some time to come up
+  if (!setFromConfig(grip_conf["driver"]["readiness_probe"], this->driver_readiness_probe_))
+  {
+    this->driver_readiness_probe_ = ReadinessProbe(probe_type::NONE, "", 5.0);
+  }
   this->driver_enabled_ = true;
 }
 
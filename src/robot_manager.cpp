@@ -16,19 +16,165 @@
 
 #include "ros/package.h"
 #include "temoto_core/temoto_error/temoto_error.h"
+#include "temoto_core/common/tools.h"
 #include "temoto_robot_manager/robot_manager.h"
+#include "temoto_robot_manager/cache_dir.h"
+#include "temoto_robot_manager/robot_selection.h"
 #include "temoto_er_manager/temoto_er_manager_services.h"
 #include <boost/filesystem/operations.hpp>
+#include <ros/serialization.h>
 #include <yaml-cpp/yaml.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <fstream>
+#include <future>
 #include <sstream>
+#include <system_error>
 
 namespace temoto_robot_manager
 {
-RobotManager::RobotManager(const std::string& config_base_path)
+namespace
+{
+// Prefix of the payloads which carry a serialized RobotConfigSync
+const std::string SYNC_PAYLOAD_MAGIC = "temoto_robot_config_sync_1\n";
+
+// Keys of the YAML payload of the previous release
+const std::string LEGACY_SYNC_EPOCH = "epoch";
+const std::string LEGACY_SYNC_CONFIGS = "Configs";
+const std::string LEGACY_SYNC_RELIABILITIES = "Reliabilities";
+
+// Host statuses older than this (s) are not used for the robot selection
+const double HOST_STATUS_TIMEOUT = 5.0;
+
+// The managers publish their host status every second, a manager which has not been heard
+// from for this long is considered dead
+const double MANAGER_LEASE = 10.0;
+
+// Relayed robot states older than this are not used for answering the requests
+const double ROBOT_STATUS_TIMEOUT = 1.0;
+
+// Period (s) of checking whether the warm standby robots should be unloaded
+const double STANDBY_EVICTION_PERIOD = 5.0;
+
+// Each goal occupies a worker thread until it is finished
+const unsigned int MAX_ACTIVE_GOALS = 32;
+
+// Time (s) for which the status of a finished goal can still be queried
+const double GOAL_RETENTION = 60.0;
+
+HostLoad getHostLoad(const HostStatus& status)
+{
+  HostLoad host_load;
+  host_load.known = true;
+  host_load.cpu_load = status.cpu_load;
+  host_load.robots = status.loaded_robots + status.pending_loads;
+  return host_load;
+}
+
+// Load average per core
+double getCpuLoad()
+{
+  double load_average = 0.0;
+  if (getloadavg(&load_average, 1) != 1)
+  {
+    return 0.0;
+  }
+  return load_average / std::max(1u, std::thread::hardware_concurrency());
+}
+
+// MemAvailable of the host in MB, negative if it is not known
+double getAvailableMemory()
+{
+  std::ifstream meminfo("/proc/meminfo");
+  std::string line;
+  while (std::getline(meminfo, line))
+  {
+    unsigned long available_memory_kb = 0;
+    if (std::sscanf(line.c_str(), "MemAvailable: %lu kB", &available_memory_kb) == 1)
+    {
+      return available_memory_kb / 1024.0;
+    }
+  }
+  return -1.0;
+}
+
+// Counts the loads in progress
+class PendingLoad
+{
+public:
+  PendingLoad(std::atomic<unsigned int>& pending_loads)
+  : pending_loads_(pending_loads)
+  {
+    pending_loads_++;
+  }
+
+  ~PendingLoad()
+  {
+    pending_loads_--;
+  }
+
+private:
+  std::atomic<unsigned int>& pending_loads_;
+};
+
+// Runs the release function when the load has finished, successfully or not
+class LoadReservation
+{
+public:
+  LoadReservation(std::function<void()> release)
+  : release_(release)
+  {}
+
+  ~LoadReservation()
+  {
+    release_();
+  }
+
+private:
+  std::function<void()> release_;
+};
+} // namespace
+
+PayloadType encodeConfigSync(const RobotConfigSync& config_sync)
+{
+  uint32_t length = ros::serialization::serializationLength(config_sync);
+  PayloadType payload;
+  payload.data = SYNC_PAYLOAD_MAGIC + std::string(length, '\0');
+  ros::serialization::OStream stream(reinterpret_cast<uint8_t*>(&payload.data[SYNC_PAYLOAD_MAGIC.size()]), length);
+  ros::serialization::serialize(stream, config_sync);
+  return payload;
+}
+
+bool decodeConfigSync(const PayloadType& payload, RobotConfigSync& config_sync)
+{
+  if (payload.data.compare(0, SYNC_PAYLOAD_MAGIC.size(), SYNC_PAYLOAD_MAGIC) != 0)
+  {
+    return false;
+  }
+
+  std::string buffer = payload.data.substr(SYNC_PAYLOAD_MAGIC.size());
+  ros::serialization::IStream stream(reinterpret_cast<uint8_t*>(&buffer[0]), buffer.size());
+  ros::serialization::deserialize(stream, config_sync);
+  return true;
+}
+
+RobotManager::RobotManager(const std::string& config_base_path
+, bool hot_reload
+, double robot_status_rate
+, bool enable_metrics
+, const WarmStandbyConfig& warm_standby_config)
 : temoto_core::BaseSubsystem("robot_manager", temoto_core::error::Subsystem::ROBOT_MANAGER, __func__)
-, resource_registrar_(srv_name::MANAGER)
+, metrics_(enable_metrics)
+, remote_configs_(MANAGER_LEASE)
+, warm_standby_config_(warm_standby_config)
+, sync_epoch_(std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count())
+, remote_clients_(metrics_)
 , config_syncer_(srv_name::MANAGER, srv_name::SYNC_TOPIC, &RobotManager::syncCb, this)
+, resource_registrar_(srv_name::MANAGER)
+, urdf_cache_(getTemotoCacheDir("urdf_cache"))
 , tf2_listener(tf2_buffer)
 {
   /*
@@ -53,17 +199,9 @@ RobotManager::RobotManager(const std::string& config_base_path)
   resource_registrar_.init();
 
   /*
-   * Find the robot_description.yaml file
-   */
-  findRobotDescriptionFiles(config_base_path);
-
-  /*
-   * Check if this node should be recovered from a previous system failure
+   * Find the robot_description.yaml files
    */
-  if (boost::filesystem::exists(rr_catalog_backup_path))
-  {
-    restoreState();
-  }
+  discoverRobotDescriptions(config_base_path, hot_reload);
 
   // resource_registrar_.registerStatusCb(&RobotManager::resourceStatusCb);
 
@@ -77,6 +215,10 @@ RobotManager::RobotManager(const std::string& config_base_path)
     srv_name::SERVER_PLAN,
     &RobotManager::planManipulationPathCb,
     this);
+  server_plan_batch_ = nh_.advertiseService(
+    srv_name::SERVER_PLAN_BATCH,
+    &RobotManager::planManipulationBatchCb,
+    this);
   server_exec_ = nh_.advertiseService(
     srv_name::SERVER_EXECUTE,
     &RobotManager::execManipulationPathCb,
@@ -101,263 +243,938 @@ RobotManager::RobotManager(const std::string& config_base_path)
     srv_name::SERVER_GET_CONFIG,
     &RobotManager::getRobotConfigCb,
     this);
+  server_get_robot_configs_ = nh_.advertiseService(
+    srv_name::SERVER_GET_CONFIGS,
+    &RobotManager::getRobotConfigsCb,
+    this);
 
-  TEMOTO_INFO_("Robot manager is ready.");
-}
+  /*
+   * Servers for non-blocking goals
+   */
+  goal_status_pub_ = nh_.advertise<RobotGoalStatus>(srv_name::GOAL_STATUS_TOPIC, 100);
+  server_navigation_goal_async_ = nh_.advertiseService(
+    srv_name::SERVER_NAVIGATION_GOAL_ASYNC,
+    &RobotManager::goalNavigationAsyncCb,
+    this);
+  server_exec_async_ = nh_.advertiseService(
+    srv_name::SERVER_EXECUTE_ASYNC,
+    &RobotManager::execManipulationPathAsyncCb,
+    this);
+  server_cancel_goal_ = nh_.advertiseService(
+    srv_name::SERVER_CANCEL_GOAL,
+    &RobotManager::cancelGoalCb,
+    this);
+  server_get_goal_status_ = nh_.advertiseService(
+    srv_name::SERVER_GET_GOAL_STATUS,
+    &RobotManager::getGoalStatusCb,
+    this);
+  server_navigation_route_ = nh_.advertiseService(
+    srv_name::SERVER_NAVIGATION_ROUTE,
+    &RobotManager::navigationRouteCb,
+    this);
+  goal_reap_timer_ = nh_.createWallTimer(ros::WallDuration(1.0), &RobotManager::reapGoalsCb, this);
+
+  /*
+   * Exchange the load of the hosts with the other managers
+   */
+  host_status_pub_ = nh_.advertise<HostStatus>(srv_name::HOST_STATUS_TOPIC, 10);
+  host_status_sub_ = nh_.subscribe(srv_name::HOST_STATUS_TOPIC, 100, &RobotManager::hostStatusCb, this);
+  host_status_timer_ = nh_.createWallTimer(ros::WallDuration(1.0), &RobotManager::publishHostStatus, this);
+  lease_timer_ = nh_.createWallTimer(ros::WallDuration(1.0), &RobotManager::evictExpiredManagers, this);
 
-void RobotManager::findRobotDescriptionFiles(boost::filesystem::path current_dir)
-{ 
-  boost::filesystem::directory_iterator end_itr;
-  for ( boost::filesystem::directory_iterator itr( current_dir ); itr != end_itr; ++itr )
+  /*
+   * Stream the state of the local robots and relay the state of the remote robots
+   */
+  robot_status_sub_ = nh_.subscribe(srv_name::ROBOT_STATUS_TOPIC, 100, &RobotManager::robotStatusCb, this);
+  if (robot_status_rate > 0.0)
   {
-    if (boost::filesystem::is_regular_file(*itr) && (itr->path().filename() == "robot_description.yaml"))
-    {      
-      TEMOTO_INFO_STREAM_(itr->path().string());   
-      readRobotDescription(itr->path().string());
-    }
-    else if ( boost::filesystem::is_directory(*itr) )
-    {
-      findRobotDescriptionFiles(*itr);
-    }
+    robot_status_pub_ = nh_.advertise<RobotStatusArray>(srv_name::ROBOT_STATUS_TOPIC, 10);
+    robot_status_timer_ = nh_.createWallTimer(ros::WallDuration(1.0 / robot_status_rate)
+    , &RobotManager::publishRobotStatus
+    , this);
   }
-}
 
-void RobotManager::readRobotDescription(const std::string& path_to_rob_description)
-{
-  std::ifstream in(path_to_rob_description);
-  YAML::Node yaml_config = YAML::Load(in);  
-  // Parse the Robots section
-  if (yaml_config["Robots"])
+  /*
+   * Latency histograms of the services, load stages and forwarded calls
+   */
+  server_get_metrics_ = nh_.advertiseService(
+    srv_name::SERVER_GET_METRICS,
+    &RobotManager::getMetricsCb,
+    this);
+  metrics_pub_ = nh_.advertise<RobotManagerMetrics>(srv_name::METRICS_TOPIC, 1);
+  metrics_timer_ = nh_.createWallTimer(ros::WallDuration(1.0), &RobotManager::publishMetrics, this);
+
+  /*
+   * Check if this node should be recovered from a previous system failure. The robots are
+   * recovered in the background, the services report them as recovering in the meantime
+   */
+  if (boost::filesystem::exists(rr_catalog_backup_path))
   {
-    // local_configs_ = parseRobotConfigs(yaml_config);
-    local_configs_ = parseRobotConfigs(yaml_config, local_configs_);
-    // Debug what was added
-    for (auto& config : local_configs_)
-    {
-      TEMOTO_DEBUG_("Added robot: '%s'.", config->getName().c_str());
-      TEMOTO_DEBUG_STREAM_("CONFIG: \n" << config->toString());
-    }
-    // Advertise the parsed local robots
-    advertiseConfigs(local_configs_);
+    restoreState();
   }
+
+  /*
+   * Start the preloaded robots in warm standby and unload the standby robots which are idle
+   * or which the host has no resources for
+   */
+  preloadRobots();
+  standby_timer_ = nh_.createWallTimer(ros::WallDuration(STANDBY_EVICTION_PERIOD)
+  , &RobotManager::evictStandbyRobots
+  , this);
+
+  TEMOTO_INFO_("Robot manager is ready.");
 }
 
-void RobotManager::loadCb(RobotLoad::Request& req, RobotLoad::Response& res)
+RobotManager::~RobotManager()
 {
-  TEMOTO_INFO_("Starting to load robot '%s'...", req.robot_name.c_str());  
+  for (auto& restore_worker : restore_workers_)
+  {
+    restore_worker.join();
+  }
 
-  // Find the suitable robot and fill the process manager service request
-  auto config = findRobot(req.robot_name, local_configs_);
-  if (config)
+  /*
+   * The resources of the warm standby robots do not depend on the load queries, hence the
+   * RR does not unload them
+   */
+  standby_timer_.stop();
+  std::unordered_map<std::string, StandbyRobot> standby_robots;
   {
-    try
+    std::lock_guard<std::mutex> lock(standby_mutex_);
+    standby_robots.swap(standby_robots_);
+  }
+
+  // The preloads are interrupted and waited for outside of the lock
+  std::vector<RobotPtr> warm_robots;
+  for (auto& standby_robot : standby_robots)
+  {
+    if (standby_robot.second.isStarting())
     {
-      auto loaded_robot = std::make_shared<Robot>(config, res.temoto_metadata.request_id, resource_registrar_, *this);
-      loaded_robot->load();
-      loaded_robots_.push_back(loaded_robot);
-      TEMOTO_DEBUG_("Robot '%s' loaded.", config->getName().c_str());
+      standby_robot.second.robot->interruptLoad();
     }
-    catch (temoto_core::error::ErrorStack& error_stack)
+    try
     {
-      throw FORWARD_ERROR(error_stack);
+      standby_robot.second.started.get();
+      warm_robots.push_back(standby_robot.second.robot);
     }
     catch (...)
     {
-      config->adjustReliability(0.0);
-      advertiseConfig(config);
-      throw TEMOTO_ERRSTACK("Failed to load robot '" + req.robot_name + "'");
+      // The failed preload has unloaded its resources
     }
-    return;
   }
-  
-  // Try to find suitable candidate from remote managers
-  config = findRobot(req.robot_name, remote_configs_);
-  if (config)
   {
-    try
+    std::shared_lock<std::shared_timed_mutex> lock(registry_mutex_);
+    for (const auto& loaded_robot : loaded_robots_)
     {
-      RobotLoad load_robot_srvc;
-      load_robot_srvc.request.robot_name = req.robot_name;
-      TEMOTO_INFO_("RobotManager is forwarding request: '%s'", req.robot_name.c_str());
-
-      resource_registrar_.call<RobotLoad>(config->getTemotoNamespace() + "/" + srv_name::MANAGER
-      , srv_name::SERVER_LOAD
-      , load_robot_srvc);
+      if (loaded_robot.second->isLocal() && loaded_robot.second->getConfig()->isWarmStandby())
+      {
+        warm_robots.push_back(loaded_robot.second);
+      }
+    }
+  }
+  for (auto& warm_robot : warm_robots)
+  {
+    warm_robot->unloadResources();
+  }
 
-      TEMOTO_DEBUG_("Call to remote RobotManager was sucessful.");
-      auto loaded_robot = std::make_shared<Robot>(config, res.temoto_metadata.request_id, resource_registrar_, *this);
-      loaded_robots_.push_back(loaded_robot);
+  std::lock_guard<std::mutex> lock(async_goals_mutex_);
+  for (auto& goal : async_goals_)
+  {
+    goal.second->cancel_requested = true;
+    if (goal.second->cancel)
+    {
+      goal.second->cancel(*goal.second);
     }
-    catch(temoto_core::error::ErrorStack& error_stack)
+  }
+
+  for (auto& goal : async_goals_)
+  {
+    if (goal.second->worker.joinable())
     {
-      throw FORWARD_ERROR(error_stack);
+      goal.second->worker.join();
     }
-    catch (...)
+  }
+}
+
+void RobotManager::discoverRobotDescriptions(const std::string& config_base_path, bool hot_reload)
+{
+  // Without a cache directory every directory is listed on each start
+  std::string cache_dir = getTemotoCacheDir("description_cache");
+  std::string cache_file_path = cache_dir.empty()
+    ? ""
+    : cache_dir + "/" + DescriptionScanner::makeCacheFileName(temoto_core::common::getTemotoNamespace(), config_base_path);
+  description_scanner_ = std::make_unique<DescriptionScanner>(config_base_path, cache_file_path);
+
+  std::vector<std::string> description_files = description_scanner_->scan();
+  TEMOTO_DEBUG_("Found %lu robot description files.", description_files.size());
+
+  // The files are parsed in parallel, the results are merged in the order of the paths
+  std::vector<RobotConfigs> parsed_files(description_files.size());
+  std::vector<size_t> content_hashes(description_files.size());
+  std::atomic<size_t> next_file{0};
+  std::vector<std::future<void>> parsers;
+  for (unsigned int i = 0; i < std::max(1u, std::thread::hardware_concurrency()); i++)
+  {
+    parsers.push_back(std::async(std::launch::async, [&]
+    {
+      for (size_t file = next_file++; file < description_files.size(); file = next_file++)
+      {
+        parsed_files[file] = readRobotDescription(description_files[file], content_hashes[file]);
+      }
+    }));
+  }
+  for (auto& parser : parsers)
+  {
+    parser.get();
+  }
+
+  RobotConfigs added_configs;
+  for (unsigned int i = 0; i < description_files.size(); i++)
+  {
+    const RobotConfigs& configs = parsed_files[i];
+    RobotDescription& description = robot_descriptions_[description_files[i]];
+    description.content_hash = content_hashes[i];
+
+    std::unique_lock<std::shared_timed_mutex> lock(registry_mutex_);
+    for (const auto& config : configs)
     {
-      throw TEMOTO_ERRSTACK("Exception occured while creating Robot object.");
+      if (local_configs_.contains(config->getName()))
+      {
+        TEMOTO_WARN_("Ignoring duplicate of robot '%s'.", config->getName().c_str());
+        continue;
+      }
+      local_configs_.insert(config);
+      added_configs.push_back(config);
+      description.robot_names.push_back(config->getName());
+      TEMOTO_DEBUG_("Added robot: '%s'.", config->getName().c_str());
+      TEMOTO_DEBUG_STREAM_("CONFIG: \n" << config->toString());
     }
-    return;
   }
-  else
+
+  // Advertise all local robots at once
+  advertiseConfigs(added_configs);
+
+  if (hot_reload && !description_scanner_->startWatching(
+    std::bind(&RobotManager::reloadRobotDescription, this, std::placeholders::_1)))
   {
-    // no local nor remote robot found
-    throw TEMOTO_ERRSTACK("Robot manager did not find a suitable robot.");
+    TEMOTO_WARN_("Could not watch '%s' for changes of the robot descriptions.", config_base_path.c_str());
   }
 }
 
-void RobotManager::unloadCb(RobotLoad::Request& req, RobotLoad::Response& res)
+RobotConfigs RobotManager::readRobotDescription(const std::string& path_to_rob_description, size_t& content_hash)
 {
-  TEMOTO_DEBUG_("ROBOT '%s' unloading...", req.robot_name.c_str());
+  std::ifstream in(path_to_rob_description);
+  std::stringstream content;
+  content << in.rdbuf();
+  content_hash = std::hash<std::string>()(content.str());
 
-  // search for the robot based on its resource id, remove from map,
-  // and clear loaded_robot if the unloaded robot was active.
-  auto robot_it = std::find_if(loaded_robots_.begin()
-  , loaded_robots_.end()
-  , [&](const RobotManager::RobotPtr p) -> bool
-    {
-      return p->getName() == req.robot_name;
-    });
-  
-  if (robot_it != loaded_robots_.end())
+  try
   {
-    loaded_robots_.erase(robot_it);
-    TEMOTO_DEBUG_("ROBOT '%s' unloaded.", req.robot_name.c_str());
+    YAML::Node yaml_config = YAML::Load(content.str());
+    // Parse the Robots section
+    if (yaml_config["Robots"])
+    {
+      return parseRobotConfigs(yaml_config);
+    }
   }
-  else
+  catch (YAML::Exception& e)
   {
-    throw TEMOTO_ERRSTACK("Unable to unload the robot '" + req.robot_name + "'");
+    TEMOTO_WARN_("Unable to parse '%s': %s", path_to_rob_description.c_str(), e.what());
   }
+  return RobotConfigs();
 }
 
-void RobotManager::syncCb(const temoto_core::ConfigSync& msg, const PayloadType& payload)
+void RobotManager::reloadRobotDescription(const std::string& path_to_rob_description)
 {
-  if (msg.action == temoto_core::trr::sync_action::REQUEST_CONFIG)
+  size_t content_hash;
+  RobotConfigs configs = readRobotDescription(path_to_rob_description, content_hash);
+
+  // Editors often write a file several times, or without changing it
+  RobotDescription& description = robot_descriptions_[path_to_rob_description];
+  if (description.content_hash == content_hash)
   {
-    advertiseConfigs(local_configs_);
     return;
   }
+  description.content_hash = content_hash;
+  TEMOTO_INFO_("Reloading robot description '%s'.", path_to_rob_description.c_str());
 
-  if (msg.action == temoto_core::trr::sync_action::ADVERTISE_CONFIG)
+  RobotConfigs changed_configs;
   {
-    // Convert the config string to YAML tree and parse
-    YAML::Node yaml_config = YAML::Load(payload.data);
-    RobotConfigs configs = parseRobotConfigs(yaml_config);
-
-    // TODO hold remote stuff in a map or something keyed by namespace
-    for (auto& config : configs)
-    {
-      config->setTemotoNamespace(msg.temoto_namespace);
-    }
-
-    for (auto& config : configs)
+    std::unique_lock<std::shared_timed_mutex> lock(registry_mutex_);
+    for (const auto& config : configs)
     {
-      // Check if robot config has to be added or updated
-      auto it = std::find_if(remote_configs_.begin(), remote_configs_.end(),
-                             [&](const RobotConfigPtr& ri) -> bool { return *ri == *config; });
-      if (it != remote_configs_.end())
+      RobotConfigPtr known_config = local_configs_.findBest(config->getName());
+      if (known_config)
       {
-        TEMOTO_DEBUG_("Updating remote robot '%s' at '%s'.", config->getName().c_str(), config->getTemotoNamespace().c_str());
-        *it = config;  // overwrite found entry
+        bool same_file = std::find(description.robot_names.begin()
+        , description.robot_names.end()
+        , config->getName()) != description.robot_names.end();
+
+        if (!same_file)
+        {
+          TEMOTO_WARN_("Ignoring duplicate of robot '%s'.", config->getName().c_str());
+          continue;
+        }
+        // Robots which are loaded keep using the previous config until they are reloaded
+        config->setRevision(known_config->getRevision() + 1);
+        TEMOTO_DEBUG_("Updated robot: '%s'.", config->getName().c_str());
       }
       else
       {
-        TEMOTO_DEBUG_("Adding remote robot '%s' at '%s'.", config->getName().c_str(), config->getTemotoNamespace().c_str());
-        remote_configs_.push_back(config);
+        description.robot_names.push_back(config->getName());
+        TEMOTO_DEBUG_("Added robot: '%s'.", config->getName().c_str());
       }
+      local_configs_.insert(config);
+      changed_configs.push_back(config);
     }
   }
+  advertiseConfigs(changed_configs);
 }
 
-void RobotManager::advertiseConfig(RobotConfigPtr config)
-{
-  // publish all local robots
-  YAML::Node yaml_config;
-  yaml_config["Robots"].push_back(config->getYAMLConfig());
-  PayloadType payload;
-  payload.data = YAML::Dump(yaml_config);
-  config_syncer_.advertise(payload);
-}
-
-void RobotManager::advertiseConfigs(RobotConfigs configs)
+void RobotManager::loadCb(RobotLoad::Request& req, RobotLoad::Response& res)
 {
-  // publish all local robots
-  YAML::Node yaml_config;
-  for (auto& config : configs)
-  {
-    yaml_config["Robots"].push_back(config->getYAMLConfig());
-  }
+  ScopedSpan span(metrics_, req.robot_name, "srv/load");
+  TEMOTO_INFO_("Starting to load robot '%s'...", req.robot_name.c_str());  
 
-  // send to other managers if there is anything to send
-  if (yaml_config.size())
+  // Find the suitable robot and fill the process manager service request
+  bool is_local = false;
+  RobotConfigPtr config = selectRobot(req.robot_name, req.load_locally, is_local);
+  if (!config)
   {
-    PayloadType payload;
-    payload.data = YAML::Dump(yaml_config);
-    config_syncer_.advertise(payload);
+    // no local nor remote robot found
+    throw TEMOTO_ERRSTACK("Robot manager did not find a suitable robot.");
   }
-}
 
-RobotConfigs RobotManager::parseRobotConfigs(const YAML::Node& yaml_config)
-{
-  RobotConfigs configs;
+  /*
+   * The name is reserved until the robot is registered. A second instance of a robot would
+   * replace the first one, and the destructor of the replaced one deletes the parameters
+   * the other instance uses
+   */
+  const std::string robot_name = config->getName();
 
-  if (!yaml_config.IsMap())
+  // Waiting for the preload would block the thread which serves the load queries
+  if (is_local && isStandbyRobotStarting(robot_name))
   {
-    // TODO Throw
-    TEMOTO_WARN_("Unable to parse 'Robots' key from config.");
-    return configs;
+    throw TEMOTO_ERRSTACK("Robot '" + robot_name + "' is still being preloaded into warm standby.");
   }
-
-  YAML::Node robots_node = yaml_config["Robots"];
-  if (!robots_node.IsSequence())
   {
-    TEMOTO_WARN_("The given config does not contain sequence of robots.");
-    // TODO Throw
-    return configs;
-  }
-
-  TEMOTO_DEBUG_("Parsing %lu robots.", robots_node.size());
+    std::unique_lock<std::shared_timed_mutex> lock(registry_mutex_);
+    if (loaded_robots_.count(robot_name) || loading_robots_.count(robot_name))
+    {
+      throw TEMOTO_ERRSTACK("Robot '" + robot_name + "' is already loaded.");
+    }
 
-  // go over each robot node in the sequence
-  for (YAML::const_iterator node_it = robots_node.begin(); node_it != robots_node.end(); ++node_it)
-  {    
-    if (!node_it->IsMap())
+    // The robots of the restored RR catalog are already running, they are registered once recovered
+    if (recovering_robots_.count(robot_name))
     {
-      TEMOTO_ERROR("Unable to parse the robot config. Parameters in YAML have to be specified in "
-                   "key-value pairs.");
-      continue;
+      throw TEMOTO_ERRSTACK("Robot '" + robot_name + "' is being recovered.");
     }
+    loading_robots_.insert(robot_name);
+  }
+  LoadReservation reservation([this, robot_name]
+  {
+    std::unique_lock<std::shared_timed_mutex> lock(registry_mutex_);
+    loading_robots_.erase(robot_name);
+  });
 
+  if (is_local)
+  {
+    PendingLoad pending_load(pending_loads_);
     try
     {
-      RobotConfig config(*node_it, *this);
-      
-      // TEMOTO_INFO_STREAM_(config.toString());  //==ToErase==
-
-      if (std::count_if(configs.begin(), configs.end(),
-                        [&](const RobotConfigPtr& ri) { return *ri == config; }) == 0)
+      // The robot is loaded without holding the registry lock, so that the
+      // other robots remain accessible in the meantime
+      RobotPtr loaded_robot;
+      if (config->isWarmStandby())
       {
-        // OK, this is unique config, add it to the configs.
-        TEMOTO_INFO_("unique '%s'.", config.getName().c_str());
-        configs.emplace_back(std::make_shared<RobotConfig>(config));
+        loaded_robot = loadWarmRobot(config, res.temoto_metadata.request_id);
       }
       else
       {
-        TEMOTO_WARN_("Ignoring duplicate of robot '%s'.", config.getName().c_str());   
-        TEMOTO_INFO_("Ignoring duplicate of robot '%s'.", config.getName().c_str());     
+        loaded_robot = std::make_shared<Robot>(config, res.temoto_metadata.request_id, resource_registrar_, readiness_monitor_, urdf_cache_, metrics_, *this);
+        loaded_robot->load();
       }
+
+      std::unique_lock<std::shared_timed_mutex> lock(registry_mutex_);
+      loaded_robots_.emplace(robot_name, loaded_robot);
+      TEMOTO_DEBUG_("Robot '%s' loaded.", config->getName().c_str());
+    }
+    catch (temoto_core::error::ErrorStack& error_stack)
+    {
+      throw FORWARD_ERROR(error_stack);
     }
     catch (...)
     {
-      TEMOTO_WARN_("Failed to parse RobotConfig from config.");
-      continue;
+      {
+        std::unique_lock<std::shared_timed_mutex> lock(registry_mutex_);
+        config->adjustReliability(0.0);
+        config->bumpRevision();
+        local_configs_.updateReliability(config->getName());
+      }
+      advertiseReliability(config);
+      throw TEMOTO_ERRSTACK("Failed to load robot '" + req.robot_name + "'");
     }
+    return;
   }
-  return configs;
-}
-
-RobotConfigs RobotManager::parseRobotConfigs(const YAML::Node& yaml_config, RobotConfigs configs)
-{
-  // RobotConfigs configs;
+  
+  // The robot is loaded by a remote manager
+  try
+  {
+    RobotLoad load_robot_srvc;
+    load_robot_srvc.request.robot_name = config->getName();
+    load_robot_srvc.request.load_locally = true;
+    TEMOTO_INFO_("RobotManager is forwarding request: '%s'", load_robot_srvc.request.robot_name.c_str());
+
+    const std::string remote_namespace = config->getTemotoNamespace();
+    bool forwarded = false;
+    beginForwardedLoad(remote_namespace);
+    {
+      LoadReservation forwarded_load([&]{ endForwardedLoad(remote_namespace, forwarded); });
+      resource_registrar_.call<RobotLoad>(remote_namespace + "/" + srv_name::MANAGER
+      , srv_name::SERVER_LOAD
+      , load_robot_srvc);
+      forwarded = true;
+    }
+
+    TEMOTO_DEBUG_("Call to remote RobotManager was sucessful.");
+    auto loaded_robot = std::make_shared<Robot>(config, res.temoto_metadata.request_id, resource_registrar_, readiness_monitor_, urdf_cache_, metrics_, *this);
+
+    std::unique_lock<std::shared_timed_mutex> lock(registry_mutex_);
+    loaded_robots_.emplace(robot_name, loaded_robot);
+  }
+  catch(temoto_core::error::ErrorStack& error_stack)
+  {
+    throw FORWARD_ERROR(error_stack);
+  }
+  catch (...)
+  {
+    throw TEMOTO_ERRSTACK("Exception occured while creating Robot object.");
+  }
+}
+
+void RobotManager::unloadCb(RobotLoad::Request& req, RobotLoad::Response& res)
+{
+  ScopedSpan span(metrics_, req.robot_name, "srv/unload");
+  TEMOTO_DEBUG_("ROBOT '%s' unloading...", req.robot_name.c_str());
+
+  // search for the robot based on its resource id, remove from map,
+  // and clear loaded_robot if the unloaded robot was active.
+  RobotPtr unloaded_robot;
+  {
+    std::unique_lock<std::shared_timed_mutex> lock(registry_mutex_);
+    auto robot_it = loaded_robots_.find(req.robot_name);
+    if (robot_it == loaded_robots_.end())
+    {
+      throw TEMOTO_ERRSTACK("Unable to unload the robot '" + req.robot_name + "'");
+    }
+    unloaded_robot = robot_it->second;
+    loaded_robots_.erase(robot_it);
+  }
+
+  if (unloaded_robot->isLocal() && unloaded_robot->getConfig()->isWarmStandby())
+  {
+    if (moveToStandby(unloaded_robot))
+    {
+      TEMOTO_DEBUG_("ROBOT '%s' is in warm standby.", req.robot_name.c_str());
+      return;
+    }
+    unloaded_robot->unloadResources();
+  }
+
+  /*
+   * The robot is destroyed outside of the registry lock. If a command is still
+   * using the robot, then it is destroyed once the command has finished
+   */
+  unloaded_robot.reset();
+  TEMOTO_DEBUG_("ROBOT '%s' unloaded.", req.robot_name.c_str());
+}
+
+RobotManager::RobotPtr RobotManager::loadWarmRobot(RobotConfigPtr config, const std::string& resource_id)
+{
+  RobotPtr robot;
+  {
+    std::lock_guard<std::mutex> lock(standby_mutex_);
+    auto standby_it = standby_robots_.find(config->getName());
+    if (standby_it != standby_robots_.end())
+    {
+      try
+      {
+        standby_it->second.started.get();
+        robot = standby_it->second.robot;
+      }
+      catch (...)
+      {
+        TEMOTO_WARN_("Preloading robot '%s' failed, loading it again.", config->getName().c_str());
+      }
+      standby_robots_.erase(standby_it);
+    }
+  }
+
+  // The stack of a failed robot, or of a config which has been reloaded since, is replaced
+  if (robot && (robot->getConfig() != config || robot->isInError()))
+  {
+    robot->unloadResources();
+    robot.reset();
+  }
+
+  if (robot)
+  {
+    TEMOTO_DEBUG_("Re-attaching robot '%s' from warm standby.", config->getName().c_str());
+    robot->resume();
+  }
+  else
+  {
+    StandbyRobot started_robot = startWarmRobot(config, false);
+    started_robot.started.get();
+    robot = started_robot.robot;
+  }
+  robot->setResourceId(resource_id);
+  return robot;
+}
+
+RobotManager::StandbyRobot RobotManager::startWarmRobot(RobotConfigPtr config, bool standby)
+{
+  // The robot is created up front, so that its loading can be interrupted
+  auto robot = std::make_shared<Robot>(config, "", resource_registrar_, readiness_monitor_, urdf_cache_, metrics_, *this);
+  std::shared_future<void> started = std::async(std::launch::async, [robot, standby]
+  {
+    try
+    {
+      robot->load();
+    }
+    catch (...)
+    {
+      robot->unloadResources();
+      throw;
+    }
+    if (standby)
+    {
+      robot->standby();
+    }
+  }).share();
+  return StandbyRobot{robot, started, ros::WallTime::now()};
+}
+
+void RobotManager::unloadOrphanedStandbyResources()
+{
+  RobotConfigs warm_configs;
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(registry_mutex_);
+    for (const auto& config : local_configs_.getConfigs())
+    {
+      if (config->isWarmStandby() && !recovering_robots_.count(config->getName()))
+      {
+        warm_configs.push_back(config);
+      }
+    }
+  }
+
+  for (const auto& config : warm_configs)
+  {
+    auto er_queries = resource_registrar_.getRosChildQueries<temoto_er_manager::LoadExtResource>(
+      Robot::getStandbyResourceId(config)
+    , temoto_er_manager::srv_name::SERVER);
+
+    for (const auto& er_query : er_queries)
+    {
+      TEMOTO_DEBUG_("Unloading the orphaned standby resource '%s' of robot '%s'."
+      , er_query.second.request.executable.c_str()
+      , config->getName().c_str());
+      try
+      {
+        resource_registrar_.unload(temoto_er_manager::srv_name::MANAGER
+        , er_query.second.response.temoto_metadata.request_id);
+      }
+      catch (const resource_registrar::TemotoErrorStack& e)
+      {
+        TEMOTO_WARN_("Could not unload '%s' of %s: %s", er_query.second.request.executable.c_str()
+        , config->getName().c_str()
+        , e.what());
+      }
+    }
+  }
+}
+
+bool RobotManager::moveToStandby(RobotPtr robot)
+{
+  if (robot->isInError() || isStandbyBudgetExceeded())
+  {
+    return false;
+  }
+  robot->standby();
+
+  std::promise<void> started;
+  started.set_value();
+
+  std::lock_guard<std::mutex> lock(standby_mutex_);
+  return standby_robots_.emplace(robot->getName()
+  , StandbyRobot{robot, started.get_future().share(), ros::WallTime::now()}).second;
+}
+
+bool RobotManager::hasStandbyRobot(const std::string& robot_name) const
+{
+  std::lock_guard<std::mutex> lock(standby_mutex_);
+  return standby_robots_.count(robot_name);
+}
+
+bool RobotManager::isStandbyRobotStarting(const std::string& robot_name) const
+{
+  std::lock_guard<std::mutex> lock(standby_mutex_);
+  auto standby_it = standby_robots_.find(robot_name);
+  return standby_it != standby_robots_.end() && standby_it->second.isStarting();
+}
+
+void RobotManager::preloadRobots()
+{
+  RobotConfigs preloaded_configs;
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(registry_mutex_);
+    for (const auto& config : local_configs_.getConfigs())
+    {
+      if (config->isWarmStandby() && config->isPreloaded() && !recovering_robots_.count(config->getName()))
+      {
+        preloaded_configs.push_back(config);
+      }
+    }
+  }
+
+  // The robots are created outside of the lock
+  for (const auto& config : preloaded_configs)
+  {
+    TEMOTO_INFO_("Preloading robot '%s' into warm standby.", config->getName().c_str());
+    StandbyRobot standby_robot = startWarmRobot(config, true);
+
+    std::lock_guard<std::mutex> lock(standby_mutex_);
+    standby_robots_[config->getName()] = standby_robot;
+  }
+}
+
+bool RobotManager::isStandbyBudgetExceeded() const
+{
+  double available_memory = getAvailableMemory();
+  return (available_memory >= 0.0 && available_memory < warm_standby_config_.min_available_memory)
+    || getCpuLoad() > warm_standby_config_.max_cpu_load;
+}
+
+void RobotManager::evictStandbyRobots(const ros::WallTimerEvent& event)
+{
+  bool budget_exceeded = isStandbyBudgetExceeded();
+  std::vector<RobotPtr> evicted_robots;
+  {
+    std::lock_guard<std::mutex> lock(standby_mutex_);
+    ros::WallTime now = ros::WallTime::now();
+    auto longest_idle_it = standby_robots_.end();
+    for (auto standby_it = standby_robots_.begin(); standby_it != standby_robots_.end();)
+    {
+      // The robots which are still being preloaded are left alone
+      if (standby_it->second.isStarting())
+      {
+        ++standby_it;
+        continue;
+      }
+
+      RobotPtr robot = standby_it->second.robot;
+      try
+      {
+        standby_it->second.started.get();
+      }
+      catch (...)
+      {
+        TEMOTO_WARN_("Preloading robot '%s' failed.", standby_it->first.c_str());
+        standby_it = standby_robots_.erase(standby_it);
+        continue;
+      }
+
+      double idle_time = (now - standby_it->second.idle_since).toSec();
+      double idle_timeout = robot->getConfig()->getStandbyIdleTimeout();
+      if (robot->isInError() || (idle_timeout > 0.0 && idle_time > idle_timeout))
+      {
+        TEMOTO_INFO_("Unloading robot '%s' from warm standby after %.0f s.", standby_it->first.c_str(), idle_time);
+        evicted_robots.push_back(robot);
+        standby_it = standby_robots_.erase(standby_it);
+        continue;
+      }
+
+      if (longest_idle_it == standby_robots_.end() || standby_it->second.idle_since < longest_idle_it->second.idle_since)
+      {
+        longest_idle_it = standby_it;
+      }
+      ++standby_it;
+    }
+
+    // One robot at a time, so that the host can settle before the next one is unloaded
+    if (budget_exceeded && evicted_robots.empty() && longest_idle_it != standby_robots_.end())
+    {
+      TEMOTO_INFO_("The host is short of resources, unloading robot '%s' from warm standby."
+      , longest_idle_it->first.c_str());
+      evicted_robots.push_back(longest_idle_it->second.robot);
+      standby_robots_.erase(longest_idle_it);
+    }
+  }
+
+  // The resources are unloaded outside of the lock, the robots are destroyed after
+  for (auto& evicted_robot : evicted_robots)
+  {
+    evicted_robot->unloadResources();
+  }
+}
+
+void RobotManager::syncCb(const temoto_core::ConfigSync& msg, const PayloadType& payload)
+{
+  ScopedSpan span(metrics_, msg.temoto_namespace, "sync");
+  bool new_manager = false;
+  {
+    std::unique_lock<std::shared_timed_mutex> lock(registry_mutex_);
+    new_manager = remote_configs_.touch(msg.temoto_namespace);
+  }
+
+  /*
+   * A manager requests the configs of all managers when it starts. A restart is detected by
+   * the epoch of its advertisements, hence the connections to it are kept
+   */
+  if (msg.action == temoto_core::trr::sync_action::REQUEST_CONFIG)
+  {
+    advertiseLocalConfigs();
+    if (new_manager)
+    {
+      requestConfigs(msg.temoto_namespace);
+    }
+    return;
+  }
+
+  if (msg.action != temoto_core::trr::sync_action::ADVERTISE_CONFIG)
+  {
+    return;
+  }
+
+  RobotConfigSync config_sync;
+  try
+  {
+    if (!decodeConfigSync(payload, config_sync))
+    {
+      applyLegacyPayload(msg.temoto_namespace, payload.data);
+      return;
+    }
+  }
+  catch (const ros::serialization::StreamOverrunException&)
+  {
+    TEMOTO_WARN_("Malformed config sync payload from '%s'.", msg.temoto_namespace.c_str());
+    return;
+  }
+  applyConfigDelta(msg.temoto_namespace, config_sync);
+
+  const std::string& temoto_namespace = temoto_core::common::getTemotoNamespace();
+  if (std::find(config_sync.config_requests.begin(), config_sync.config_requests.end(), temoto_namespace)
+    != config_sync.config_requests.end())
+  {
+    advertiseLocalConfigs();
+  }
+
+  // The configs of a manager which was not known are completed, whichever message came first
+  if (new_manager && !config_sync.complete)
+  {
+    TEMOTO_DEBUG_("Manager at '%s' is not known, requesting its robots.", msg.temoto_namespace.c_str());
+    requestConfigs(msg.temoto_namespace);
+  }
+}
+
+void RobotManager::applyLegacyPayload(const std::string& temoto_namespace, const std::string& payload)
+{
+  YAML::Node yaml_config;
+  try
+  {
+    yaml_config = YAML::Load(payload);
+  }
+  catch (const YAML::Exception& e)
+  {
+    TEMOTO_WARN_("Unable to parse the config sync payload from '%s': %s", temoto_namespace.c_str(), e.what());
+    return;
+  }
+
+  if (!yaml_config.IsMap() || !yaml_config[LEGACY_SYNC_EPOCH])
+  {
+    // All configs of the manager, which replace the known ones
+    RobotConfigs configs = parseRobotConfigs(yaml_config);
+    std::unique_lock<std::shared_timed_mutex> lock(registry_mutex_);
+    for (auto& config : configs)
+    {
+      config->setTemotoNamespace(temoto_namespace);
+      remote_configs_.insert(config);
+    }
+    TEMOTO_DEBUG_("Got %lu robots from '%s' in the legacy format.", configs.size(), temoto_namespace.c_str());
+    return;
+  }
+
+  RobotConfigSync config_sync;
+  try
+  {
+    config_sync.epoch = yaml_config[LEGACY_SYNC_EPOCH].as<uint64_t>();
+    for (const auto& entry : yaml_config[LEGACY_SYNC_CONFIGS])
+    {
+      RobotConfigEntry config_entry;
+      config_entry.robot_name = entry["config"]["robot_name"].as<std::string>("");
+      config_entry.revision = entry["revision"].as<unsigned int>(0);
+      config_entry.reliability = entry["reliability"].as<float>();
+      config_entry.yaml_config = YAML::Dump(entry["config"]);
+      config_sync.configs.push_back(config_entry);
+    }
+    for (const auto& entry : yaml_config[LEGACY_SYNC_RELIABILITIES])
+    {
+      RobotReliability reliability_entry;
+      reliability_entry.robot_name = entry["robot_name"].as<std::string>("");
+      reliability_entry.revision = entry["revision"].as<unsigned int>(0);
+      reliability_entry.reliability = entry["reliability"].as<float>();
+      config_sync.reliabilities.push_back(reliability_entry);
+    }
+  }
+  catch (const YAML::Exception& e)
+  {
+    TEMOTO_WARN_("Malformed legacy config sync payload from '%s': %s", temoto_namespace.c_str(), e.what());
+    return;
+  }
+  applyConfigDelta(temoto_namespace, config_sync);
+}
+
+void RobotManager::applyConfigDelta(const std::string& temoto_namespace, const RobotConfigSync& payload)
+{
+  std::unique_lock<std::shared_timed_mutex> lock(registry_mutex_);
+
+  uint64_t known_epoch = 0;
+  bool restarted = remote_configs_.getEpoch(temoto_namespace, known_epoch) && known_epoch != payload.epoch;
+  size_t erased_count = 0;
+  if (remote_configs_.updateEpoch(temoto_namespace, payload.epoch, erased_count) && restarted)
+  {
+    // The manager was restarted, it advertises all of its robots again
+    TEMOTO_DEBUG_("Manager at '%s' was restarted, discarded %lu of its robots.", temoto_namespace.c_str(), erased_count);
+  }
+
+  for (const auto& entry : payload.configs)
+  {
+    RobotConfigPtr known_config = remote_configs_.find(temoto_namespace, entry.robot_name);
+    if (known_config && known_config->getRevision() >= entry.revision)
+    {
+      continue;
+    }
+
+    // Only the configs which have changed are parsed, and their features only once loaded
+    RobotConfigPtr config;
+    try
+    {
+      config = std::make_shared<RobotConfig>(YAML::Load(entry.yaml_config), *this, false);
+    }
+    catch (...)
+    {
+      TEMOTO_WARN_("Failed to parse the config of remote robot '%s'.", entry.robot_name.c_str());
+      continue;
+    }
+    config->setTemotoNamespace(temoto_namespace);
+    config->setRevision(entry.revision);
+    config->resetReliability(entry.reliability);
+
+    remote_configs_.insert(config);
+    TEMOTO_DEBUG_("%s remote robot '%s' at '%s' (revision %u)."
+    , known_config ? "Updating" : "Adding"
+    , entry.robot_name.c_str()
+    , temoto_namespace.c_str()
+    , entry.revision);
+  }
+
+  for (const auto& entry : payload.reliabilities)
+  {
+    RobotConfigPtr known_config = remote_configs_.find(temoto_namespace, entry.robot_name);
+    if (!known_config || known_config->getRevision() >= entry.revision)
+    {
+      continue;
+    }
+
+    known_config->resetReliability(entry.reliability);
+    known_config->setRevision(entry.revision);
+    remote_configs_.updateReliability(entry.robot_name);
+    TEMOTO_DEBUG_("Reliability of remote robot '%s' at '%s' is %f."
+    , entry.robot_name.c_str()
+    , temoto_namespace.c_str()
+    , known_config->getReliability());
+  }
+  lock.unlock();
+
+  // The connections to the previous instance of the manager are not valid anymore
+  if (restarted)
+  {
+    remote_clients_.invalidate(temoto_namespace);
+  }
+}
+
+void RobotManager::advertiseConfig(RobotConfigPtr config)
+{
+  advertiseConfigs({config});
+}
+
+void RobotManager::advertiseConfigs(RobotConfigs configs, bool complete)
+{
+  // send to other managers if there is anything to send
+  if (configs.empty() && !complete)
+  {
+    return;
+  }
+
+  RobotConfigSync config_sync;
+  config_sync.epoch = sync_epoch_;
+  config_sync.complete = complete;
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(registry_mutex_);
+    for (auto& config : configs)
+    {
+      RobotConfigEntry entry;
+      entry.robot_name = config->getName();
+      entry.revision = config->getRevision();
+      entry.reliability = config->getReliability();
+      entry.yaml_config = config->getYamlConfigString();
+      config_sync.configs.push_back(entry);
+    }
+  }
+  advertiseConfigSync(config_sync);
+}
+
+void RobotManager::advertiseLocalConfigs()
+{
+  RobotConfigs local_configs;
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(registry_mutex_);
+    local_configs = local_configs_.getConfigs();
+  }
+  advertiseConfigs(local_configs, true);
+}
+
+void RobotManager::requestConfigs(const std::string& temoto_namespace)
+{
+  RobotConfigSync config_sync;
+  config_sync.epoch = sync_epoch_;
+  config_sync.config_requests.push_back(temoto_namespace);
+  advertiseConfigSync(config_sync);
+}
+
+void RobotManager::advertiseReliability(RobotConfigPtr config)
+{
+  RobotConfigSync config_sync;
+  config_sync.epoch = sync_epoch_;
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(registry_mutex_);
+    RobotReliability entry;
+    entry.robot_name = config->getName();
+    entry.revision = config->getRevision();
+    entry.reliability = config->getReliability();
+    config_sync.reliabilities.push_back(entry);
+  }
+  advertiseConfigSync(config_sync);
+}
+
+void RobotManager::advertiseConfigSync(const RobotConfigSync& config_sync)
+{
+  config_syncer_.advertise(encodeConfigSync(config_sync));
+}
+
+RobotConfigs RobotManager::parseRobotConfigs(const YAML::Node& yaml_config)
+{
+  RobotConfigs configs;
 
   if (!yaml_config.IsMap())
   {
@@ -378,7 +1195,7 @@ RobotConfigs RobotManager::parseRobotConfigs(const YAML::Node& yaml_config, Robo
 
   // go over each robot node in the sequence
   for (YAML::const_iterator node_it = robots_node.begin(); node_it != robots_node.end(); ++node_it)
-  {
+  {    
     if (!node_it->IsMap())
     {
       TEMOTO_ERROR("Unable to parse the robot config. Parameters in YAML have to be specified in "
@@ -390,31 +1207,20 @@ RobotConfigs RobotManager::parseRobotConfigs(const YAML::Node& yaml_config, Robo
     {
       RobotConfig config(*node_it, *this);
       
-      bool compare = false;
-      for (const auto& config_compare : configs)
-      {
-        if (config.getName() == config_compare->getName())
-        {
-          TEMOTO_INFO_STREAM_("Equal");
-          compare = true;
-          TEMOTO_INFO_STREAM_(config.getName().c_str());          
-        }
-      }    
-      
-      if (std::count_if(configs.begin()
-      , configs.end()
-      , [&](const RobotConfigPtr& ri) { return *ri == config; }) == 0 && compare==false )                       
+      // TEMOTO_INFO_STREAM_(config.toString());  //==ToErase==
+
+      if (std::count_if(configs.begin(), configs.end(),
+                        [&](const RobotConfigPtr& ri) { return *ri == config; }) == 0)
       {
         // OK, this is unique config, add it to the configs.
         TEMOTO_INFO_("unique '%s'.", config.getName().c_str());
-        configs.emplace_back(std::make_shared<RobotConfig>(config));        
+        configs.emplace_back(std::make_shared<RobotConfig>(config));
       }
       else
       {
-        TEMOTO_WARN_("Ignoring duplicate of robot '%s'.", config.getName().c_str());
-        TEMOTO_INFO_("Ignoring duplicate of robot '%s'.", config.getName().c_str());
+        TEMOTO_WARN_("Ignoring duplicate of robot '%s'.", config.getName().c_str());   
+        TEMOTO_INFO_("Ignoring duplicate of robot '%s'.", config.getName().c_str());     
       }
-      compare=false;
     }
     catch (...)
     {
@@ -428,6 +1234,7 @@ RobotConfigs RobotManager::parseRobotConfigs(const YAML::Node& yaml_config, Robo
 bool RobotManager::planManipulationPathCb(RobotPlanManipulation::Request& req, RobotPlanManipulation::Response& res)
 try
 {
+  ScopedSpan span(metrics_, req.robot_name, "srv/plan");
   RobotPtr loaded_robot;
   loaded_robot = findLoadedRobot(req.robot_name);
   TEMOTO_DEBUG_STREAM_(loaded_robot->getName().c_str());
@@ -437,13 +1244,34 @@ try
     TEMOTO_DEBUG_STREAM_("Creating a manipulation path for robot '" << loaded_robot->getName() 
       << " with goal pose: " << req.target_pose <<std::endl);
 
-    if (req.use_named_target)
+    if (req.planning_mode == RobotPlanManipulation::Request::CARTESIAN)
+    {
+      std::vector<geometry_msgs::Pose> waypoints = req.cartesian_waypoints;
+      if (waypoints.empty())
+      {
+        waypoints.push_back(req.target_pose.pose);
+      }
+      res.plan_id = loaded_robot->planCartesianPath(req.planning_group
+      , waypoints
+      , req.eef_step
+      , req.jump_threshold
+      , req.start_plan_id);
+    }
+    else if (req.planning_mode == RobotPlanManipulation::Request::JOINT && req.use_named_target)
+    {
+      res.plan_id = loaded_robot->planJointPath(req.planning_group, req.named_target, req.start_plan_id);
+    }
+    else if (req.planning_mode == RobotPlanManipulation::Request::JOINT)
+    {
+      res.plan_id = loaded_robot->planJointPath(req.planning_group, req.joint_names, req.joint_values, req.start_plan_id);
+    }
+    else if (req.use_named_target)
     {
-      loaded_robot->planManipulationPath(req.planning_group, req.named_target);
+      res.plan_id = loaded_robot->planManipulationPath(req.planning_group, req.named_target, req.start_plan_id);
     }
     else
     {
-      loaded_robot->planManipulationPath(req.planning_group, req.target_pose);        
+      res.plan_id = loaded_robot->planManipulationPath(req.planning_group, req.target_pose, req.start_plan_id);
     }      
 
     TEMOTO_DEBUG_("Done planning.");
@@ -455,12 +1283,13 @@ try
       + srv_name::SERVER_PLAN;
     TEMOTO_DEBUG_STREAM_("Forwarding the planning request to remote robot manager at '" << topic << "'.");
 
-    ros::ServiceClient client_plan = nh_.serviceClient<RobotPlanManipulation>(topic);
     RobotPlanManipulation fwd_plan_srvc;
     fwd_plan_srvc.request = req;
     fwd_plan_srvc.response = res;
 
-    if (client_plan.call(fwd_plan_srvc))
+    if (remote_clients_.call(loaded_robot->getConfig()->getTemotoNamespace()
+    , srv_name::SERVER_PLAN
+    , fwd_plan_srvc))
     {
       res = fwd_plan_srvc.response;
     }
@@ -469,7 +1298,41 @@ try
       throw TEMOTO_ERRSTACK("Call to remote RobotManager service failed.");
     }
   }
-  res.success = true;
+  res.success = true;
+  return true;
+}
+catch(temoto_core::error::ErrorStack& error_stack)
+{
+  res.success = false;
+  return true;
+}
+
+bool RobotManager::planManipulationBatchCb(RobotPlanManipulationBatch::Request& req, RobotPlanManipulationBatch::Response& res)
+try
+{
+  ScopedSpan span(metrics_, req.robot_name, "srv/plan_batch");
+  RobotPtr loaded_robot = findLoadedRobot(req.robot_name);
+  if (loaded_robot->isLocal())
+  {
+    TEMOTO_DEBUG_STREAM_("Planning " << req.goals.size() << " goals for robot '" << loaded_robot->getName() << "' ...");
+    res.results = loaded_robot->planManipulationPaths(req.goals);
+    res.success = true;
+  }
+  else
+  {
+    TEMOTO_DEBUG_STREAM_("Forwarding the batch planning request to remote robot manager at '"
+      << loaded_robot->getConfig()->getTemotoNamespace() << "'.");
+
+    RobotPlanManipulationBatch fwd_plan_srvc;
+    fwd_plan_srvc.request = req;
+    if (!remote_clients_.call(loaded_robot->getConfig()->getTemotoNamespace()
+    , srv_name::SERVER_PLAN_BATCH
+    , fwd_plan_srvc))
+    {
+      throw TEMOTO_ERRSTACK("Call to remote RobotManager service failed.");
+    }
+    res = fwd_plan_srvc.response;
+  }
   return true;
 }
 catch(temoto_core::error::ErrorStack& error_stack)
@@ -477,18 +1340,24 @@ catch(temoto_core::error::ErrorStack& error_stack)
   res.success = false;
   return true;
 }
-
+catch(const resource_registrar::TemotoErrorStack &e)
+{
+  TEMOTO_ERROR_STREAM(e.what());
+  res.success = false;
+  return true;
+}
 
 bool RobotManager::execManipulationPathCb(RobotExecutePlan::Request& req, RobotExecutePlan::Response& res)
 try
 {
+  ScopedSpan span(metrics_, req.robot_name, "srv/execute");
   RobotPtr loaded_robot;
   loaded_robot = findLoadedRobot(req.robot_name);
 
   if (loaded_robot->isLocal())
   {
     TEMOTO_DEBUG_STREAM_("Executing a manipulation path for robot '" << loaded_robot->getName() << " ...");
-    loaded_robot->executeManipulationPath();
+    loaded_robot->executeManipulationPath(req.plan_id);
     TEMOTO_DEBUG_("Done executing.");
   }
   else
@@ -498,12 +1367,13 @@ try
       + srv_name::SERVER_EXECUTE;
     TEMOTO_DEBUG_STREAM_("Forwarding the execution request to remote robot manager at '" << topic << "'.");
 
-    ros::ServiceClient client_exec = nh_.serviceClient<RobotExecutePlan>(topic);
     RobotExecutePlan fwd_exec_srvc;
     fwd_exec_srvc.request = req;
     fwd_exec_srvc.response = res;
 
-    if (client_exec.call(fwd_exec_srvc))
+    if (remote_clients_.call(loaded_robot->getConfig()->getTemotoNamespace()
+    , srv_name::SERVER_EXECUTE
+    , fwd_exec_srvc))
     {
       TEMOTO_DEBUG_("Call to remote RobotManager was sucessful.");
       res = fwd_exec_srvc.response;
@@ -521,10 +1391,70 @@ catch(temoto_core::error::ErrorStack& error_stack)
   res.success = false;
   return true;
 }
+catch(const resource_registrar::TemotoErrorStack &e)
+{
+  TEMOTO_ERROR_STREAM(e.what());
+  res.success = false;
+  return true;
+}
+
+bool RobotManager::execManipulationPathAsyncCb(RobotExecutePlanAsync::Request& req, RobotExecutePlanAsync::Response& res)
+try
+{
+  ScopedSpan span(metrics_, req.robot_name, "srv/execute_async");
+  RobotPtr loaded_robot = findLoadedRobot(req.robot_name);
+  RobotExecutePlan exec_srvc;
+  exec_srvc.request.robot_name = req.robot_name;
+  exec_srvc.request.plan_id = req.plan_id;
+
+  // Stopping is possible only if the robot is controlled by this manager
+  std::function<void(const AsyncGoal&)> cancel;
+  if (loaded_robot->isLocal())
+  {
+    cancel = [loaded_robot](const AsyncGoal&){ loaded_robot->stopManipulation(); };
+  }
+
+  res.goal_id = startAsyncGoal(req.goal_id
+  , req.robot_name
+  , goal_type::MANIPULATION
+  , [this, exec_srvc](AsyncGoal&) mutable
+    {
+      execManipulationPathCb(exec_srvc.request, exec_srvc.response);
+      return static_cast<bool>(exec_srvc.response.success);
+    }
+  , cancel);
+
+  res.success = true;
+  return true;
+}
+catch(temoto_core::error::ErrorStack& error_stack)
+{
+  res.success = false;
+  return true;
+}
+catch(const resource_registrar::TemotoErrorStack &e)
+{
+  TEMOTO_ERROR_STREAM(e.what());
+  res.success = false;
+  return true;
+}
+catch(const std::exception& e)
+{
+  TEMOTO_WARN_STREAM_("Failed to start the goal for robot '" << req.robot_name << "': " << e.what());
+  res.success = false;
+  return true;
+}
+catch(...)
+{
+  TEMOTO_WARN_STREAM_("Failed to start the goal for robot '" << req.robot_name << "'.");
+  res.success = false;
+  return true;
+}
 
 bool RobotManager::getVizInfoCb(RobotGetVizInfo::Request& req, RobotGetVizInfo::Response& res)
 try
 {
+  ScopedSpan span(metrics_, req.robot_name, "srv/get_visualization_info");
   TEMOTO_DEBUG_STREAM_("Getting the visualization information of '" << req.robot_name << " ...");
   RobotPtr loaded_robot = findLoadedRobot(req.robot_name);
   res.info = loaded_robot->getVizInfo();
@@ -540,6 +1470,7 @@ catch(temoto_core::error::ErrorStack& error_stack)
 bool RobotManager::getManipulationTargetCb(RobotGetTarget::Request& req, RobotGetTarget::Response& res)
 try
 {
+  ScopedSpan span(metrics_, req.robot_name, "srv/get_manipulation_target");
   TEMOTO_DEBUG_STREAM_("Getting the manipulation target of '" << req.robot_name << " ...");
   RobotPtr loaded_robot = findLoadedRobot(req.robot_name);
 
@@ -547,17 +1478,22 @@ try
   {    
     res.pose = loaded_robot->getManipulationTarget();
   }
+  else if (getRemoteManipulationTarget(loaded_robot->getConfig()->getTemotoNamespace(), req.robot_name, res.pose))
+  {
+    TEMOTO_DEBUG_("Got the manipulation target from the relayed robot status.");
+  }
   else
   {
     std::string topic = "/" + loaded_robot->getConfig()->getTemotoNamespace() + "/" 
       + srv_name::SERVER_GET_MANIPULATION_TARGET;
     TEMOTO_DEBUG_STREAM_("Forwarding the request to remote robot manager at '" << topic << "'.");
 
-    ros::ServiceClient client_mode = nh_.serviceClient<RobotGetTarget>(topic);
     RobotGetTarget fwd_get_target_srvc;
     fwd_get_target_srvc.request = req;
     fwd_get_target_srvc.response = res;
-    if (client_mode.call(fwd_get_target_srvc))
+    if (remote_clients_.call(loaded_robot->getConfig()->getTemotoNamespace()
+    , srv_name::SERVER_GET_MANIPULATION_TARGET
+    , fwd_get_target_srvc))
     {
       TEMOTO_DEBUG_("Call to remote RobotManager was sucessful.");
       res = fwd_get_target_srvc.response;
@@ -576,48 +1512,454 @@ catch(temoto_core::error::ErrorStack& error_stack)
   return true;
 }
 
-bool RobotManager::goalNavigationCb(RobotNavigationGoal::Request& req, RobotNavigationGoal::Response& res)
-try
-{
-  RobotPtr loaded_robot = findLoadedRobot(req.robot_name);
-  if (loaded_robot->isLocal())
+bool RobotManager::goalNavigationCb(RobotNavigationGoal::Request& req, RobotNavigationGoal::Response& res)
+try
+{
+  ScopedSpan span(metrics_, req.robot_name, "srv/navigation_goal");
+  RobotPtr loaded_robot = findLoadedRobot(req.robot_name);
+  if (loaded_robot->isLocal())
+  {
+    TEMOTO_DEBUG_STREAM_("Navigating '" << req.robot_name << " to pose: " << req.target_pose << " ...");
+    loaded_robot->goalNavigation(req.reference_frame, req.target_pose);  // The robot would move with respect to this coordinate frame
+    res.success = true;   
+  }
+  else
+  {
+    std::string topic = "/" + loaded_robot->getConfig()->getTemotoNamespace() + "/"
+      + srv_name::SERVER_NAVIGATION_GOAL;
+    TEMOTO_DEBUG_STREAM_("Forwarding the request to remote robot manager at '" << topic << "'.");
+
+    RobotNavigationGoal fwd_goal_srvc;
+    fwd_goal_srvc.request = req;
+    fwd_goal_srvc.response = res;
+    if (remote_clients_.call(loaded_robot->getConfig()->getTemotoNamespace()
+    , srv_name::SERVER_NAVIGATION_GOAL
+    , fwd_goal_srvc))
+    {
+      res = fwd_goal_srvc.response;
+    }
+    else
+    {
+      throw TEMOTO_ERRSTACK("Call to remote RobotManager service failed.");
+    }
+  }
+  res.success = true;
+  return true;  
+}
+catch(temoto_core::error::ErrorStack& error_stack)
+{
+  res.success = false;
+  return true;
+}
+catch(const resource_registrar::TemotoErrorStack &e)
+{
+  TEMOTO_ERROR_STREAM(e.what());
+  res.success = false;
+  return true;
+}
+
+bool RobotManager::goalNavigationAsyncCb(RobotNavigationGoalAsync::Request& req, RobotNavigationGoalAsync::Response& res)
+try
+{
+  ScopedSpan span(metrics_, req.robot_name, "srv/navigation_goal_async");
+  RobotPtr loaded_robot = findLoadedRobot(req.robot_name);
+  RobotNavigationGoal goal_srvc;
+  goal_srvc.request.robot_name = req.robot_name;
+  goal_srvc.request.reference_frame = req.reference_frame;
+  goal_srvc.request.target_pose = req.target_pose;
+
+  // Cancelling is possible only if the robot is controlled by this manager
+  std::function<void(const AsyncGoal&)> cancel;
+  if (loaded_robot->isLocal())
+  {
+    cancel = [loaded_robot](const AsyncGoal&){ loaded_robot->cancelNavigationGoal(); };
+  }
+
+  res.goal_id = startAsyncGoal(req.goal_id
+  , req.robot_name
+  , goal_type::NAVIGATION
+  , [this, goal_srvc](AsyncGoal&) mutable
+    {
+      goalNavigationCb(goal_srvc.request, goal_srvc.response);
+      return static_cast<bool>(goal_srvc.response.success);
+    }
+  , cancel);
+
+  res.success = true;
+  return true;
+}
+catch(temoto_core::error::ErrorStack& error_stack)
+{
+  res.success = false;
+  return true;
+}
+catch(const resource_registrar::TemotoErrorStack &e)
+{
+  TEMOTO_ERROR_STREAM(e.what());
+  res.success = false;
+  return true;
+}
+catch(const std::exception& e)
+{
+  TEMOTO_WARN_STREAM_("Failed to start the goal for robot '" << req.robot_name << "': " << e.what());
+  res.success = false;
+  return true;
+}
+catch(...)
+{
+  TEMOTO_WARN_STREAM_("Failed to start the goal for robot '" << req.robot_name << "'.");
+  res.success = false;
+  return true;
+}
+
+bool RobotManager::cancelGoalCb(RobotCancelGoal::Request& req, RobotCancelGoal::Response& res)
+{
+  ScopedSpan span(metrics_, "", "srv/cancel_goal");
+  AsyncGoalPtr goal;
+  {
+    std::lock_guard<std::mutex> lock(async_goals_mutex_);
+    auto goal_it = async_goals_.find(req.goal_id);
+    if (goal_it != async_goals_.end() && !goal_it->second->finished)
+    {
+      goal = goal_it->second;
+    }
+  }
+
+  if (!goal || !goal->cancel)
+  {
+    TEMOTO_WARN_STREAM_("Goal '" << req.goal_id << "' is not active or cannot be cancelled.");
+    res.success = false;
+    return true;
+  }
+
+  TEMOTO_DEBUG_STREAM_("Cancelling goal '" << req.goal_id << "' ...");
+  goal->cancel_requested = true;
+  goal->cancel(*goal);
+  res.success = true;
+  return true;
+}
+
+bool RobotManager::getGoalStatusCb(RobotGetGoalStatus::Request& req, RobotGetGoalStatus::Response& res)
+{
+  AsyncGoalPtr goal;
+  {
+    std::lock_guard<std::mutex> lock(async_goals_mutex_);
+    auto goal_it = async_goals_.find(req.goal_id);
+    if (goal_it != async_goals_.end())
+    {
+      goal = goal_it->second;
+    }
+  }
+
+  res.found = bool(goal);
+  if (goal)
+  {
+    std::lock_guard<std::mutex> lock(goal->status_mutex);
+    res.status = goal->last_status;
+  }
+  return true;
+}
+
+std::string RobotManager::startAsyncGoal(const std::string& goal_id
+, const std::string& robot_name
+, const std::string& goal_type
+, std::function<bool(AsyncGoal&)> execute
+, std::function<void(const AsyncGoal&)> cancel
+, unsigned int waypoint_count)
+{
+  auto goal = std::make_shared<AsyncGoal>();
+  goal->waypoint_count = waypoint_count;
+  goal->robot_name = robot_name;
+  goal->goal_type = goal_type;
+  goal->execute = execute;
+  goal->cancel = cancel;
+
+  {
+    std::lock_guard<std::mutex> lock(async_goals_mutex_);
+    reapFinishedGoals();
+
+    unsigned int active_goals = std::count_if(async_goals_.begin(), async_goals_.end()
+    , [](const std::pair<const std::string, AsyncGoalPtr>& g){ return !g.second->finished; });
+    if (active_goals >= MAX_ACTIVE_GOALS)
+    {
+      throw TEMOTO_ERRSTACK("Cannot start the goal, " + std::to_string(active_goals) + " goals are already active.");
+    }
+
+    goal->goal_id = goal_id.empty()
+      ? temoto_core::common::getTemotoNamespace() + "/" + robot_name + "/" + std::to_string(async_goal_count_++)
+      : goal_id;
+
+    if (async_goals_.find(goal->goal_id) != async_goals_.end())
+    {
+      throw TEMOTO_ERRSTACK("Goal '" + goal->goal_id + "' already exists.");
+    }
+    async_goals_[goal->goal_id] = goal;
+    publishGoalStatus(*goal, RobotGoalStatus::PENDING);
+
+    try
+    {
+      goal->worker = std::thread([this, goal]
+      {
+        publishGoalStatus(*goal, RobotGoalStatus::ACTIVE);
+        bool success = false;
+        std::string message;
+        try
+        {
+          success = goal->execute(*goal);
+        }
+        catch (temoto_core::error::ErrorStack& error_stack)
+        {
+          message = "The " + goal->goal_type + " goal failed.";
+        }
+        catch (const resource_registrar::TemotoErrorStack& e)
+        {
+          message = e.what();
+        }
+        catch (const std::exception& e)
+        {
+          message = e.what();
+        }
+        catch (...)
+        {
+          message = "Unknown error";
+        }
+
+        if (success)
+        {
+          publishGoalStatus(*goal, RobotGoalStatus::SUCCEEDED);
+        }
+        else if (goal->cancel_requested)
+        {
+          publishGoalStatus(*goal, RobotGoalStatus::CANCELED);
+        }
+        else
+        {
+          // The client is told about every failure, also when the callback only reported it in its response
+          publishGoalStatus(*goal, RobotGoalStatus::FAILED
+          , message.empty() ? "The " + goal->goal_type + " goal failed." : message);
+        }
+        {
+          std::lock_guard<std::mutex> status_lock(goal->status_mutex);
+          goal->finish_time = ros::WallTime::now();
+        }
+        goal->finished = true;
+      });
+    }
+    catch (const std::system_error& e)
+    {
+      // A goal without a worker would never finish
+      async_goals_.erase(goal->goal_id);
+      throw TEMOTO_ERRSTACK("Could not start the worker of goal '" + goal->goal_id + "': " + e.what());
+    }
+  }
+
+  TEMOTO_DEBUG_STREAM_("Started " << goal_type << " goal '" << goal->goal_id << "' for robot '" << robot_name << "'.");
+  return goal->goal_id;
+}
+
+void RobotManager::publishGoalStatus(AsyncGoal& goal, uint8_t status, const std::string& message)
+{
+  RobotGoalStatus status_msg;
+  status_msg.goal_id = goal.goal_id;
+  status_msg.robot_name = goal.robot_name;
+  status_msg.goal_type = goal.goal_type;
+  status_msg.status = status;
+  status_msg.message = message;
+  status_msg.waypoint_index = goal.waypoint_index;
+  status_msg.waypoint_count = goal.waypoint_count;
+  {
+    std::lock_guard<std::mutex> lock(goal.status_mutex);
+    goal.last_status = status_msg;
+  }
+  goal_status_pub_.publish(status_msg);
+}
+
+bool RobotManager::navigationRouteCb(RobotNavigationRoute::Request& req, RobotNavigationRoute::Response& res)
+try
+{
+  ScopedSpan span(metrics_, req.robot_name, "srv/navigation_route");
+  RobotPtr loaded_robot = findLoadedRobot(req.robot_name);
+  std::function<bool(AsyncGoal&)> execute;
+  std::function<void(const AsyncGoal&)> cancel;
+
+  if (loaded_robot->isLocal())
+  {
+    execute = [this, loaded_robot, req](AsyncGoal& goal)
+    {
+      TEMOTO_DEBUG_STREAM_("Navigating '" << req.robot_name << "' through " << req.route.size() << " waypoints ...");
+      loaded_robot->goalNavigationRoute(req.reference_frame
+      , req.route
+      , req.tolerances
+      , req.look_ahead_radius
+      , [&](unsigned int waypoint_index)
+        {
+          goal.waypoint_index = waypoint_index;
+          publishGoalStatus(goal, RobotGoalStatus::ACTIVE);
+        });
+      return true;
+    };
+    cancel = [loaded_robot](const AsyncGoal&){ loaded_robot->cancelNavigationGoal(); };
+  }
+  else
+  {
+    std::string temoto_namespace = loaded_robot->getConfig()->getTemotoNamespace();
+    execute = [this, temoto_namespace, req](AsyncGoal& goal)
+    {
+      return forwardNavigationRoute(temoto_namespace, req, goal);
+    };
+    cancel = [this, temoto_namespace](const AsyncGoal& goal)
+    {
+      RobotCancelGoal cancel_srvc;
+      cancel_srvc.request.goal_id = goal.goal_id;
+      if (!remote_clients_.call(temoto_namespace, srv_name::SERVER_CANCEL_GOAL, cancel_srvc))
+      {
+        TEMOTO_WARN_STREAM_("Could not cancel the goal '" << goal.goal_id << "' at '" << temoto_namespace << "'.");
+      }
+    };
+  }
+
+  res.goal_id = startAsyncGoal(req.goal_id
+  , req.robot_name
+  , goal_type::NAVIGATION
+  , execute
+  , cancel
+  , req.route.size());
+
+  res.success = true;
+  return true;
+}
+catch(temoto_core::error::ErrorStack& error_stack)
+{
+  res.success = false;
+  return true;
+}
+catch(const resource_registrar::TemotoErrorStack &e)
+{
+  TEMOTO_ERROR_STREAM(e.what());
+  res.success = false;
+  return true;
+}
+catch(const std::exception& e)
+{
+  TEMOTO_WARN_STREAM_("Failed to start the goal for robot '" << req.robot_name << "': " << e.what());
+  res.success = false;
+  return true;
+}
+catch(...)
+{
+  TEMOTO_WARN_STREAM_("Failed to start the goal for robot '" << req.robot_name << "'.");
+  res.success = false;
+  return true;
+}
+
+bool RobotManager::forwardNavigationRoute(const std::string& temoto_namespace
+, RobotNavigationRoute::Request req
+, AsyncGoal& goal)
+{
+  std::mutex status_mutex;
+  std::condition_variable status_cv;
+  bool remote_goal_finished = false;
+  bool remote_goal_succeeded = false;
+
+  // The remote manager publishes the progress on its own goal status topic
+  boost::function<void(const RobotGoalStatus::ConstPtr&)> status_cb =
+  [&](const RobotGoalStatus::ConstPtr& msg)
+  {
+    if (msg->goal_id != goal.goal_id)
+    {
+      return;
+    }
+
+    if (msg->status == RobotGoalStatus::ACTIVE && msg->waypoint_index >= 0)
+    {
+      goal.waypoint_index = msg->waypoint_index;
+      publishGoalStatus(goal, RobotGoalStatus::ACTIVE);
+    }
+    else if (msg->status != RobotGoalStatus::PENDING && msg->status != RobotGoalStatus::ACTIVE)
+    {
+      std::lock_guard<std::mutex> lock(status_mutex);
+      remote_goal_finished = true;
+      remote_goal_succeeded = (msg->status == RobotGoalStatus::SUCCEEDED);
+      status_cv.notify_all();
+    }
+  };
+
+  std::string status_topic = "/" + temoto_namespace + "/" + srv_name::GOAL_STATUS_TOPIC;
+  ros::Subscriber status_sub = nh_.subscribe<RobotGoalStatus>(status_topic, 100, status_cb);
+
+  // Make sure that the final status of the goal cannot be missed
+  ros::WallTime connect_deadline = ros::WallTime::now() + ros::WallDuration(5.0);
+  while (status_sub.getNumPublishers() == 0 && ros::WallTime::now() < connect_deadline)
+  {
+    ros::WallDuration(0.05).sleep();
+  }
+
+  if (status_sub.getNumPublishers() == 0)
+  {
+    throw TEMOTO_ERRSTACK("Could not subscribe to the goal status topic '" + status_topic + "'.");
+  }
+
+  TEMOTO_DEBUG_STREAM_("Forwarding the route to remote robot manager at '" << temoto_namespace << "'.");
+  RobotNavigationRoute fwd_route_srvc;
+  fwd_route_srvc.request = req;
+  fwd_route_srvc.request.goal_id = goal.goal_id;
+  if (!remote_clients_.call(temoto_namespace, srv_name::SERVER_NAVIGATION_ROUTE, fwd_route_srvc)
+  || !fwd_route_srvc.response.success)
+  {
+    throw TEMOTO_ERRSTACK("Call to remote RobotManager service failed.");
+  }
+
+  std::unique_lock<std::mutex> lock(status_mutex);
+  while (!remote_goal_finished)
   {
-    TEMOTO_DEBUG_STREAM_("Navigating '" << req.robot_name << " to pose: " << req.target_pose << " ...");
-    loaded_robot->goalNavigation(req.reference_frame, req.target_pose);  // The robot would move with respect to this coordinate frame
-    res.success = true;   
+    status_cv.wait_for(lock, std::chrono::seconds(1));
+    if (!remote_goal_finished && status_sub.getNumPublishers() == 0)
+    {
+      throw TEMOTO_ERRSTACK("Lost the connection to the remote robot manager at '" + temoto_namespace + "'.");
+    }
   }
-  else
+  status_sub.shutdown();
+  return remote_goal_succeeded;
+}
+
+void RobotManager::reapFinishedGoals()
+{
+  ros::WallTime now = ros::WallTime::now();
+  for (auto goal_it = async_goals_.begin(); goal_it != async_goals_.end();)
   {
-    std::string topic = "/" + loaded_robot->getConfig()->getTemotoNamespace() + "/"
-      + srv_name::SERVER_NAVIGATION_GOAL;
-    TEMOTO_DEBUG_STREAM_("Forwarding the request to remote robot manager at '" << topic << "'.");
+    AsyncGoal& goal = *goal_it->second;
+    if (!goal.finished)
+    {
+      ++goal_it;
+      continue;
+    }
 
-    ros::ServiceClient client_navigation_goal_ = nh_.serviceClient<RobotNavigationGoal>(topic);
-    RobotNavigationGoal fwd_goal_srvc;
-    fwd_goal_srvc.request = req;
-    fwd_goal_srvc.response = res;
-    if (client_navigation_goal_.call(fwd_goal_srvc))
+    if (goal.worker.joinable())
     {
-      res = fwd_goal_srvc.response;
+      goal.worker.join();
+    }
+
+    bool expired = false;
+    {
+      std::lock_guard<std::mutex> status_lock(goal.status_mutex);
+      expired = (now - goal.finish_time).toSec() > GOAL_RETENTION;
+    }
+
+    if (expired)
+    {
+      goal_it = async_goals_.erase(goal_it);
     }
     else
     {
-      throw TEMOTO_ERRSTACK("Call to remote RobotManager service failed.");
+      ++goal_it;
     }
   }
-  res.success = true;
-  return true;  
-}
-catch(temoto_core::error::ErrorStack& error_stack)
-{
-  res.success = false;
-  return true;
 }
-catch(const resource_registrar::TemotoErrorStack &e)
+
+void RobotManager::reapGoalsCb(const ros::WallTimerEvent& event)
 {
-  TEMOTO_ERROR_STREAM(e.what());
-  res.success = false;
-  return true;
+  std::lock_guard<std::mutex> lock(async_goals_mutex_);
+  reapFinishedGoals();
 }
 
 void RobotManager::resourceStatusCb(RobotLoad srv_msg, temoto_resource_registrar::Status status_msg)
@@ -657,44 +1999,333 @@ void RobotManager::resourceStatusCb(RobotLoad srv_msg, temoto_resource_registrar
   }
 }
 
-RobotConfigPtr RobotManager::findRobot(const std::string& robot_name, const RobotConfigs& configs)
+RobotConfigPtr RobotManager::findRobot(const std::string& robot_name, const RobotConfigIndex& configs)
 {
-  // Local list of devices that follow the requirements
-  RobotConfigs candidates;
+  return configs.findBest(robot_name);
+}
+
+RobotConfigPtr RobotManager::selectRobot(const std::string& robot_name, bool local_only, bool& is_local)
+{
+  RobotConfigPtr local_config;
+  RobotConfigs remote_configs;
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(registry_mutex_);
+    local_config = findRobot(robot_name, local_configs_);
+    if (!local_only && robot_name.empty())
+    {
+      RobotConfigPtr remote_config = remote_configs_.findBest(robot_name);
+      if (remote_config)
+      {
+        remote_configs.push_back(remote_config);
+      }
+    }
+    else if (!local_only)
+    {
+      remote_configs = remote_configs_.findAll(robot_name);
+    }
+  }
 
-  // If robot name is unspecified, pick the best one from all configs.
-  if (robot_name == "")
+  std::stringstream candidates;
+  double local_score = 0.0;
+  if (local_config)
   {
-    candidates = configs;
+    local_score = getSelectionScore(local_config->getReliability(), getHostCost(getHostLoad(getHostStatus())));
+    candidates << " local: " << local_score;
   }
-  else
+
+  RobotConfigPtr remote_config;
+  double remote_score = 0.0;
+  {
+    std::lock_guard<std::mutex> lock(remote_hosts_mutex_);
+    ros::WallTime now = ros::WallTime::now();
+    for (const auto& config : remote_configs)
+    {
+      HostLoad host_load;
+      auto host_it = remote_hosts_.find(config->getTemotoNamespace());
+      if (host_it != remote_hosts_.end() && (now - host_it->second.received).toSec() < HOST_STATUS_TIMEOUT)
+      {
+        host_load = getHostLoad(host_it->second.status);
+      }
+
+      /*
+       * The host status is up to a second old and does not include the loads which were just
+       * forwarded to the host, without counting them a burst of loads would all go to the
+       * same host
+       */
+      auto forwarded_it = forwarded_loads_.find(config->getTemotoNamespace());
+      if (forwarded_it != forwarded_loads_.end())
+      {
+        host_load.forwarded_loads = forwarded_it->second.in_progress + forwarded_it->second.unreported;
+      }
+
+      double score = getSelectionScore(config->getReliability(), getHostCost(host_load));
+      candidates << " " << config->getTemotoNamespace() << ": " << score
+        << (host_load.known ? "" : " (load unknown)");
+      if (host_load.forwarded_loads)
+      {
+        candidates << " (" << host_load.forwarded_loads << " forwarded)";
+      }
+
+      if (!remote_config || score > remote_score)
+      {
+        remote_config = config;
+        remote_score = score;
+      }
+    }
+  }
+
+  is_local = local_config && (!remote_config || isLocalPreferred(local_score, remote_score));
+
+  // The stack of a robot in warm standby is already running on this host
+  if (local_config && !is_local && hasStandbyRobot(local_config->getName()))
+  {
+    is_local = true;
+    candidates << " (local warm standby)";
+  }
+  RobotConfigPtr selected_config = is_local ? local_config : remote_config;
+  if (selected_config)
+  {
+    TEMOTO_INFO_STREAM_("Selected robot '" << selected_config->getName() << "' at "
+      << (is_local ? "this manager" : selected_config->getTemotoNamespace()) << ", scores:" << candidates.str());
+  }
+  return selected_config;
+}
+
+void RobotManager::beginForwardedLoad(const std::string& temoto_namespace)
+{
+  std::lock_guard<std::mutex> lock(remote_hosts_mutex_);
+  forwarded_loads_[temoto_namespace].in_progress++;
+}
+
+void RobotManager::endForwardedLoad(const std::string& temoto_namespace, bool loaded)
+{
+  std::lock_guard<std::mutex> lock(remote_hosts_mutex_);
+  ForwardedLoads& forwarded_loads = forwarded_loads_[temoto_namespace];
+  forwarded_loads.in_progress--;
+
+  // A loaded robot counts until the next host status of the remote manager reports it
+  if (loaded)
+  {
+    forwarded_loads.unreported++;
+  }
+  else if (!forwarded_loads.in_progress && !forwarded_loads.unreported)
   {
-    // Find the robot that matches the "name" criteria
-    auto it = std::copy_if(configs.begin()
-    , configs.end()
-    , std::back_inserter(candidates)
-    , [&](const RobotConfigPtr& s) { return s->getName() == robot_name; });
+    forwarded_loads_.erase(temoto_namespace);
   }
+}
+
+HostStatus RobotManager::getHostStatus() const
+{
+  HostStatus status;
+  status.temoto_namespace = temoto_core::common::getTemotoNamespace();
+
+  status.cpu_load = getCpuLoad();
 
-  // If the list is empty, leave the req empty
-  if (candidates.empty())
   {
-    return NULL;
+    std::shared_lock<std::shared_timed_mutex> lock(registry_mutex_);
+    status.loaded_robots = std::count_if(loaded_robots_.begin()
+    , loaded_robots_.end()
+    , [](const std::pair<const std::string, RobotPtr>& robot)
+      {
+        return robot.second->isLocal() && !robot.second->isInStandby();
+      });
   }
+  status.pending_loads = pending_loads_;
+  return status;
+}
 
-  std::sort(candidates.begin(), candidates.end(), [](RobotConfigPtr& rc1, RobotConfigPtr& rc2) 
+void RobotManager::hostStatusCb(const HostStatus& msg)
+{
+  if (msg.temoto_namespace == temoto_core::common::getTemotoNamespace())
   {
-    return rc1->getReliability() > rc2->getReliability();
-  });
+    return;
+  }
+
+  bool new_manager = false;
+  {
+    std::unique_lock<std::shared_timed_mutex> lock(registry_mutex_);
+    new_manager = remote_configs_.renewLease(msg.temoto_namespace);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(remote_hosts_mutex_);
+    RemoteHost& remote_host = remote_hosts_[msg.temoto_namespace];
+    remote_host.status = msg;
+    remote_host.received = ros::WallTime::now();
+
+    // The finished forwarded loads are reported by this host status
+    auto forwarded_it = forwarded_loads_.find(msg.temoto_namespace);
+    if (forwarded_it != forwarded_loads_.end())
+    {
+      forwarded_it->second.unreported = 0;
+      if (!forwarded_it->second.in_progress)
+      {
+        forwarded_loads_.erase(forwarded_it);
+      }
+    }
+  }
+
+  /*
+   * The host status may arrive before any advertisement of the manager, e.g. if that was
+   * missed, or after its configs were dropped. Only that manager is asked for its robots
+   */
+  if (new_manager)
+  {
+    TEMOTO_DEBUG_("Manager at '%s' is alive, requesting its robots.", msg.temoto_namespace.c_str());
+    requestConfigs(msg.temoto_namespace);
+  }
+}
+
+void RobotManager::evictExpiredManagers(const ros::WallTimerEvent& event)
+{
+  std::vector<std::string> evicted_namespaces;
+  size_t remaining_count = 0;
+  {
+    std::unique_lock<std::shared_timed_mutex> lock(registry_mutex_);
+    evicted_namespaces = remote_configs_.evictExpired();
+    remaining_count = remote_configs_.size();
+  }
+
+  for (const auto& temoto_namespace : evicted_namespaces)
+  {
+    remote_clients_.invalidate(temoto_namespace);
+    {
+      std::lock_guard<std::mutex> lock(remote_hosts_mutex_);
+      remote_hosts_.erase(temoto_namespace);
+      auto forwarded_it = forwarded_loads_.find(temoto_namespace);
+      if (forwarded_it != forwarded_loads_.end() && !forwarded_it->second.in_progress)
+      {
+        forwarded_loads_.erase(forwarded_it);
+      }
+    }
+    {
+      std::lock_guard<std::mutex> lock(remote_robot_status_mutex_);
+      remote_robot_status_.erase(temoto_namespace);
+    }
+    TEMOTO_INFO_("Manager at '%s' has not been heard from for %.0f s, dropped its robots (%lu remote robots left)."
+    , temoto_namespace.c_str()
+    , MANAGER_LEASE
+    , remaining_count);
+  }
+}
+
+void RobotManager::publishHostStatus(const ros::WallTimerEvent& event)
+{
+  host_status_pub_.publish(getHostStatus());
+}
+
+void RobotManager::publishRobotStatus(const ros::WallTimerEvent& event)
+{
+  std::vector<RobotPtr> local_robots;
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(registry_mutex_);
+    for (const auto& loaded_robot : loaded_robots_)
+    {
+      if (loaded_robot.second->isLocal() && !loaded_robot.second->isInStandby())
+      {
+        local_robots.push_back(loaded_robot.second);
+      }
+    }
+  }
+
+  // The poses are read outside of the registry lock, so that loading is not blocked
+  RobotStatusArray msg;
+  msg.temoto_namespace = temoto_core::common::getTemotoNamespace();
+  for (const auto& local_robot : local_robots)
+  {
+    msg.robots.push_back(local_robot->getStatus());
+  }
+  robot_status_pub_.publish(msg);
+}
+
+void RobotManager::robotStatusCb(const RobotStatusArray& msg)
+{
+  if (msg.temoto_namespace == temoto_core::common::getTemotoNamespace())
+  {
+    return;
+  }
+
+  // Robots which are not in the message anymore were unloaded by the remote manager
+  std::lock_guard<std::mutex> lock(remote_robot_status_mutex_);
+  RemoteRobotStatus& remote_status = remote_robot_status_[msg.temoto_namespace];
+  remote_status.robots.clear();
+  for (const auto& robot : msg.robots)
+  {
+    remote_status.robots[robot.robot_name] = robot;
+  }
+  remote_status.received = ros::WallTime::now();
+}
+
+bool RobotManager::getRemoteManipulationTarget(const std::string& temoto_namespace
+, const std::string& robot_name
+, geometry_msgs::Pose& pose) const
+{
+  std::lock_guard<std::mutex> lock(remote_robot_status_mutex_);
+  auto remote_status_it = remote_robot_status_.find(temoto_namespace);
+  if (remote_status_it == remote_robot_status_.end()
+  || (ros::WallTime::now() - remote_status_it->second.received).toSec() > ROBOT_STATUS_TIMEOUT)
+  {
+    return false;
+  }
+
+  auto robot_it = remote_status_it->second.robots.find(robot_name);
+  if (robot_it == remote_status_it->second.robots.end())
+  {
+    return false;
+  }
+
+  const RobotStatus& status = robot_it->second;
+  for (unsigned int i = 0; i < status.planning_groups.size() && i < status.end_effector_poses.size(); i++)
+  {
+    if (status.planning_groups[i] == status.active_planning_group)
+    {
+      pose = status.end_effector_poses[i].pose;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool RobotManager::getMetricsCb(RobotGetMetrics::Request& req, RobotGetMetrics::Response& res)
+{
+  if (req.set_enabled == RobotGetMetrics::Request::ENABLE)
+  {
+    TEMOTO_INFO_("Enabling the metrics.");
+    metrics_.setEnabled(true);
+  }
+  else if (req.set_enabled == RobotGetMetrics::Request::DISABLE)
+  {
+    TEMOTO_INFO_("Disabling the metrics.");
+    metrics_.setEnabled(false);
+  }
+
+  res.metrics = metrics_.getMetrics(req.robot_name);
+  res.metrics.temoto_namespace = temoto_core::common::getTemotoNamespace();
+  if (req.reset)
+  {
+    metrics_.reset();
+  }
+  res.success = true;
+  return true;
+}
 
-  // Get the name of the package and first launchable
-  return candidates.front();
+void RobotManager::publishMetrics(const ros::WallTimerEvent& event)
+{
+  if (!metrics_.isEnabled() || metrics_pub_.getNumSubscribers() == 0)
+  {
+    return;
+  }
+
+  RobotManagerMetrics msg = metrics_.getMetrics();
+  msg.temoto_namespace = temoto_core::common::getTemotoNamespace();
+  metrics_pub_.publish(msg);
 }
 
 bool RobotManager::gripperControlPositionCb(RobotGripperControlPosition::Request& req
 , RobotGripperControlPosition::Response& res)
 try
 {
+  ScopedSpan span(metrics_, req.robot_name, "srv/gripper_control_position");
   TEMOTO_DEBUG_STREAM_("Commanding the gripper of '" << req.robot_name << " ...");
   RobotPtr loaded_robot = findLoadedRobot(req.robot_name);
   TEMOTO_INFO_STREAM_("GRIPPER CONTROL...");
@@ -709,11 +2340,12 @@ try
       + srv_name::SERVER_GRIPPER_CONTROL_POSITION;
     TEMOTO_DEBUG_STREAM_("Forwarding the execution request to remote robot manager at '" << topic << "'.");
 
-    ros::ServiceClient client_gripper_control_position_ = nh_.serviceClient<RobotGripperControlPosition>(topic);
     RobotGripperControlPosition fwd_gripper_srvc;
     fwd_gripper_srvc.request = req;
     fwd_gripper_srvc.response = res;
-    if (client_gripper_control_position_.call(fwd_gripper_srvc))
+    if (remote_clients_.call(loaded_robot->getConfig()->getTemotoNamespace()
+    , srv_name::SERVER_GRIPPER_CONTROL_POSITION
+    , fwd_gripper_srvc))
     {
       res = fwd_gripper_srvc.response;
     }
@@ -733,43 +2365,15 @@ catch(temoto_core::error::ErrorStack& error_stack)
 
 bool RobotManager::getRobotConfigCb(RobotGetConfig::Request& req, RobotGetConfig::Response& res)
 {
+  ScopedSpan span(metrics_, req.robot_name, "srv/get_config");
   TEMOTO_DEBUG_STREAM_("Received a request to send the config of '" << req.robot_name << "'.");
-  /*
-   * Look for local robot configs
-   */ 
-  auto local_robot_config_it = std::find_if(
-    local_configs_.begin(),
-    local_configs_.end(),
-    [&](const RobotConfigPtr p) -> bool 
-    {
-      return p->getName() == req.robot_name;
-    });
-  
-  if (local_robot_config_it != local_configs_.end())
-  { 
-    TEMOTO_DEBUG_STREAM_("Found the config of '" << req.robot_name << "' in known local robot configs.");
-    res.robot_config = (*local_robot_config_it)->getYamlConfigString();
-    res.robot_absolute_namespace = (*local_robot_config_it)->getAbsRobotNamespace();
-    res.success = true;
-    return true;
-  }
+  std::shared_lock<std::shared_timed_mutex> lock(registry_mutex_);
 
-  /*
-   * Look for remote robot configs
-   */
-  auto remote_robot_config_it = std::find_if(
-    remote_configs_.begin(),
-    remote_configs_.end(),
-    [&](const RobotConfigPtr p) -> bool 
-    {
-      return p->getName() == req.robot_name;
-    });
-  
-  if (remote_robot_config_it != remote_configs_.end())
+  RobotConfigPtr robot_config = findConfig(req.robot_name);
+  if (robot_config)
   { 
-    TEMOTO_DEBUG_STREAM_("Found the config of '" << req.robot_name << "' in known remote robot configs.");
-    res.robot_config = (*remote_robot_config_it)->getYamlConfigString();
-    res.robot_absolute_namespace = (*remote_robot_config_it)->getAbsRobotNamespace();
+    res.robot_config = robot_config->getYamlConfigString();
+    res.robot_absolute_namespace = robot_config->getAbsRobotNamespace();
     res.success = true;
     return true;
   }
@@ -781,26 +2385,65 @@ bool RobotManager::getRobotConfigCb(RobotGetConfig::Request& req, RobotGetConfig
   return true;
 }
 
-RobotManager::RobotPtr RobotManager::findLoadedRobot(const std::string& robot_name)
+bool RobotManager::getRobotConfigsCb(RobotGetConfigs::Request& req, RobotGetConfigs::Response& res)
 {
-  auto robot_it = std::find_if(loaded_robots_.begin()
-  , loaded_robots_.end()
-  , [&](const RobotManager::RobotPtr p) -> bool
+  ScopedSpan span(metrics_, "", "srv/get_configs");
+  TEMOTO_DEBUG_STREAM_("Received a request to send the configs of " << req.robot_names.size() << " robots.");
+  std::shared_lock<std::shared_timed_mutex> lock(registry_mutex_);
+
+  res.success = true;
+  for (const auto& robot_name : req.robot_names)
+  {
+    RobotConfigPtr robot_config = findConfig(robot_name);
+    res.robot_configs.push_back(robot_config ? robot_config->getYamlConfigString() : "");
+    res.robot_absolute_namespaces.push_back(robot_config ? robot_config->getAbsRobotNamespace() : "");
+    res.found.push_back(robot_config != nullptr);
+    if (!robot_config)
     {
-      return p->getName() == robot_name;
-    });  
+      TEMOTO_INFO_STREAM_("Could not find robot '" << robot_name << "'");
+      res.success = false;
+    }
+  }
+  return true;
+}
+
+RobotConfigPtr RobotManager::findConfig(const std::string& robot_name)
+{
+  RobotConfigPtr local_robot_config = local_configs_.findBest(robot_name);
+  if (local_robot_config)
+  {
+    TEMOTO_DEBUG_STREAM_("Found the config of '" << robot_name << "' in known local robot configs.");
+    return local_robot_config;
+  }
+
+  RobotConfigPtr remote_robot_config = remote_configs_.findBest(robot_name);
+  if (remote_robot_config)
+  {
+    TEMOTO_DEBUG_STREAM_("Found the config of '" << robot_name << "' in known remote robot configs.");
+  }
+  return remote_robot_config;
+}
+
+RobotManager::RobotPtr RobotManager::findLoadedRobot(const std::string& robot_name)
+{
+  std::shared_lock<std::shared_timed_mutex> lock(registry_mutex_);
+  auto robot_it = loaded_robots_.find(robot_name);
   
-  if (robot_it == loaded_robots_.end())
+  if (robot_it == loaded_robots_.end() && recovering_robots_.count(robot_name))
+  {
+    throw TEMOTO_ERRSTACK("Robot '" + robot_name + "' is recovering.");
+  }
+  else if (robot_it == loaded_robots_.end())
   {
     throw TEMOTO_ERRSTACK("Robot '" + robot_name + "' is not loaded.");
   }
-  else if (*robot_it == nullptr)
+  else if (robot_it->second == nullptr)
   {
     throw TEMOTO_ERRSTACK("Robot '" + robot_name + "' is loaded but its configuration is invalid (nullptr).");
   }
   else
   {
-    return *robot_it;
+    return robot_it->second;
   }
 }
 
@@ -818,17 +2461,97 @@ void RobotManager::restoreState()
    */
 
   resource_registrar_.loadCatalog();
-  for (const auto& query : resource_registrar_.getServerQueries<RobotLoad>(srv_name::SERVER_LOAD))
+  std::vector<RobotLoad> queries;
   {
-    auto robot_config = findRobot(query.request.robot_name, local_configs_);
-    if (!robot_config)
+    std::unique_lock<std::shared_timed_mutex> lock(registry_mutex_);
+    for (const auto& query : resource_registrar_.getServerQueries<RobotLoad>(srv_name::SERVER_LOAD))
     {
-      // TODO: error this robot is not described in robot_description.yaml
-      continue;
+      queries.push_back(query);
+      recovering_robots_.insert(query.request.robot_name);
+    }
+  }
+  unloadOrphanedStandbyResources();
+
+  // Each robot is recovered by one worker, the robots are recovered in parallel
+  auto next_query = std::make_shared<std::atomic<size_t>>(0);
+  auto restore_worker = [this, queries, next_query]
+  {
+    for (size_t i = (*next_query)++; i < queries.size(); i = (*next_query)++)
+    {
+      restoreRobot(queries[i]);
+    }
+  };
+
+  unsigned int worker_count = std::min<size_t>(queries.size(), std::max(1u, std::thread::hardware_concurrency()));
+  for (unsigned int i = 0; i < worker_count; i++)
+  {
+    restore_workers_.emplace_back(restore_worker);
+  }
+  TEMOTO_DEBUG_("Recovering %lu robots with %u workers.", queries.size(), worker_count);
+}
+
+void RobotManager::restoreRobot(const RobotLoad& query)
+{
+  // The robot is not recovering anymore however this returns, also if it throws
+  const std::string robot_name = query.request.robot_name;
+  LoadReservation recovery([this, robot_name]
+  {
+    std::unique_lock<std::shared_timed_mutex> lock(registry_mutex_);
+    recovering_robots_.erase(robot_name);
+  });
+
+  RobotConfigPtr robot_config;
+  bool is_loaded = false;
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(registry_mutex_);
+    robot_config = findRobot(query.request.robot_name, local_configs_);
+    is_loaded = robot_config && loaded_robots_.count(robot_config->getName());
+  }
+
+  /*
+   * A second instance would replace the robot and its destructor would delete the
+   * parameters of the registered instance, e.g. if the catalog has the robot twice
+   */
+  if (is_loaded)
+  {
+    TEMOTO_WARN_("Robot '%s' is already loaded, it is not recovered again.", query.request.robot_name.c_str());
+  }
+  else if (robot_config)
+  {
+    try
+    {
+      auto robot = std::make_shared<Robot>(robot_config, query.response.temoto_metadata.request_id, resource_registrar_, readiness_monitor_, urdf_cache_, metrics_, *this);
+      robot->recover(query.response.temoto_metadata.request_id);
+
+      std::unique_lock<std::shared_timed_mutex> lock(registry_mutex_);
+      if (!loaded_robots_.emplace(robot->getName(), robot).second)
+      {
+        throw TEMOTO_ERRSTACK("Robot '" + robot->getName() + "' was loaded while it was being recovered.");
+      }
+      TEMOTO_DEBUG_("Robot '%s' recovered.", robot->getName().c_str());
+    }
+    catch (temoto_core::error::ErrorStack& error_stack)
+    {
+      TEMOTO_WARN_("Failed to recover robot '%s'.", query.request.robot_name.c_str());
+    }
+    catch (const resource_registrar::TemotoErrorStack& e)
+    {
+      TEMOTO_ERROR_STREAM(e.what());
     }
-    auto robot = std::make_shared<Robot>(robot_config, query.response.temoto_metadata.request_id, resource_registrar_, *this);
-    robot->recover(query.response.temoto_metadata.request_id);
-    loaded_robots_.push_back(robot);
+    // The robot is recovered on a worker thread, where an escaping exception would terminate
+    catch (const std::exception& e)
+    {
+      TEMOTO_WARN_("Failed to recover robot '%s': %s", query.request.robot_name.c_str(), e.what());
+    }
+    catch (...)
+    {
+      TEMOTO_WARN_("Failed to recover robot '%s'.", query.request.robot_name.c_str());
+    }
+  }
+  else
+  {
+    // TODO: error this robot is not described in robot_description.yaml
+    TEMOTO_WARN_("Robot '%s' is not described, it can not be recovered.", query.request.robot_name.c_str());
   }
 }
 
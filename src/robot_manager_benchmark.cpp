@@ -0,0 +1,788 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * Runs a robot manager in-process against mock external resource manager, move_base and
+ * move_group endpoints, and reports the latencies of loading, config sync, service calls and
+ * forwarding as JSON
+ */
+
+#include "temoto_robot_manager/robot_manager.h"
+#include "temoto_er_manager/temoto_er_manager_services.h"
+#include "temoto_resource_registrar/temoto_logging.h"
+#include <actionlib/server/simple_action_server.h>
+#include <move_base_msgs/MoveBaseAction.h>
+#include <moveit_msgs/MoveGroupAction.h>
+#include <moveit_msgs/ExecuteTrajectoryAction.h>
+#include <moveit_msgs/PickupAction.h>
+#include <moveit_msgs/PlaceAction.h>
+#include <moveit_msgs/QueryPlannerInterfaces.h>
+#include <moveit_msgs/GetPlannerParams.h>
+#include <moveit_msgs/SetPlannerParams.h>
+#include <moveit_msgs/GetCartesianPath.h>
+#include <nav_msgs/Odometry.h>
+#include <sensor_msgs/JointState.h>
+#include <geometry_msgs/Twist.h>
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/program_options.hpp>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace temoto_robot_manager
+{
+namespace
+{
+const std::string MOCK_PACKAGE = "temoto_robot_manager";
+const std::string MOCK_NAVIGATION_DRIVER = "mock_navigation_driver";
+const std::string MOCK_MOVE_BASE = "mock_move_base";
+const std::string MOCK_MANIPULATION_DRIVER = "mock_manipulation_driver";
+const std::string MOCK_MOVE_GROUP = "mock_move_group";
+
+// Temoto namespace of the simulated remote manager
+const std::string REMOTE_NAMESPACE = "robot_manager_benchmark_remote";
+const std::string REMOTE_ROBOT_NAME = "bench_remote_robot";
+
+const std::string MOCK_URDF =
+  "<robot name=\"bench_arm\">"
+  "<link name=\"base_link\"/><link name=\"tool0\"/>"
+  "<joint name=\"joint_1\" type=\"revolute\">"
+  "<parent link=\"base_link\"/><child link=\"tool0\"/><origin xyz=\"0 0 0.5\"/><axis xyz=\"0 0 1\"/>"
+  "<limit lower=\"-3.14\" upper=\"3.14\" effort=\"10\" velocity=\"1\"/>"
+  "</joint></robot>";
+
+const std::string MOCK_SRDF =
+  "<robot name=\"bench_arm\"><group name=\"arm\"><chain base_link=\"base_link\" tip_link=\"tool0\"/></group></robot>";
+
+typedef std::chrono::steady_clock Clock;
+
+double getSeconds(const Clock::time_point& start_time)
+{
+  return std::chrono::duration<double>(Clock::now() - start_time).count();
+}
+
+/**
+ * @brief Latency samples of one measurement
+ */
+struct BenchmarkResult
+{
+  std::string name;
+  std::map<std::string, double> parameters;
+  std::vector<double> samples;
+
+  // Wall time of the whole measurement, used for the throughput
+  double elapsed = 0.0;
+  unsigned int failures = 0;
+};
+
+std::string toJson(const std::string& value)
+{
+  std::string escaped = "\"";
+  for (char c : value)
+  {
+    if (c == '"' || c == '\\')
+    {
+      escaped += '\\';
+    }
+    escaped += c;
+  }
+  return escaped + "\"";
+}
+
+double getPercentile(std::vector<double> samples, double share)
+{
+  if (samples.empty())
+  {
+    return 0.0;
+  }
+  std::sort(samples.begin(), samples.end());
+  size_t index = std::min(samples.size() - 1, static_cast<size_t>(share * samples.size()));
+  return samples[index];
+}
+
+void writeResult(std::ostream& out, const BenchmarkResult& result)
+{
+  double sum = 0.0;
+  for (double sample : result.samples)
+  {
+    sum += sample;
+  }
+  auto min_max = std::minmax_element(result.samples.begin(), result.samples.end());
+  bool empty = result.samples.empty();
+
+  out << "    {\"name\": " << toJson(result.name) << ", \"unit\": \"s\"";
+  for (const auto& parameter : result.parameters)
+  {
+    out << ", " << toJson(parameter.first) << ": " << parameter.second;
+  }
+  out << ", \"count\": " << result.samples.size()
+      << ", \"failures\": " << result.failures
+      << ", \"min\": " << (empty ? 0.0 : *min_max.first)
+      << ", \"mean\": " << (empty ? 0.0 : sum / result.samples.size())
+      << ", \"p50\": " << getPercentile(result.samples, 0.5)
+      << ", \"p90\": " << getPercentile(result.samples, 0.9)
+      << ", \"p99\": " << getPercentile(result.samples, 0.99)
+      << ", \"max\": " << (empty ? 0.0 : *min_max.second)
+      << ", \"throughput\": " << ((result.elapsed > 0.0) ? result.samples.size() / result.elapsed : 0.0)
+      << "}";
+}
+
+/**
+ * @brief Stands in for the external resource manager. Instead of launching the executables,
+ * it creates the topics, parameters and action servers which the robot manager waits for.
+ * The mock move_group offers the actions and services which the group interfaces connect
+ * to, the goals succeed without motion and the cartesian paths are empty
+ */
+class MockErManager
+{
+public:
+  MockErManager()
+  : resource_registrar_(temoto_er_manager::srv_name::MANAGER)
+  {
+    auto server = std::make_unique<Ros1Server<temoto_er_manager::LoadExtResource>>(temoto_er_manager::srv_name::SERVER
+    , std::bind(&MockErManager::loadCb, this, std::placeholders::_1, std::placeholders::_2)
+    , std::bind(&MockErManager::unloadCb, this, std::placeholders::_1, std::placeholders::_2));
+    resource_registrar_.registerServer(std::move(server));
+    resource_registrar_.init();
+  }
+
+private:
+  typedef actionlib::SimpleActionServer<move_base_msgs::MoveBaseAction> MoveBaseServer;
+  typedef actionlib::SimpleActionServer<moveit_msgs::MoveGroupAction> MoveGroupServer;
+  typedef actionlib::SimpleActionServer<moveit_msgs::ExecuteTrajectoryAction> ExecuteTrajectoryServer;
+  typedef actionlib::SimpleActionServer<moveit_msgs::PickupAction> PickupServer;
+  typedef actionlib::SimpleActionServer<moveit_msgs::PlaceAction> PlaceServer;
+
+  struct Endpoint
+  {
+    std::vector<ros::Publisher> publishers;
+    std::vector<std::string> params;
+    ros::WallTimer timer;
+    std::unique_ptr<MoveBaseServer> move_base;
+    std::unique_ptr<MoveGroupServer> move_group;
+    std::unique_ptr<ExecuteTrajectoryServer> execute_trajectory;
+    std::unique_ptr<PickupServer> pickup;
+    std::unique_ptr<PlaceServer> place;
+    std::vector<ros::ServiceServer> services;
+  };
+
+  void loadCb(temoto_er_manager::LoadExtResource::Request& req, temoto_er_manager::LoadExtResource::Response& res)
+  {
+    ros::NodeHandle nh(req.ros_namespace);
+    auto endpoint = std::make_unique<Endpoint>();
+    Endpoint* endpoint_ptr = endpoint.get();
+
+    if (req.executable == MOCK_NAVIGATION_DRIVER)
+    {
+      endpoint->publishers.push_back(nh.advertise<nav_msgs::Odometry>("odom", 1));
+    }
+    else if (req.executable == MOCK_MOVE_BASE)
+    {
+      endpoint->publishers.push_back(nh.advertise<geometry_msgs::Twist>("cmd_vel", 1));
+      endpoint->move_base = std::make_unique<MoveBaseServer>(nh, "move_base"
+      , [endpoint_ptr](const move_base_msgs::MoveBaseGoalConstPtr&)
+        {
+          endpoint_ptr->move_base->setSucceeded();
+        }
+      , false);
+      endpoint->move_base->start();
+    }
+    else if (req.executable == MOCK_MANIPULATION_DRIVER)
+    {
+      ros::Publisher joint_state_pub = nh.advertise<sensor_msgs::JointState>("joint_states", 1);
+      endpoint->publishers.push_back(joint_state_pub);
+      endpoint->timer = nh.createWallTimer(ros::WallDuration(0.02), [joint_state_pub](const ros::WallTimerEvent&) mutable
+      {
+        sensor_msgs::JointState joint_state;
+        joint_state.header.stamp = ros::Time::now();
+        joint_state.name = {"joint_1"};
+        joint_state.position = {0.0};
+        joint_state_pub.publish(joint_state);
+      });
+    }
+    else if (req.executable == MOCK_MOVE_GROUP)
+    {
+      endpoint->params = {req.ros_namespace + "/robot_description", req.ros_namespace + "/robot_description_semantic"};
+      nh.setParam("robot_description", MOCK_URDF);
+      nh.setParam("robot_description_semantic", MOCK_SRDF);
+      endpoint->move_group = std::make_unique<MoveGroupServer>(nh, "move_group"
+      , [endpoint_ptr](const moveit_msgs::MoveGroupGoalConstPtr&)
+        {
+          moveit_msgs::MoveGroupResult result;
+          result.error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
+          endpoint_ptr->move_group->setSucceeded(result);
+        }
+      , false);
+      endpoint->execute_trajectory = std::make_unique<ExecuteTrajectoryServer>(nh, "execute_trajectory"
+      , [endpoint_ptr](const moveit_msgs::ExecuteTrajectoryGoalConstPtr&)
+        {
+          moveit_msgs::ExecuteTrajectoryResult result;
+          result.error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
+          endpoint_ptr->execute_trajectory->setSucceeded(result);
+        }
+      , false);
+      endpoint->pickup = std::make_unique<PickupServer>(nh, "pickup"
+      , [endpoint_ptr](const moveit_msgs::PickupGoalConstPtr&)
+        {
+          moveit_msgs::PickupResult result;
+          result.error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
+          endpoint_ptr->pickup->setSucceeded(result);
+        }
+      , false);
+      endpoint->place = std::make_unique<PlaceServer>(nh, "place"
+      , [endpoint_ptr](const moveit_msgs::PlaceGoalConstPtr&)
+        {
+          moveit_msgs::PlaceResult result;
+          result.error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
+          endpoint_ptr->place->setSucceeded(result);
+        }
+      , false);
+      endpoint->move_group->start();
+      endpoint->execute_trajectory->start();
+      endpoint->pickup->start();
+      endpoint->place->start();
+
+      endpoint->services.push_back(nh.advertiseService<moveit_msgs::QueryPlannerInterfaces::Request, moveit_msgs::QueryPlannerInterfaces::Response>("query_planner_interface"
+      , [](moveit_msgs::QueryPlannerInterfaces::Request&, moveit_msgs::QueryPlannerInterfaces::Response& res)
+        {
+          moveit_msgs::PlannerInterfaceDescription planner_interface;
+          planner_interface.name = "mock_planner";
+          planner_interface.planner_ids = {"RRTConnectkConfigDefault"};
+          res.planner_interfaces.push_back(planner_interface);
+          return true;
+        }));
+      endpoint->services.push_back(nh.advertiseService<moveit_msgs::GetPlannerParams::Request, moveit_msgs::GetPlannerParams::Response>("get_planner_params"
+      , [](moveit_msgs::GetPlannerParams::Request&, moveit_msgs::GetPlannerParams::Response&)
+        {
+          return true;
+        }));
+      endpoint->services.push_back(nh.advertiseService<moveit_msgs::SetPlannerParams::Request, moveit_msgs::SetPlannerParams::Response>("set_planner_params"
+      , [](moveit_msgs::SetPlannerParams::Request&, moveit_msgs::SetPlannerParams::Response&)
+        {
+          return true;
+        }));
+      endpoint->services.push_back(nh.advertiseService<moveit_msgs::GetCartesianPath::Request, moveit_msgs::GetCartesianPath::Response>("compute_cartesian_path"
+      , [](moveit_msgs::GetCartesianPath::Request&, moveit_msgs::GetCartesianPath::Response& res)
+        {
+          res.error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
+          return true;
+        }));
+    }
+
+    std::lock_guard<std::mutex> lock(endpoints_mutex_);
+    endpoints_[req.ros_namespace + "/" + req.executable] = std::move(endpoint);
+  }
+
+  void unloadCb(temoto_er_manager::LoadExtResource::Request& req, temoto_er_manager::LoadExtResource::Response& res)
+  {
+    std::unique_ptr<Endpoint> endpoint;
+    {
+      std::lock_guard<std::mutex> lock(endpoints_mutex_);
+      auto endpoint_it = endpoints_.find(req.ros_namespace + "/" + req.executable);
+      if (endpoint_it == endpoints_.end())
+      {
+        return;
+      }
+      endpoint = std::move(endpoint_it->second);
+      endpoints_.erase(endpoint_it);
+    }
+
+    for (const auto& param : endpoint->params)
+    {
+      ros::param::del(param);
+    }
+  }
+
+  temoto_resource_registrar::ResourceRegistrarRos1 resource_registrar_;
+  std::map<std::string, std::unique_ptr<Endpoint>> endpoints_;
+  std::mutex endpoints_mutex_;
+};
+
+/**
+ * @brief Stands in for a robot manager in another temoto namespace, which accepts the
+ * forwarded loads and answers the forwarded manipulation target requests
+ */
+class MockRemoteManager
+{
+public:
+  MockRemoteManager()
+  : resource_registrar_(REMOTE_NAMESPACE + "/" + srv_name::MANAGER)
+  , nh_("/" + REMOTE_NAMESPACE)
+  {
+    auto server = std::make_unique<Ros1Server<RobotLoad>>(srv_name::SERVER_LOAD
+    , [](RobotLoad::Request&, RobotLoad::Response&){}
+    , [](RobotLoad::Request&, RobotLoad::Response&){});
+    resource_registrar_.registerServer(std::move(server));
+    resource_registrar_.init();
+
+    server_get_target_ = nh_.advertiseService(srv_name::SERVER_GET_MANIPULATION_TARGET
+    , &MockRemoteManager::getManipulationTargetCb
+    , this);
+
+    // Keeps the lease of the simulated manager alive
+    host_status_pub_ = nh_.advertise<HostStatus>(srv_name::HOST_STATUS_TOPIC, 10);
+    host_status_timer_ = nh_.createWallTimer(ros::WallDuration(1.0), [this](const ros::WallTimerEvent&)
+    {
+      HostStatus status;
+      status.temoto_namespace = REMOTE_NAMESPACE;
+      host_status_pub_.publish(status);
+    });
+  }
+
+private:
+  bool getManipulationTargetCb(RobotGetTarget::Request& req, RobotGetTarget::Response& res)
+  {
+    res.pose.orientation.w = 1.0;
+    res.success = true;
+    return true;
+  }
+
+  temoto_resource_registrar::ResourceRegistrarRos1 resource_registrar_;
+  ros::NodeHandle nh_;
+  ros::ServiceServer server_get_target_;
+  ros::Publisher host_status_pub_;
+  ros::WallTimer host_status_timer_;
+};
+} // namespace
+
+struct BenchmarkOptions
+{
+  unsigned int robots = 10;
+  unsigned int clients = 4;
+  double duration = 2.0;
+  unsigned int sync_rounds = 5;
+  std::vector<unsigned int> sync_sizes{10, 100, 1000};
+  bool manipulation = false;
+  std::string work_dir;
+};
+
+/**
+ * @brief Drives the measurements. The config sync is measured by invoking the sync callback
+ * of the manager directly, so that the transport of the synchronizer is not part of it
+ */
+class RobotManagerBenchmark
+{
+public:
+  RobotManagerBenchmark(const BenchmarkOptions& options)
+  : options_(options)
+  , client_registrar_("robot_manager_benchmark")
+  {
+    client_registrar_.init();
+  }
+
+  ~RobotManagerBenchmark()
+  {
+    removeRobotDescriptions();
+  }
+
+  void run(std::ostream& out)
+  {
+    writeRobotDescriptions();
+
+    auto start_time = Clock::now();
+    RobotManager manager(descriptions_dir_, false, 0.0, true);
+    BenchmarkResult discovery{"discovery"};
+    discovery.parameters["robots"] = options_.robots;
+    discovery.samples.push_back(getSeconds(start_time));
+    discovery.elapsed = discovery.samples.back();
+    results_.push_back(discovery);
+
+    ros::service::waitForService(srv_name::SERVER_GET_CONFIG);
+    measureLoad();
+    measureSync(manager);
+    measureThroughput("get_config_throughput", srv_name::SERVER_GET_CONFIG, RobotGetConfig());
+    measureThroughput("find_loaded_robot_throughput", srv_name::SERVER_GET_VIZ_INFO, RobotGetVizInfo());
+    measureForwarding(manager);
+
+    RobotGetMetrics metrics_srvc;
+    ros::service::call(srv_name::SERVER_GET_METRICS, metrics_srvc);
+    unloadRobots();
+    removeRobotDescriptions();
+
+    writeResults(out, metrics_srvc.response.metrics);
+  }
+
+private:
+  std::string getRobotName(unsigned int index) const
+  {
+    return "bench_robot_" + std::to_string(index);
+  }
+
+  YAML::Node makeRobotConfig(const std::string& robot_name) const
+  {
+    YAML::Node config;
+    config["robot_name"] = robot_name;
+    config["description"] = "Simulated robot of the robot manager benchmark";
+    config["navigation"]["driver"]["package_name"] = MOCK_PACKAGE;
+    config["navigation"]["driver"]["executable"] = MOCK_NAVIGATION_DRIVER;
+    config["navigation"]["controller"]["package_name"] = MOCK_PACKAGE;
+    config["navigation"]["controller"]["executable"] = MOCK_MOVE_BASE;
+    if (options_.manipulation)
+    {
+      config["manipulation"]["driver"]["package_name"] = MOCK_PACKAGE;
+      config["manipulation"]["driver"]["executable"] = MOCK_MANIPULATION_DRIVER;
+      config["manipulation"]["controller"]["package_name"] = MOCK_PACKAGE;
+      config["manipulation"]["controller"]["executable"] = MOCK_MOVE_GROUP;
+      config["manipulation"]["controller"]["planning_groups"].push_back("arm");
+    }
+    return config;
+  }
+
+  /*
+   * One robot_description.yaml per robot, so that the discovery reads as many files. They
+   * are written into a new directory under the work directory, which is all that is removed
+   */
+  void writeRobotDescriptions()
+  {
+    descriptions_dir_ = (boost::filesystem::path(options_.work_dir)
+      / boost::filesystem::unique_path("robot_manager_benchmark_%%%%-%%%%-%%%%")).string();
+    for (unsigned int i = 0; i < options_.robots; i++)
+    {
+      std::string robot_dir = descriptions_dir_ + "/" + getRobotName(i);
+      boost::filesystem::create_directories(robot_dir);
+
+      YAML::Node description;
+      description["Robots"].push_back(makeRobotConfig(getRobotName(i)));
+      std::ofstream(robot_dir + "/robot_description.yaml") << YAML::Dump(description);
+    }
+  }
+
+  void removeRobotDescriptions()
+  {
+    if (descriptions_dir_.empty())
+    {
+      return;
+    }
+    boost::system::error_code error_code;
+    boost::filesystem::remove_all(descriptions_dir_, error_code);
+    descriptions_dir_.clear();
+  }
+
+  void measureLoad()
+  {
+    BenchmarkResult cold_load{"cold_load"};
+    cold_load.parameters["manipulation"] = options_.manipulation;
+    auto start_time = Clock::now();
+    for (unsigned int i = 0; i < options_.robots; i++)
+    {
+      RobotLoad load_srvc;
+      load_srvc.request.robot_name = getRobotName(i);
+      auto load_start_time = Clock::now();
+      try
+      {
+        client_registrar_.call<RobotLoad>(srv_name::MANAGER, srv_name::SERVER_LOAD, load_srvc);
+        cold_load.samples.push_back(getSeconds(load_start_time));
+        load_request_ids_.push_back(load_srvc.response.temoto_metadata.request_id);
+      }
+      catch (const resource_registrar::TemotoErrorStack& e)
+      {
+        std::cerr << "Failed to load '" << load_srvc.request.robot_name << "': " << e.what() << std::endl;
+        cold_load.failures++;
+      }
+    }
+    cold_load.elapsed = getSeconds(start_time);
+    results_.push_back(cold_load);
+  }
+
+  void unloadRobots()
+  {
+    for (const auto& request_id : load_request_ids_)
+    {
+      client_registrar_.unload(srv_name::MANAGER, request_id);
+    }
+  }
+
+  PayloadType makeSyncPayload(unsigned int config_count, unsigned int revision) const
+  {
+    RobotConfigSync config_sync;
+    config_sync.epoch = 1;
+    for (unsigned int i = 0; i < config_count; i++)
+    {
+      RobotConfigEntry entry;
+      entry.robot_name = "bench_sync_robot_" + std::to_string(i);
+      entry.revision = revision;
+      entry.reliability = 0.8;
+      entry.yaml_config = YAML::Dump(makeRobotConfig(entry.robot_name));
+      config_sync.configs.push_back(entry);
+    }
+    return encodeConfigSync(config_sync);
+  }
+
+  /*
+   * The first advertisement of each round carries a newer revision of every config, hence
+   * all of them are parsed. The repeated advertisement carries the same revisions
+   */
+  void measureSync(RobotManager& manager)
+  {
+    for (unsigned int config_count : options_.sync_sizes)
+    {
+      temoto_core::ConfigSync msg;
+      msg.action = temoto_core::trr::sync_action::ADVERTISE_CONFIG;
+      msg.temoto_namespace = "robot_manager_benchmark_sync_" + std::to_string(config_count);
+
+      BenchmarkResult changed{"sync_changed"};
+      BenchmarkResult unchanged{"sync_unchanged"};
+      changed.parameters["configs"] = config_count;
+      unchanged.parameters["configs"] = config_count;
+      for (unsigned int round = 1; round <= options_.sync_rounds; round++)
+      {
+        PayloadType payload = makeSyncPayload(config_count, round);
+
+        auto start_time = Clock::now();
+        manager.syncCb(msg, payload);
+        changed.samples.push_back(getSeconds(start_time));
+        changed.elapsed += changed.samples.back();
+
+        start_time = Clock::now();
+        manager.syncCb(msg, payload);
+        unchanged.samples.push_back(getSeconds(start_time));
+        unchanged.elapsed += unchanged.samples.back();
+      }
+      results_.push_back(changed);
+      results_.push_back(unchanged);
+    }
+  }
+
+  /**
+   * @brief Calls the service from concurrent clients, each with a persistent connection,
+   * for the configured duration. The robots are requested in turns
+   */
+  template <class ServiceType>
+  void measureThroughput(const std::string& name, const std::string& service_name, ServiceType srv)
+  {
+    BenchmarkResult result{name};
+    result.parameters["clients"] = options_.clients;
+    std::mutex result_mutex;
+    std::vector<std::thread> clients;
+
+    auto start_time = Clock::now();
+    for (unsigned int c = 0; c < options_.clients; c++)
+    {
+      clients.emplace_back([&, c, srv]() mutable
+      {
+        ros::NodeHandle nh;
+        ros::ServiceClient client = nh.serviceClient<ServiceType>(service_name, true);
+        std::vector<double> samples;
+        unsigned int failures = 0;
+        for (unsigned int i = c; getSeconds(start_time) < options_.duration; i++)
+        {
+          srv.request.robot_name = getRobotName(i % std::max(1u, options_.robots));
+          auto call_start_time = Clock::now();
+          if (client.call(srv) && srv.response.success)
+          {
+            samples.push_back(getSeconds(call_start_time));
+          }
+          else
+          {
+            failures++;
+          }
+        }
+
+        std::lock_guard<std::mutex> lock(result_mutex);
+        result.samples.insert(result.samples.end(), samples.begin(), samples.end());
+        result.failures += failures;
+      });
+    }
+
+    for (auto& client : clients)
+    {
+      client.join();
+    }
+    result.elapsed = getSeconds(start_time);
+    results_.push_back(result);
+  }
+
+  /*
+   * Loads a robot of the simulated remote manager and compares calling the remote manager
+   * directly with calling it through the forwarding of the local manager
+   */
+  void measureForwarding(RobotManager& manager)
+  {
+    remote_manager_ = std::make_unique<MockRemoteManager>();
+
+    temoto_core::ConfigSync msg;
+    msg.action = temoto_core::trr::sync_action::ADVERTISE_CONFIG;
+    msg.temoto_namespace = REMOTE_NAMESPACE;
+    RobotConfigSync config_sync;
+    config_sync.epoch = 1;
+    RobotConfigEntry entry;
+    entry.robot_name = REMOTE_ROBOT_NAME;
+    entry.revision = 1;
+    entry.reliability = 0.8;
+    entry.yaml_config = YAML::Dump(makeRobotConfig(REMOTE_ROBOT_NAME));
+    config_sync.configs.push_back(entry);
+    manager.syncCb(msg, encodeConfigSync(config_sync));
+
+    RobotLoad load_srvc;
+    load_srvc.request.robot_name = REMOTE_ROBOT_NAME;
+    try
+    {
+      client_registrar_.call<RobotLoad>(srv_name::MANAGER, srv_name::SERVER_LOAD, load_srvc);
+      load_request_ids_.push_back(load_srvc.response.temoto_metadata.request_id);
+    }
+    catch (const resource_registrar::TemotoErrorStack& e)
+    {
+      std::cerr << "Failed to load the remote robot: " << e.what() << std::endl;
+      return;
+    }
+
+    ros::NodeHandle nh;
+    ros::ServiceClient direct_client = nh.serviceClient<RobotGetTarget>("/" + REMOTE_NAMESPACE + "/"
+      + srv_name::SERVER_GET_MANIPULATION_TARGET, true);
+    ros::ServiceClient forwarded_client = nh.serviceClient<RobotGetTarget>(srv_name::SERVER_GET_MANIPULATION_TARGET, true);
+
+    BenchmarkResult direct{"remote_call_direct"};
+    BenchmarkResult forwarded{"remote_call_forwarded"};
+    for (auto* measurement : {&direct, &forwarded})
+    {
+      ros::ServiceClient& client = (measurement == &direct) ? direct_client : forwarded_client;
+      auto start_time = Clock::now();
+      while (getSeconds(start_time) < options_.duration)
+      {
+        RobotGetTarget get_target_srvc;
+        get_target_srvc.request.robot_name = REMOTE_ROBOT_NAME;
+        auto call_start_time = Clock::now();
+        if (client.call(get_target_srvc) && get_target_srvc.response.success)
+        {
+          measurement->samples.push_back(getSeconds(call_start_time));
+        }
+        else
+        {
+          measurement->failures++;
+        }
+      }
+      measurement->elapsed = getSeconds(start_time);
+    }
+    results_.push_back(direct);
+    results_.push_back(forwarded);
+  }
+
+  void writeResults(std::ostream& out, const RobotManagerMetrics& metrics) const
+  {
+    out << "{\n  \"benchmark\": \"temoto_robot_manager\",\n"
+        << "  \"parameters\": {\"robots\": " << options_.robots
+        << ", \"clients\": " << options_.clients
+        << ", \"duration\": " << options_.duration
+        << ", \"sync_rounds\": " << options_.sync_rounds
+        << ", \"manipulation\": " << (options_.manipulation ? "true" : "false") << "},\n"
+        << "  \"results\": [\n";
+    for (size_t i = 0; i < results_.size(); i++)
+    {
+      writeResult(out, results_[i]);
+      out << ((i + 1 < results_.size()) ? ",\n" : "\n");
+    }
+
+    // The spans recorded by the manager break the results down into stages
+    out << "  ],\n  \"spans\": [\n";
+    for (size_t i = 0; i < metrics.operations.size(); i++)
+    {
+      const OperationMetrics& operation = metrics.operations[i];
+      out << "    {\"subject\": " << toJson(operation.subject)
+          << ", \"operation\": " << toJson(operation.operation)
+          << ", \"count\": " << operation.count
+          << ", \"failures\": " << operation.failures
+          << ", \"mean\": " << operation.mean
+          << ", \"p50\": " << operation.p50
+          << ", \"p99\": " << operation.p99
+          << ", \"max\": " << operation.max << "}"
+          << ((i + 1 < metrics.operations.size()) ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+  }
+
+  BenchmarkOptions options_;
+  temoto_resource_registrar::ResourceRegistrarRos1 client_registrar_;
+  std::vector<std::string> load_request_ids_;
+  std::vector<BenchmarkResult> results_;
+  std::string descriptions_dir_;
+
+  // Kept until the forwarded robot has been unloaded
+  std::unique_ptr<MockRemoteManager> remote_manager_;
+};
+
+} // namespace temoto_robot_manager
+
+using namespace temoto_robot_manager;
+
+int main(int argc, char** argv)
+{
+  namespace po = boost::program_options;
+  BenchmarkOptions options;
+  std::string sync_sizes;
+  std::string output;
+
+  po::variables_map vm;
+  po::options_description desc("Allowed options");
+  desc.add_options()
+    ("robots", po::value<unsigned int>(&options.robots)->default_value(10), "Number of simulated robots.")
+    ("clients", po::value<unsigned int>(&options.clients)->default_value(4), "Number of concurrent service clients.")
+    ("duration", po::value<double>(&options.duration)->default_value(2.0), "Duration of each throughput measurement [s].")
+    ("sync-sizes", po::value<std::string>(&sync_sizes)->default_value("10,100,1000"), "Numbers of remote configs per sync measurement.")
+    ("sync-rounds", po::value<unsigned int>(&options.sync_rounds)->default_value(5), "Advertisements per sync measurement.")
+    ("manipulation", "Give the simulated robots a manipulator with a mock move_group.")
+    ("work-dir", po::value<std::string>(&options.work_dir)->default_value("/tmp/robot_manager_benchmark"), "Directory under which the robot descriptions are generated.")
+    ("output", po::value<std::string>(&output), "Write the JSON results into this file instead of stdout.")
+    ("help", "Show this message.");
+
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  po::notify(vm);
+  if (vm.count("help"))
+  {
+    std::cout << desc;
+    return 0;
+  }
+  options.manipulation = vm.count("manipulation");
+
+  options.sync_sizes.clear();
+  std::stringstream sync_sizes_stream(sync_sizes);
+  std::string sync_size;
+  while (std::getline(sync_sizes_stream, sync_size, ','))
+  {
+    options.sync_sizes.push_back(std::stoul(sync_size));
+  }
+
+  TEMOTO_LOG_ATTR.initialize("robot_manager");
+  ros::init(argc, argv, "robot_manager_benchmark");
+
+  // The clients and the mock endpoints are served by the same process
+  ros::AsyncSpinner spinner(options.clients + 4);
+  spinner.start();
+
+  MockErManager er_manager;
+  RobotManagerBenchmark benchmark(options);
+  if (output.empty())
+  {
+    benchmark.run(std::cout);
+  }
+  else
+  {
+    std::ofstream out(output);
+    benchmark.run(out);
+  }
+
+  ros::shutdown();
+  return 0;
+}
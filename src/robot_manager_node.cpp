@@ -26,7 +26,13 @@ int main(int argc, char** argv)
   po::variables_map vm;
   po::options_description desc("Allowed options");
   desc.add_options()
-    ("config-base-path", po::value<std::string>(), "Base path to robot_description.yaml config file.");
+    ("config-base-path", po::value<std::string>(), "Base path to robot_description.yaml config file.")
+    ("spinner-threads", po::value<unsigned int>()->default_value(4), "Number of threads serving the requests.")
+    ("hot-reload", "Pick up added or changed robot_description.yaml files without a restart.")
+    ("robot-status-rate", po::value<double>()->default_value(10.0), "Rate (Hz) of publishing the state of the robots, 0 disables it.")
+    ("metrics", "Record the latencies of the services from the start.")
+    ("standby-min-memory", po::value<double>()->default_value(1024.0), "Available memory (MB) of the host below which warm standby robots are unloaded.")
+    ("standby-max-load", po::value<double>()->default_value(0.9), "Load average per core above which warm standby robots are unloaded.");
 
   po::store(po::parse_command_line(argc, argv, desc), vm);
   po::notify(vm);
@@ -46,10 +52,18 @@ int main(int argc, char** argv)
   TEMOTO_LOG_ATTR.initialize("robot_manager");
   ros::init(argc, argv, TEMOTO_LOG_ATTR.getSubsystemName());
 
+  WarmStandbyConfig warm_standby_config;
+  warm_standby_config.min_available_memory = vm["standby-min-memory"].as<double>();
+  warm_standby_config.max_cpu_load = vm["standby-max-load"].as<double>();
+
   // Create a SensorManager object
-  RobotManager rm(config_base_path);
+  RobotManager rm(config_base_path
+  , vm.count("hot-reload")
+  , vm["robot-status-rate"].as<double>()
+  , vm.count("metrics")
+  , warm_standby_config);
 
-  ros::AsyncSpinner spinner(4);
+  ros::AsyncSpinner spinner(vm["spinner-threads"].as<unsigned int>());
   spinner.start();
   ros::waitForShutdown();
 }
@@ -0,0 +1,50 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "temoto_robot_manager/robot_selection.h"
+
+namespace temoto_robot_manager
+{
+namespace
+{
+const double ROBOT_COST = 0.25;
+const double UNKNOWN_HOST_COST = 1.0;
+
+// A remote config has to score this much better than the local one to be chosen
+const double LOCAL_PREFERENCE = 0.1;
+}
+
+double getHostCost(const HostLoad& host_load)
+{
+  double robot_cost = ROBOT_COST * host_load.forwarded_loads;
+  if (!host_load.known)
+  {
+    return UNKNOWN_HOST_COST + robot_cost;
+  }
+  return host_load.cpu_load + robot_cost + ROBOT_COST * host_load.robots;
+}
+
+double getSelectionScore(double reliability, double host_cost)
+{
+  return reliability / (1.0 + host_cost);
+}
+
+bool isLocalPreferred(double local_score, double remote_score)
+{
+  return local_score >= (1.0 - LOCAL_PREFERENCE) * remote_score;
+}
+
+} // namespace temoto_robot_manager
@@ -0,0 +1,357 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "temoto_robot_manager/urdf_cache.h"
+#include "temoto_core/common/temoto_log_macros.h"
+#include <boost/filesystem/operations.hpp>
+#include <unistd.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <cstdlib>
+#include <functional>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <sys/wait.h>
+
+namespace temoto_robot_manager
+{
+namespace
+{
+const std::string CACHE_FILE_MAGIC = "temoto_urdf_cache_3";
+
+// FNV-1a, which unlike std::hash is the same across builds
+uint64_t getChecksum(const std::string& content)
+{
+  uint64_t checksum = 14695981039346656037ull;
+  for (unsigned char c : content)
+  {
+    checksum = (checksum ^ c) * 1099511628211ull;
+  }
+  return checksum;
+}
+
+bool readFile(const std::string& file_path, std::string& content)
+{
+  std::ifstream in(file_path, std::ios::binary);
+  if (!in)
+  {
+    return false;
+  }
+  std::stringstream content_stream;
+  content_stream << in.rdbuf();
+  content = content_stream.str();
+  return true;
+}
+
+// Runs the command and returns its standard output
+bool runCommand(const std::string& command, std::string& output)
+{
+  FILE* pipe = popen(command.c_str(), "r");
+  if (!pipe)
+  {
+    return false;
+  }
+
+  char buffer[4096];
+  size_t length;
+  output.clear();
+  while ((length = fread(buffer, 1, sizeof(buffer), pipe)) > 0)
+  {
+    output.append(buffer, length);
+  }
+
+  int status = pclose(pipe);
+  return status != -1 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+std::string quote(const std::string& argument)
+{
+  std::string quoted = "'";
+  for (char c : argument)
+  {
+    quoted += (c == '\'') ? std::string("'\\''") : std::string(1, c);
+  }
+  return quoted + "'";
+}
+
+// Quotes each whitespace separated argument
+std::string quoteArgs(const std::string& args)
+{
+  std::stringstream arg_stream(args);
+  std::string arg;
+  std::string quoted_args;
+  while (arg_stream >> arg)
+  {
+    quoted_args += " " + quote(arg);
+  }
+  return quoted_args;
+}
+
+// Separates the arguments by single spaces, so that they can be stored on one line
+std::string normalizeArgs(const std::string& args)
+{
+  std::stringstream arg_stream(args);
+  std::string arg;
+  std::string normalized_args;
+  while (arg_stream >> arg)
+  {
+    normalized_args += (normalized_args.empty() ? "" : " ") + arg;
+  }
+  return normalized_args;
+}
+
+// Names of the environment variables which the xacro refers to via $(env) or $(optenv)
+void findEnvironmentVariables(const std::string& content, std::set<std::string>& variables)
+{
+  static const std::regex env_regex("\\$\\(\\s*(?:env|optenv)\\s+([^\\s)]+)");
+  for (std::sregex_iterator it(content.begin(), content.end(), env_regex); it != std::sregex_iterator(); ++it)
+  {
+    variables.insert((*it)[1].str());
+  }
+}
+
+bool isXacro(const std::string& file_path)
+{
+  return boost::filesystem::path(file_path).extension() != ".urdf";
+}
+} // namespace
+
+UrdfCache::UrdfCache(const std::string& cache_dir, const std::string& xacro_command)
+: cache_dir_(cache_dir)
+, xacro_command_(xacro_command)
+{
+  if (!cache_dir_.empty())
+  {
+    boost::system::error_code error_code;
+    boost::filesystem::create_directories(cache_dir_, error_code);
+  }
+}
+
+bool UrdfCache::getRobotDescription(const std::string& file_path
+, const std::string& args
+, std::string& robot_description)
+{
+  if (!isXacro(file_path))
+  {
+    return readFile(file_path, robot_description);
+  }
+  if (!boost::filesystem::exists(file_path))
+  {
+    TEMOTO_WARN("Xacro file '%s' does not exist", file_path.c_str());
+    return false;
+  }
+  const std::string xacro_args = normalizeArgs(args);
+
+  std::shared_ptr<Entry> entry;
+  {
+    std::lock_guard<std::mutex> lock(entries_mutex_);
+    std::shared_ptr<Entry>& entry_slot = entries_[file_path + "\n" + xacro_args];
+    if (!entry_slot)
+    {
+      entry_slot = std::make_shared<Entry>();
+    }
+    entry = entry_slot;
+  }
+
+  // Robots with the same model wait for one expansion
+  std::lock_guard<std::mutex> entry_lock(entry->entry_mutex);
+  if (entry->robot_description.empty())
+  {
+    loadEntry(file_path, xacro_args, *entry);
+  }
+
+  if (entry->robot_description.empty()
+  || entry->content_hash != getContentHash(file_path, xacro_args, entry->dependencies))
+  {
+    TEMOTO_DEBUG("Expanding xacro '%s'", file_path.c_str());
+    if (!expandXacro(file_path, xacro_args, *entry))
+    {
+      entry->robot_description.clear();
+      return false;
+    }
+    saveEntry(file_path, xacro_args, *entry);
+  }
+
+  robot_description = entry->robot_description;
+  return true;
+}
+
+size_t UrdfCache::getContentHash(const std::string& file_path
+, const std::string& xacro_args
+, const std::vector<std::string>& dependencies) const
+{
+  std::string content;
+  if (!readFile(file_path, content))
+  {
+    return 0;
+  }
+
+  std::set<std::string> variables;
+  findEnvironmentVariables(content, variables);
+  std::string contents = xacro_args + "\n" + content;
+  for (const auto& dependency : dependencies)
+  {
+    if (!readFile(dependency, content))
+    {
+      return 0;
+    }
+    findEnvironmentVariables(content, variables);
+    contents += dependency + content;
+  }
+
+  for (const auto& variable : variables)
+  {
+    const char* value = std::getenv(variable.c_str());
+    contents += variable + (value ? "=" + std::string(value) : std::string(" unset"));
+  }
+  return std::hash<std::string>()(contents);
+}
+
+bool UrdfCache::expandXacro(const std::string& file_path, const std::string& xacro_args, Entry& entry) const
+{
+  // The arguments may select the included files
+  std::string xacro_command = xacro_command_ + " --inorder";
+  std::string dependencies;
+  if (!runCommand(xacro_command + " --deps " + quote(file_path) + quoteArgs(xacro_args) + " 2>/dev/null", dependencies))
+  {
+    TEMOTO_WARN("Could not get the dependencies of '%s'", file_path.c_str());
+    return false;
+  }
+
+  entry.dependencies.clear();
+  std::stringstream dependency_stream(dependencies);
+  std::string dependency;
+  while (dependency_stream >> dependency)
+  {
+    entry.dependencies.push_back(dependency);
+  }
+
+  // The hash is taken before the expansion, hence a file changed meanwhile is expanded again next time
+  entry.content_hash = getContentHash(file_path, xacro_args, entry.dependencies);
+  if (!runCommand(xacro_command + " " + quote(file_path) + quoteArgs(xacro_args), entry.robot_description)
+  || entry.robot_description.empty())
+  {
+    TEMOTO_WARN("Could not expand '%s'", file_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+std::string UrdfCache::getCacheFilePath(const std::string& file_path, const std::string& xacro_args) const
+{
+  return cache_dir_ + "/" + std::to_string(std::hash<std::string>()(file_path + "\n" + xacro_args)) + ".urdf";
+}
+
+bool UrdfCache::loadEntry(const std::string& file_path, const std::string& xacro_args, Entry& entry) const
+{
+  if (cache_dir_.empty())
+  {
+    return false;
+  }
+
+  /*
+   * The cache file holds the magic, the path of the xacro file, the xacro arguments, the
+   * content hash, the number of dependencies, the length and the checksum of the URDF, the
+   * dependencies, one per line, followed by the URDF
+   */
+  std::ifstream in(getCacheFilePath(file_path, xacro_args), std::ios::binary);
+  std::string line;
+  size_t content_hash = 0;
+  size_t dependency_count = 0;
+  size_t description_length = 0;
+  uint64_t description_checksum = 0;
+  if (!std::getline(in, line) || line != CACHE_FILE_MAGIC
+  || !std::getline(in, line) || line != file_path
+  || !std::getline(in, line) || line != xacro_args
+  || !(in >> content_hash >> dependency_count >> description_length >> description_checksum)
+  || in.get() != '\n')
+  {
+    return false;
+  }
+
+  std::vector<std::string> dependencies;
+  for (size_t i = 0; i < dependency_count; i++)
+  {
+    if (!std::getline(in, line))
+    {
+      return false;
+    }
+    dependencies.push_back(line);
+  }
+
+  // A truncated or otherwise damaged URDF is expanded again
+  std::stringstream robot_description;
+  robot_description << in.rdbuf();
+  if (robot_description.str().size() != description_length
+  || getChecksum(robot_description.str()) != description_checksum)
+  {
+    TEMOTO_WARN("The URDF cache file of '%s' is damaged", file_path.c_str());
+    return false;
+  }
+
+  entry.content_hash = content_hash;
+  entry.dependencies = dependencies;
+  entry.robot_description = robot_description.str();
+  return true;
+}
+
+void UrdfCache::saveEntry(const std::string& file_path, const std::string& xacro_args, const Entry& entry) const
+{
+  if (cache_dir_.empty())
+  {
+    return;
+  }
+
+  // A unique temporary file, so that the managers sharing the cache cannot interleave
+  std::string cache_file_path = getCacheFilePath(file_path, xacro_args);
+  std::string tmp_file_path = cache_file_path + ".XXXXXX";
+  int tmp_fd = mkstemp(&tmp_file_path[0]);
+  if (tmp_fd < 0)
+  {
+    TEMOTO_WARN("Could not create a temporary file for the URDF cache file '%s'", cache_file_path.c_str());
+    return;
+  }
+  close(tmp_fd);
+
+  {
+    std::ofstream out(tmp_file_path, std::ios::binary | std::ios::trunc);
+    out << CACHE_FILE_MAGIC << "\n" << file_path << "\n" << xacro_args << "\n" << entry.content_hash
+        << " " << entry.dependencies.size() << " " << entry.robot_description.size()
+        << " " << getChecksum(entry.robot_description) << "\n";
+    for (const auto& dependency : entry.dependencies)
+    {
+      out << dependency << "\n";
+    }
+    out << entry.robot_description;
+
+    if (!out)
+    {
+      TEMOTO_WARN("Could not write the URDF cache file '%s'", tmp_file_path.c_str());
+      std::remove(tmp_file_path.c_str());
+      return;
+    }
+  }
+
+  if (std::rename(tmp_file_path.c_str(), cache_file_path.c_str()) != 0)
+  {
+    TEMOTO_WARN("Could not replace the URDF cache file '%s'", cache_file_path.c_str());
+    std::remove(tmp_file_path.c_str());
+  }
+}
+
+} // namespace temoto_robot_manager
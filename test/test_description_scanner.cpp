@@ -0,0 +1,133 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "temoto_robot_manager/description_scanner.h"
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+#include <fstream>
+
+using namespace temoto_robot_manager;
+namespace fs = boost::filesystem;
+
+namespace
+{
+class DescriptionScannerTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    work_dir_ = fs::temp_directory_path() / fs::unique_path("temoto_scanner_test_%%%%%%%%");
+    base_dir_ = work_dir_ / "robots";
+    fs::create_directories(base_dir_);
+    cache_file_path_ = (work_dir_ / "descriptions.cache").string();
+  }
+
+  void TearDown() override
+  {
+    boost::system::error_code error_code;
+    fs::remove_all(work_dir_, error_code);
+  }
+
+  std::string addDescription(const std::string& robot_dir)
+  {
+    fs::path dir = base_dir_ / robot_dir;
+    fs::create_directories(dir);
+    fs::path description = dir / "robot_description.yaml";
+    std::ofstream(description.string()) << "Robots: []\n";
+    return description.string();
+  }
+
+  fs::path work_dir_;
+  fs::path base_dir_;
+  std::string cache_file_path_;
+};
+} // namespace
+
+TEST(DescriptionScannerCacheName, DependsOnNamespaceAndBasePath)
+{
+  std::string name = DescriptionScanner::makeCacheFileName("ns_a", "/robots");
+  EXPECT_EQ(name, DescriptionScanner::makeCacheFileName("ns_a", "/robots"));
+  EXPECT_NE(name, DescriptionScanner::makeCacheFileName("ns_b", "/robots"));
+  EXPECT_NE(name, DescriptionScanner::makeCacheFileName("ns_a", "/other_robots"));
+}
+
+TEST(DescriptionScannerCacheName, IsAPlainFileName)
+{
+  std::string name = DescriptionScanner::makeCacheFileName("/temoto/ns a", "/robots");
+  EXPECT_EQ(name.find('/'), std::string::npos);
+  EXPECT_EQ(name.find(' '), std::string::npos);
+}
+
+TEST_F(DescriptionScannerTest, FindsDescriptions)
+{
+  std::string description_a = addDescription("robot_a");
+  std::string description_b = addDescription("group/robot_b");
+  fs::create_directories(base_dir_ / "empty");
+
+  DescriptionScanner scanner(base_dir_.string(), cache_file_path_, 2);
+  std::vector<std::string> descriptions = scanner.scan();
+  ASSERT_EQ(descriptions.size(), 2u);
+  EXPECT_EQ(descriptions[0], description_b);
+  EXPECT_EQ(descriptions[1], description_a);
+}
+
+TEST_F(DescriptionScannerTest, CachedScanMatchesFullScan)
+{
+  addDescription("robot_a");
+  addDescription("group/robot_b");
+
+  std::vector<std::string> full_scan = DescriptionScanner(base_dir_.string(), cache_file_path_).scan();
+  EXPECT_TRUE(fs::exists(cache_file_path_));
+  std::vector<std::string> cached_scan = DescriptionScanner(base_dir_.string(), cache_file_path_).scan();
+  EXPECT_EQ(full_scan, cached_scan);
+}
+
+TEST_F(DescriptionScannerTest, LeavesNoTemporaryFiles)
+{
+  addDescription("robot_a");
+  DescriptionScanner(base_dir_.string(), cache_file_path_).scan();
+  DescriptionScanner(base_dir_.string(), cache_file_path_).scan();
+
+  unsigned int file_count = 0;
+  for (fs::directory_iterator file_it(work_dir_); file_it != fs::directory_iterator(); ++file_it)
+  {
+    file_count += fs::is_regular_file(file_it->path());
+  }
+  EXPECT_EQ(file_count, 1u);
+}
+
+TEST_F(DescriptionScannerTest, IgnoresCacheOfAnotherBasePath)
+{
+  addDescription("robot_a");
+  DescriptionScanner(base_dir_.string(), cache_file_path_).scan();
+
+  fs::path other_base_dir = work_dir_ / "other_robots";
+  fs::create_directories(other_base_dir);
+  EXPECT_TRUE(DescriptionScanner(other_base_dir.string(), cache_file_path_).scan().empty());
+}
+
+TEST_F(DescriptionScannerTest, WorksWithoutCache)
+{
+  addDescription("robot_a");
+  EXPECT_EQ(DescriptionScanner(base_dir_.string()).scan().size(), 1u);
+  EXPECT_FALSE(fs::exists(cache_file_path_));
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,185 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "temoto_robot_manager/metrics.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+using namespace temoto_robot_manager;
+
+namespace
+{
+// Copies the histogram of the operation, false if the operation was not recorded
+bool findOperation(const RobotManagerMetrics& metrics
+, const std::string& subject
+, const std::string& operation
+, OperationMetrics& operation_metrics)
+{
+  for (const auto& recorded_operation : metrics.operations)
+  {
+    if (recorded_operation.subject == subject && recorded_operation.operation == operation)
+    {
+      operation_metrics = recorded_operation;
+      return true;
+    }
+  }
+  return false;
+}
+} // namespace
+
+TEST(Metrics, AggregatesDurations)
+{
+  Metrics metrics(true);
+  metrics.record("robot", "load", 0.004, true);
+  metrics.record("robot", "load", 0.008, true);
+  metrics.record("robot", "load", 0.3, false);
+
+  OperationMetrics load;
+  ASSERT_TRUE(findOperation(metrics.getMetrics(), "robot", "load", load));
+  EXPECT_EQ(load.count, 3u);
+  EXPECT_EQ(load.failures, 1u);
+  EXPECT_DOUBLE_EQ(load.min, 0.004);
+  EXPECT_DOUBLE_EQ(load.max, 0.3);
+  EXPECT_NEAR(load.mean, (0.004 + 0.008 + 0.3) / 3, 1e-12);
+}
+
+TEST(Metrics, CountsDurationsIntoBuckets)
+{
+  Metrics metrics(true);
+  metrics.record("robot", "plan", 0.0005, true);
+  metrics.record("robot", "plan", 0.001, true);
+  metrics.record("robot", "plan", 0.0015, true);
+  metrics.record("robot", "plan", 1000.0, true);
+
+  OperationMetrics plan;
+  ASSERT_TRUE(findOperation(metrics.getMetrics(), "robot", "plan", plan));
+  ASSERT_EQ(plan.bucket_counts.size(), plan.bucket_bounds.size() + 1);
+  EXPECT_TRUE(std::is_sorted(plan.bucket_bounds.begin(), plan.bucket_bounds.end()));
+  EXPECT_EQ(std::accumulate(plan.bucket_counts.begin(), plan.bucket_counts.end(), uint64_t(0)), 4u);
+
+  // A duration on a bound belongs to the bucket of that bound
+  EXPECT_EQ(plan.bucket_counts[0], 2u);
+  EXPECT_EQ(plan.bucket_counts[1], 1u);
+
+  // Durations above the last bound go to the overflow bucket
+  EXPECT_EQ(plan.bucket_counts.back(), 1u);
+}
+
+TEST(Metrics, PercentilesFollowTheBuckets)
+{
+  Metrics metrics(true);
+  for (int i = 0; i < 90; i++)
+  {
+    metrics.record("robot", "execute", 0.0008, true);
+  }
+  for (int i = 0; i < 10; i++)
+  {
+    metrics.record("robot", "execute", 0.7, true);
+  }
+
+  OperationMetrics execute;
+  ASSERT_TRUE(findOperation(metrics.getMetrics(), "robot", "execute", execute));
+  EXPECT_DOUBLE_EQ(execute.p50, 0.001);
+  EXPECT_DOUBLE_EQ(execute.p90, 0.001);
+
+  // The percentiles do not exceed the largest recorded duration
+  EXPECT_DOUBLE_EQ(execute.p99, 0.7);
+  EXPECT_LE(execute.p50, execute.p90);
+  EXPECT_LE(execute.p90, execute.p99);
+}
+
+TEST(Metrics, PercentilesOfOverflowBucketAreMax)
+{
+  Metrics metrics(true);
+  metrics.record("robot", "load", 500.0, true);
+
+  OperationMetrics load;
+  ASSERT_TRUE(findOperation(metrics.getMetrics(), "robot", "load", load));
+  EXPECT_DOUBLE_EQ(load.p50, 500.0);
+  EXPECT_DOUBLE_EQ(load.p99, 500.0);
+}
+
+TEST(Metrics, FiltersBySubject)
+{
+  Metrics metrics(true);
+  metrics.record("first_robot", "load", 0.1, true);
+  metrics.record("second_robot", "load", 0.1, true);
+  metrics.record("second_robot", "unload", 0.1, true);
+
+  EXPECT_EQ(metrics.getMetrics().operations.size(), 3u);
+  RobotManagerMetrics second_robot = metrics.getMetrics("second_robot");
+  EXPECT_EQ(second_robot.operations.size(), 2u);
+  OperationMetrics first_robot_load;
+  EXPECT_FALSE(findOperation(second_robot, "first_robot", "load", first_robot_load));
+  EXPECT_TRUE(metrics.getMetrics("third_robot").operations.empty());
+}
+
+TEST(Metrics, ResetClearsHistograms)
+{
+  Metrics metrics(true);
+  metrics.record("robot", "load", 0.1, true);
+  metrics.reset();
+  EXPECT_TRUE(metrics.getMetrics().operations.empty());
+  EXPECT_TRUE(metrics.getMetrics().enabled);
+}
+
+TEST(ScopedSpan, RecordsOnlyWhenEnabled)
+{
+  Metrics metrics;
+  {
+    ScopedSpan span(metrics, "robot", "load");
+  }
+  EXPECT_FALSE(metrics.getMetrics().enabled);
+  EXPECT_TRUE(metrics.getMetrics().operations.empty());
+
+  metrics.setEnabled(true);
+  {
+    ScopedSpan span(metrics, "robot", "load", "urdf");
+  }
+  OperationMetrics load;
+  ASSERT_TRUE(findOperation(metrics.getMetrics(), "robot", "load/urdf", load));
+  EXPECT_EQ(load.count, 1u);
+  EXPECT_EQ(load.failures, 0u);
+}
+
+TEST(ScopedSpan, RecordsFailures)
+{
+  Metrics metrics(true);
+  {
+    ScopedSpan span(metrics, "robot", "plan");
+    span.setFailed();
+  }
+  try
+  {
+    ScopedSpan span(metrics, "robot", "plan");
+    throw std::runtime_error("planning failed");
+  }
+  catch (const std::runtime_error&)
+  {}
+
+  OperationMetrics plan;
+  ASSERT_TRUE(findOperation(metrics.getMetrics(), "robot", "plan", plan));
+  EXPECT_EQ(plan.count, 2u);
+  EXPECT_EQ(plan.failures, 2u);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
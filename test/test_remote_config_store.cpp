@@ -0,0 +1,167 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "temoto_robot_manager/remote_config_store.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+using namespace temoto_robot_manager;
+
+namespace
+{
+// Lease of the stores whose managers are let to expire
+const double SHORT_LEASE = 0.05;
+
+temoto_core::BaseSubsystem& getSubsystem()
+{
+  static temoto_core::BaseSubsystem subsystem("robot_manager", temoto_core::error::Subsystem::ROBOT_MANAGER, "test");
+  return subsystem;
+}
+
+RobotConfigPtr makeConfig(const std::string& temoto_namespace, const std::string& robot_name, float reliability)
+{
+  YAML::Node yaml_config;
+  yaml_config["robot_name"] = robot_name;
+  yaml_config["temoto_namespace"] = temoto_namespace;
+  yaml_config["description"] = "Test robot";
+  auto config = std::make_shared<RobotConfig>(yaml_config, getSubsystem());
+  config->resetReliability(reliability);
+  return config;
+}
+
+void waitForExpiry()
+{
+  std::this_thread::sleep_for(std::chrono::duration<double>(2 * SHORT_LEASE));
+}
+} // namespace
+
+TEST(RemoteConfigStore, ReportsNewLeases)
+{
+  RemoteConfigStore store(60.0);
+  EXPECT_TRUE(store.renewLease("ns_a"));
+  EXPECT_FALSE(store.renewLease("ns_a"));
+  EXPECT_FALSE(store.touch("ns_a"));
+  EXPECT_TRUE(store.touch("ns_b"));
+  EXPECT_FALSE(store.touch("ns_b"));
+  EXPECT_TRUE(store.isAlive("ns_a"));
+  EXPECT_TRUE(store.isAlive("ns_b"));
+  EXPECT_FALSE(store.isAlive("ns_c"));
+}
+
+TEST(RemoteConfigStore, SkipsAndEvictsExpiredManagers)
+{
+  RemoteConfigStore store(SHORT_LEASE);
+  store.renewLease("ns_a");
+  store.insert(makeConfig("ns_a", "robot", 0.9));
+  store.insert(makeConfig("ns_a", "robot_2", 0.5));
+  waitForExpiry();
+
+  store.renewLease("ns_b");
+  store.insert(makeConfig("ns_b", "robot", 0.5));
+
+  EXPECT_FALSE(store.isAlive("ns_a"));
+  EXPECT_EQ(store.findBest("robot")->getTemotoNamespace(), "ns_b");
+  EXPECT_EQ(store.findBest("robot_2"), nullptr);
+  EXPECT_EQ(store.findAll("robot").size(), 1u);
+  EXPECT_EQ(store.findBest("")->getTemotoNamespace(), "ns_b");
+
+  std::vector<std::string> evicted_namespaces = store.evictExpired();
+  ASSERT_EQ(evicted_namespaces.size(), 1u);
+  EXPECT_EQ(evicted_namespaces[0], "ns_a");
+  EXPECT_EQ(store.size(), 1u);
+  EXPECT_EQ(store.find("ns_a", "robot"), nullptr);
+  EXPECT_TRUE(store.evictExpired().empty());
+}
+
+TEST(RemoteConfigStore, RenewsExpiredLease)
+{
+  RemoteConfigStore store(SHORT_LEASE);
+  store.renewLease("ns_a");
+  waitForExpiry();
+
+  // Any message of a manager which holds a lease renews it
+  EXPECT_TRUE(store.touch("ns_a"));
+  EXPECT_TRUE(store.isAlive("ns_a"));
+  EXPECT_TRUE(store.evictExpired().empty());
+}
+
+TEST(RemoteConfigStore, KeepsManagersWithoutHeartbeat)
+{
+  RemoteConfigStore store(SHORT_LEASE);
+  store.touch("ns_a");
+  store.insert(makeConfig("ns_a", "robot", 0.5));
+  waitForExpiry();
+
+  EXPECT_TRUE(store.isAlive("ns_a"));
+  EXPECT_TRUE(store.evictExpired().empty());
+  EXPECT_NE(store.findBest("robot"), nullptr);
+
+  // Once the manager sends heartbeats, it holds a lease
+  EXPECT_FALSE(store.renewLease("ns_a"));
+  waitForExpiry();
+  EXPECT_FALSE(store.isAlive("ns_a"));
+  EXPECT_EQ(store.evictExpired().size(), 1u);
+}
+
+TEST(RemoteConfigStore, DropsConfigsOfNewEpoch)
+{
+  RemoteConfigStore store(60.0);
+  store.renewLease("ns_a");
+  uint64_t epoch = 0;
+  EXPECT_FALSE(store.getEpoch("ns_a", epoch));
+
+  size_t erased_count = 0;
+  EXPECT_TRUE(store.updateEpoch("ns_a", 1, erased_count));
+  EXPECT_EQ(erased_count, 0u);
+  store.insert(makeConfig("ns_a", "robot", 0.5));
+  store.insert(makeConfig("ns_b", "robot", 0.5));
+
+  EXPECT_FALSE(store.updateEpoch("ns_a", 1, erased_count));
+  EXPECT_EQ(store.size(), 2u);
+  ASSERT_TRUE(store.getEpoch("ns_a", epoch));
+  EXPECT_EQ(epoch, 1u);
+
+  EXPECT_TRUE(store.updateEpoch("ns_a", 2, erased_count));
+  EXPECT_EQ(erased_count, 1u);
+  EXPECT_EQ(store.find("ns_a", "robot"), nullptr);
+  EXPECT_NE(store.find("ns_b", "robot"), nullptr);
+  ASSERT_TRUE(store.getEpoch("ns_a", epoch));
+  EXPECT_EQ(epoch, 2u);
+}
+
+TEST(RemoteConfigStore, ReordersAfterReliabilityUpdate)
+{
+  RemoteConfigStore store(60.0);
+  store.renewLease("ns_a");
+  store.renewLease("ns_b");
+  auto config_a = makeConfig("ns_a", "robot", 0.9);
+  EXPECT_FALSE(store.insert(config_a));
+  store.insert(makeConfig("ns_b", "robot", 0.5));
+  EXPECT_EQ(store.findBest("robot"), config_a);
+
+  config_a->resetReliability(0.1);
+  store.updateReliability("robot");
+  EXPECT_EQ(store.findBest("robot")->getTemotoNamespace(), "ns_b");
+  EXPECT_EQ(store.findAll("robot").back(), config_a);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,123 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "temoto_robot_manager/robot_config_index.h"
+#include <gtest/gtest.h>
+
+using namespace temoto_robot_manager;
+
+namespace
+{
+temoto_core::BaseSubsystem& getSubsystem()
+{
+  static temoto_core::BaseSubsystem subsystem("robot_manager", temoto_core::error::Subsystem::ROBOT_MANAGER, "test");
+  return subsystem;
+}
+
+RobotConfigPtr makeConfig(const std::string& temoto_namespace, const std::string& robot_name, float reliability)
+{
+  YAML::Node yaml_config;
+  yaml_config["robot_name"] = robot_name;
+  yaml_config["temoto_namespace"] = temoto_namespace;
+  yaml_config["description"] = "Test robot";
+  auto config = std::make_shared<RobotConfig>(yaml_config, getSubsystem());
+  config->resetReliability(reliability);
+  return config;
+}
+} // namespace
+
+TEST(RobotConfigIndex, OrdersConfigsByReliability)
+{
+  RobotConfigIndex index;
+  index.insert(makeConfig("ns_a", "robot", 0.5));
+  index.insert(makeConfig("ns_b", "robot", 0.9));
+  index.insert(makeConfig("ns_c", "robot", 0.7));
+
+  const RobotConfigs& configs = index.findAll("robot");
+  ASSERT_EQ(configs.size(), 3u);
+  EXPECT_EQ(configs[0]->getTemotoNamespace(), "ns_b");
+  EXPECT_EQ(configs[1]->getTemotoNamespace(), "ns_c");
+  EXPECT_EQ(configs[2]->getTemotoNamespace(), "ns_a");
+  EXPECT_EQ(index.findBest("robot")->getTemotoNamespace(), "ns_b");
+}
+
+TEST(RobotConfigIndex, ReplacesConfigOfSameNamespace)
+{
+  RobotConfigIndex index;
+  EXPECT_FALSE(index.insert(makeConfig("ns_a", "robot", 0.5)));
+  auto replacement = makeConfig("ns_a", "robot", 0.6);
+  EXPECT_TRUE(index.insert(replacement));
+
+  EXPECT_EQ(index.size(), 1u);
+  EXPECT_EQ(index.find("ns_a", "robot"), replacement);
+}
+
+TEST(RobotConfigIndex, FindsBestOfAllRobotsWithoutName)
+{
+  RobotConfigIndex index;
+  index.insert(makeConfig("ns_a", "robot_1", 0.4));
+  index.insert(makeConfig("ns_a", "robot_2", 0.8));
+  index.insert(makeConfig("ns_b", "robot_3", 0.6));
+
+  EXPECT_EQ(index.findBest("")->getName(), "robot_2");
+  EXPECT_EQ(index.findBest("unknown"), nullptr);
+  EXPECT_TRUE(index.findAll("unknown").empty());
+}
+
+TEST(RobotConfigIndex, ErasesConfigs)
+{
+  RobotConfigIndex index;
+  auto config = makeConfig("ns_a", "robot", 0.5);
+  index.insert(config);
+  index.insert(makeConfig("ns_b", "robot", 0.5));
+
+  EXPECT_TRUE(index.erase(config));
+  EXPECT_FALSE(index.erase(config));
+  EXPECT_EQ(index.find("ns_a", "robot"), nullptr);
+  EXPECT_TRUE(index.contains("robot"));
+  EXPECT_EQ(index.size(), 1u);
+}
+
+TEST(RobotConfigIndex, ErasesNamespace)
+{
+  RobotConfigIndex index;
+  index.insert(makeConfig("ns_a", "robot_1", 0.5));
+  index.insert(makeConfig("ns_a", "robot_2", 0.5));
+  index.insert(makeConfig("ns_b", "robot_1", 0.5));
+
+  EXPECT_EQ(index.eraseNamespace("ns_a"), 2u);
+  EXPECT_EQ(index.size(), 1u);
+  EXPECT_FALSE(index.contains("robot_2"));
+  EXPECT_EQ(index.getConfigs().size(), 1u);
+}
+
+TEST(RobotConfigIndex, ReordersAfterReliabilityUpdate)
+{
+  RobotConfigIndex index;
+  auto config_a = makeConfig("ns_a", "robot", 0.9);
+  index.insert(config_a);
+  index.insert(makeConfig("ns_b", "robot", 0.5));
+
+  config_a->resetReliability(0.1);
+  index.updateReliability("robot");
+  EXPECT_EQ(index.findBest("robot")->getTemotoNamespace(), "ns_b");
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
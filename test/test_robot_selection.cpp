@@ -0,0 +1,86 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "temoto_robot_manager/robot_selection.h"
+#include <gtest/gtest.h>
+
+using namespace temoto_robot_manager;
+
+TEST(RobotSelection, ForwardedLoadsRaiseTheHostCost)
+{
+  HostLoad host_load;
+  host_load.known = true;
+  host_load.cpu_load = 0.5;
+  host_load.robots = 1;
+  double reported_cost = getHostCost(host_load);
+
+  host_load.forwarded_loads = 2;
+  EXPECT_GT(getHostCost(host_load), reported_cost);
+  EXPECT_DOUBLE_EQ(getHostCost(host_load) - reported_cost, 2 * getHostCost(HostLoad{true, 0.0, 1, 0}));
+}
+
+TEST(RobotSelection, ForwardedLoadsCountOnUnknownHosts)
+{
+  HostLoad unknown_host;
+  double unknown_cost = getHostCost(unknown_host);
+  EXPECT_GT(unknown_cost, 0.0);
+
+  unknown_host.forwarded_loads = 1;
+  EXPECT_GT(getHostCost(unknown_host), unknown_cost);
+}
+
+TEST(RobotSelection, UnknownHostsIgnoreTheReportedLoad)
+{
+  HostLoad unknown_host;
+  unknown_host.cpu_load = 10.0;
+  unknown_host.robots = 10;
+  EXPECT_DOUBLE_EQ(getHostCost(unknown_host), getHostCost(HostLoad()));
+}
+
+TEST(RobotSelection, BurstOfLoadsIsSpreadAcrossIdleHosts)
+{
+  // Two idle hosts with equally reliable configs, each load goes to the cheaper host
+  HostLoad hosts[2];
+  hosts[0].known = hosts[1].known = true;
+  for (unsigned int load = 0; load < 6; load++)
+  {
+    unsigned int selected = getSelectionScore(1.0, getHostCost(hosts[0])) >= getSelectionScore(1.0, getHostCost(hosts[1])) ? 0 : 1;
+    hosts[selected].forwarded_loads++;
+  }
+  EXPECT_EQ(hosts[0].forwarded_loads, 3u);
+  EXPECT_EQ(hosts[1].forwarded_loads, 3u);
+}
+
+TEST(RobotSelection, ScoreFollowsReliabilityAndCost)
+{
+  EXPECT_GT(getSelectionScore(0.9, 0.0), getSelectionScore(0.5, 0.0));
+  EXPECT_GT(getSelectionScore(0.9, 0.0), getSelectionScore(0.9, 1.0));
+  EXPECT_DOUBLE_EQ(getSelectionScore(0.0, 0.0), 0.0);
+}
+
+TEST(RobotSelection, LocalConfigIsPreferredWithinTheMargin)
+{
+  EXPECT_TRUE(isLocalPreferred(1.0, 1.0));
+  EXPECT_TRUE(isLocalPreferred(0.95, 1.0));
+  EXPECT_FALSE(isLocalPreferred(0.5, 1.0));
+  EXPECT_TRUE(isLocalPreferred(0.0, 0.0));
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
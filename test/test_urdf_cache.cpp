@@ -0,0 +1,232 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2019 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "temoto_robot_manager/urdf_cache.h"
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+using namespace temoto_robot_manager;
+namespace fs = boost::filesystem;
+
+namespace
+{
+/*
+ * Stands in for xacro: the URDF holds the content of the file and of the files listed in
+ * <file>.deps, the arguments and the environment variable TEMOTO_URDF_CACHE_TEST. Each
+ * expansion appends a line to the expansions file
+ */
+const std::string FAKE_XACRO =
+  "#!/bin/sh\n"
+  "[ \"$1\" = \"--inorder\" ] && shift\n"
+  "if [ \"$1\" = \"--deps\" ]; then cat \"$2.deps\" 2>/dev/null; exit 0; fi\n"
+  "file=\"$1\"; shift\n"
+  "echo \"$file\" >> \"$(dirname \"$0\")/expansions\"\n"
+  "cat \"$file\"\n"
+  "for dep in $(cat \"$file.deps\" 2>/dev/null); do cat \"$dep\"; done\n"
+  "echo \"args: $*\"\n"
+  "echo \"env: $TEMOTO_URDF_CACHE_TEST\"\n";
+
+class UrdfCacheTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    work_dir_ = fs::temp_directory_path() / fs::unique_path("temoto_urdf_cache_test_%%%%%%%%");
+    fs::create_directories(work_dir_);
+    cache_dir_ = (work_dir_ / "cache").string();
+    xacro_path_ = (work_dir_ / "xacro").string();
+    writeFile(xacro_path_, FAKE_XACRO);
+    fs::permissions(xacro_path_, fs::owner_all);
+    unsetenv("TEMOTO_URDF_CACHE_TEST");
+  }
+
+  void TearDown() override
+  {
+    unsetenv("TEMOTO_URDF_CACHE_TEST");
+    boost::system::error_code error_code;
+    fs::remove_all(work_dir_, error_code);
+  }
+
+  std::string writeFile(const std::string& file_name, const std::string& content)
+  {
+    fs::path file_path = fs::path(file_name).is_absolute() ? fs::path(file_name) : work_dir_ / file_name;
+    std::ofstream(file_path.string()) << content;
+    return file_path.string();
+  }
+
+  unsigned int getExpansionCount() const
+  {
+    std::ifstream in((work_dir_ / "expansions").string());
+    std::string line;
+    unsigned int count = 0;
+    while (std::getline(in, line))
+    {
+      count++;
+    }
+    return count;
+  }
+
+  std::unique_ptr<UrdfCache> makeCache(const std::string& cache_dir)
+  {
+    return std::unique_ptr<UrdfCache>(new UrdfCache(cache_dir, xacro_path_));
+  }
+
+  fs::path work_dir_;
+  std::string cache_dir_;
+  std::string xacro_path_;
+};
+} // namespace
+
+TEST_F(UrdfCacheTest, ReadsPlainUrdf)
+{
+  std::string urdf_path = writeFile("robot.urdf", "<robot name=\"plain\"/>");
+  std::string robot_description;
+  EXPECT_TRUE(makeCache(cache_dir_)->getRobotDescription(urdf_path, "", robot_description));
+  EXPECT_EQ(robot_description, "<robot name=\"plain\"/>");
+  EXPECT_EQ(getExpansionCount(), 0u);
+}
+
+TEST_F(UrdfCacheTest, FailsOnMissingFile)
+{
+  std::string robot_description;
+  EXPECT_FALSE(makeCache(cache_dir_)->getRobotDescription((work_dir_ / "missing.urdf").string(), "", robot_description));
+  EXPECT_FALSE(makeCache(cache_dir_)->getRobotDescription((work_dir_ / "missing.xacro").string(), "", robot_description));
+}
+
+TEST_F(UrdfCacheTest, ExpandsOnceForSameContent)
+{
+  std::string xacro_path = writeFile("robot.xacro", "robot\n");
+  auto urdf_cache = makeCache(cache_dir_);
+  std::string first_description;
+  std::string second_description;
+  ASSERT_TRUE(urdf_cache->getRobotDescription(xacro_path, "", first_description));
+  ASSERT_TRUE(urdf_cache->getRobotDescription(xacro_path, "", second_description));
+  EXPECT_EQ(first_description, second_description);
+  EXPECT_EQ(getExpansionCount(), 1u);
+}
+
+TEST_F(UrdfCacheTest, PersistsExpansionsAcrossInstances)
+{
+  std::string xacro_path = writeFile("robot.xacro", "robot\n");
+  std::string first_description;
+  std::string second_description;
+  ASSERT_TRUE(makeCache(cache_dir_)->getRobotDescription(xacro_path, "", first_description));
+  ASSERT_TRUE(makeCache(cache_dir_)->getRobotDescription(xacro_path, "", second_description));
+  EXPECT_EQ(first_description, second_description);
+  EXPECT_EQ(getExpansionCount(), 1u);
+}
+
+TEST_F(UrdfCacheTest, ExpandsAgainWhenCacheFileIsDamaged)
+{
+  std::string xacro_path = writeFile("robot.xacro", "robot\n");
+  std::string first_description;
+  ASSERT_TRUE(makeCache(cache_dir_)->getRobotDescription(xacro_path, "", first_description));
+
+  // Truncates the URDF of the only cache file
+  fs::directory_iterator cache_file_it(cache_dir_);
+  ASSERT_NE(cache_file_it, fs::directory_iterator());
+  fs::path cache_file_path = cache_file_it->path();
+  EXPECT_EQ(++cache_file_it, fs::directory_iterator());
+  fs::resize_file(cache_file_path, fs::file_size(cache_file_path) - 1);
+
+  std::string second_description;
+  ASSERT_TRUE(makeCache(cache_dir_)->getRobotDescription(xacro_path, "", second_description));
+  EXPECT_EQ(first_description, second_description);
+  EXPECT_EQ(getExpansionCount(), 2u);
+}
+
+TEST_F(UrdfCacheTest, DoesNotPersistWithoutCacheDir)
+{
+  std::string xacro_path = writeFile("robot.xacro", "robot\n");
+  std::string robot_description;
+  ASSERT_TRUE(makeCache("")->getRobotDescription(xacro_path, "", robot_description));
+  ASSERT_TRUE(makeCache("")->getRobotDescription(xacro_path, "", robot_description));
+  EXPECT_EQ(getExpansionCount(), 2u);
+}
+
+TEST_F(UrdfCacheTest, ExpandsAgainWhenDependencyChanges)
+{
+  std::string xacro_path = writeFile("robot.xacro", "robot\n");
+  std::string arm_path = writeFile("arm.xacro", "arm 1\n");
+  writeFile("robot.xacro.deps", arm_path + "\n");
+  auto urdf_cache = makeCache(cache_dir_);
+
+  std::string robot_description;
+  ASSERT_TRUE(urdf_cache->getRobotDescription(xacro_path, "", robot_description));
+  EXPECT_NE(robot_description.find("arm 1"), std::string::npos);
+
+  writeFile(arm_path, "arm 2\n");
+  ASSERT_TRUE(urdf_cache->getRobotDescription(xacro_path, "", robot_description));
+  EXPECT_NE(robot_description.find("arm 2"), std::string::npos);
+  EXPECT_EQ(getExpansionCount(), 2u);
+}
+
+TEST_F(UrdfCacheTest, KeysEntriesByArguments)
+{
+  std::string xacro_path = writeFile("robot.xacro", "robot\n");
+  auto urdf_cache = makeCache(cache_dir_);
+
+  std::string left_description;
+  std::string right_description;
+  ASSERT_TRUE(urdf_cache->getRobotDescription(xacro_path, "side:=left", left_description));
+  ASSERT_TRUE(urdf_cache->getRobotDescription(xacro_path, "side:=right", right_description));
+  EXPECT_NE(left_description.find("args: side:=left"), std::string::npos);
+  EXPECT_NE(right_description.find("args: side:=right"), std::string::npos);
+  EXPECT_EQ(getExpansionCount(), 2u);
+
+  // Both expansions are cached, also when the arguments are spaced differently
+  ASSERT_TRUE(makeCache(cache_dir_)->getRobotDescription(xacro_path, " side:=left ", left_description));
+  EXPECT_NE(left_description.find("args: side:=left"), std::string::npos);
+  EXPECT_EQ(getExpansionCount(), 2u);
+}
+
+TEST_F(UrdfCacheTest, ExpandsAgainWhenReferencedEnvironmentChanges)
+{
+  std::string xacro_path = writeFile("robot.xacro", "<xacro:property name=\"x\" value=\"$(env TEMOTO_URDF_CACHE_TEST)\"/>\n");
+  auto urdf_cache = makeCache(cache_dir_);
+
+  setenv("TEMOTO_URDF_CACHE_TEST", "first", 1);
+  std::string robot_description;
+  ASSERT_TRUE(urdf_cache->getRobotDescription(xacro_path, "", robot_description));
+  EXPECT_NE(robot_description.find("env: first"), std::string::npos);
+
+  setenv("TEMOTO_URDF_CACHE_TEST", "second", 1);
+  ASSERT_TRUE(urdf_cache->getRobotDescription(xacro_path, "", robot_description));
+  EXPECT_NE(robot_description.find("env: second"), std::string::npos);
+  EXPECT_EQ(getExpansionCount(), 2u);
+}
+
+TEST_F(UrdfCacheTest, IgnoresUnreferencedEnvironment)
+{
+  std::string xacro_path = writeFile("robot.xacro", "robot\n");
+  auto urdf_cache = makeCache(cache_dir_);
+
+  std::string robot_description;
+  setenv("TEMOTO_URDF_CACHE_TEST", "first", 1);
+  ASSERT_TRUE(urdf_cache->getRobotDescription(xacro_path, "", robot_description));
+  setenv("TEMOTO_URDF_CACHE_TEST", "second", 1);
+  ASSERT_TRUE(urdf_cache->getRobotDescription(xacro_path, "", robot_description));
+  EXPECT_EQ(getExpansionCount(), 1u);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}